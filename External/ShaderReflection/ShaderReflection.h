@@ -1,5 +1,6 @@
 #pragma once
 #include "BaseTypes.h"
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <string>
@@ -114,6 +115,9 @@ public:
     virtual const std::vector<FInputParameterDesc>& GetInputParameters() const = 0;
     virtual const std::vector<FOutputParameterDesc>& GetOutputParameters() const = 0;
     virtual const FShaderFeatureInfo& GetShaderFeatureInfo() const = 0;
+
+    // flat binary form of everything above, read back with DeserializeShaderReflection
+    std::vector<uint8_t> Serialize() const;
 };
 
 enum class EShaBlobType
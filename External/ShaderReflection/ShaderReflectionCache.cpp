@@ -0,0 +1,102 @@
+#include "ShaderReflectionCache.h"
+#include "ShaderReflectionSerializer.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+uint64_t HashShaderBlob(EShaBlobType type, const void* data, size_t size)
+{
+    // FNV-1a over 32-bit words, spir-v is a word stream so this is a quarter of the byte-wise rounds
+    constexpr uint64_t prime = 0x100000001b3ull;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = (hash ^ (uint64_t)type) * prime;
+    hash = (hash ^ (uint64_t)size) * prime;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t word_count = size / sizeof(uint32_t);
+    for (size_t i = 0; i < word_count; ++i)
+    {
+        uint32_t word;
+        memcpy(&word, bytes + i * sizeof(uint32_t), sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (size_t i = word_count * sizeof(uint32_t); i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * prime;
+    }
+    return hash;
+}
+
+FShaderReflectionCache::FShaderReflectionCache(const std::string& directory)
+    : m_directory(directory)
+{
+    if (!m_directory.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+    }
+}
+
+std::string FShaderReflectionCache::GetEntryPath(uint64_t key) const
+{
+    char name[24];
+    snprintf(name, sizeof(name), "%016llx.refl", (unsigned long long)key);
+    return (std::filesystem::path(m_directory) / name).string();
+}
+
+std::shared_ptr<IShaderReflection> FShaderReflectionCache::GetOrCreate(EShaBlobType type, const void* data, size_t size)
+{
+    uint64_t key = HashShaderBlob(type, data, size);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_reflections.find(key);
+        if (it != m_reflections.end())
+        {
+            m_hits++;
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<IShaderReflection> reflection;
+    if (!m_directory.empty())
+    {
+        std::ifstream file(GetEntryPath(key), std::ios::binary);
+        if (file)
+        {
+            std::vector<uint8_t> serialized((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            reflection = DeserializeShaderReflection(serialized.data(), serialized.size());
+        }
+    }
+
+    bool from_disk = reflection != nullptr;
+    if (!reflection)
+    {
+        reflection = CreateShaderReflection(type, data, size);
+        if (!reflection)
+            return nullptr;
+        if (!m_directory.empty())
+        {
+            // written aside and renamed so a concurrent reader never sees a partial entry
+            auto serialized = reflection->Serialize();
+            auto path = GetEntryPath(key);
+            auto temp_path = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+            {
+                std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+                file.write((const char*)serialized.data(), serialized.size());
+            }
+            std::error_code error;
+            std::filesystem::rename(temp_path, path, error);
+            if (error)
+                std::filesystem::remove(temp_path, error);
+        }
+    }
+
+    if (from_disk)
+        m_hits++;
+    else
+        m_misses++;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_reflections.emplace(key, reflection).first->second;
+}
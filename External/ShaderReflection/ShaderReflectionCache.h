@@ -0,0 +1,33 @@
+#pragma once
+#include "ShaderReflection/ShaderReflection.h"
+#include "MiniCore/Container.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+
+// reflection results keyed by a hash of the blob, held in memory and optionally mirrored to
+// a directory, so a warm run deserializes a few tables instead of parsing the module with spirv-cross
+class FShaderReflectionCache
+{
+public:
+    // an empty directory keeps the cache in memory only
+    explicit FShaderReflectionCache(const std::string& directory = "");
+
+    std::shared_ptr<IShaderReflection> GetOrCreate(EShaBlobType type, const void* data, size_t size);
+
+    uint32_t GetHitCount() const { return m_hits; }
+    uint32_t GetMissCount() const { return m_misses; }
+
+private:
+    std::string GetEntryPath(uint64_t key) const;
+
+    std::string m_directory;
+    std::mutex m_mutex;
+    // looked up once per shader under the lock, the flat table probes one array instead of chasing a node
+    Neko::flat_hash_map<uint64_t, std::shared_ptr<IShaderReflection>> m_reflections;
+    std::atomic<uint32_t> m_hits = 0;
+    std::atomic<uint32_t> m_misses = 0;
+};
+
+// hash of a shader blob as used by FShaderReflectionCache
+uint64_t HashShaderBlob(EShaBlobType type, const void* data, size_t size);
@@ -0,0 +1,282 @@
+#include "ShaderReflectionSerializer.h"
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace
+{
+    constexpr uint32_t kReflectionMagic = 0x4C464552; // "REFL"
+    constexpr uint32_t kReflectionVersion = 1;
+    // deeper struct nesting than any shader has, bounds the recursion on a corrupted file
+    constexpr uint32_t kMaxLayoutDepth = 32;
+
+    class FReflectionWriter
+    {
+    public:
+        template <typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+            m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+        }
+
+        void Write(const std::string& value)
+        {
+            Write<uint32_t>((uint32_t)value.size());
+            m_data.insert(m_data.end(), value.begin(), value.end());
+        }
+
+        void Write(const FVariableLayout& layout)
+        {
+            Write(layout.name);
+            Write(layout.type);
+            Write(layout.offset);
+            Write(layout.size);
+            Write(layout.rows);
+            Write(layout.columns);
+            Write(layout.elements);
+            Write<uint32_t>((uint32_t)layout.members.size());
+            for (const auto& member : layout.members)
+            {
+                Write(member);
+            }
+        }
+
+        std::vector<uint8_t> Release()
+        {
+            return std::move(m_data);
+        }
+
+    private:
+        std::vector<uint8_t> m_data;
+    };
+
+    class FReflectionReader
+    {
+    public:
+        FReflectionReader(const void* data, size_t size)
+            : m_data(static_cast<const uint8_t*>(data))
+            , m_size(size)
+        {
+        }
+
+        template <typename T>
+        bool Read(T& value)
+        {
+            static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>, "bools and enums go through the checked overloads");
+            if (m_size - m_offset < sizeof(T))
+                return false;
+            memcpy(&value, m_data + m_offset, sizeof(T));
+            m_offset += sizeof(T);
+            return true;
+        }
+
+        bool Read(bool& value)
+        {
+            uint8_t byte = 0;
+            if (!Read(byte) || byte > 1)
+                return false;
+            value = byte != 0;
+            return true;
+        }
+
+        // enums are only accepted up to the last enumerator, anything else is a corrupted file
+        template <typename T>
+        bool Read(T& value, T last)
+        {
+            static_assert(std::is_enum_v<T>);
+            std::underlying_type_t<T> raw = 0;
+            if (!Read(raw) || raw < 0 || raw > (std::underlying_type_t<T>)last)
+                return false;
+            value = (T)raw;
+            return true;
+        }
+
+        bool Read(std::string& value)
+        {
+            uint32_t length = 0;
+            if (!Read(length) || m_size - m_offset < length)
+                return false;
+            value.assign(reinterpret_cast<const char*>(m_data + m_offset), length);
+            m_offset += length;
+            return true;
+        }
+
+        bool Read(FVariableLayout& layout, uint32_t depth = 0)
+        {
+            uint32_t member_count = 0;
+            bool ok = Read(layout.name) && Read(layout.type, EVariableType::kBool) && Read(layout.offset) &&
+                      Read(layout.size) && Read(layout.rows) && Read(layout.columns) && Read(layout.elements) &&
+                      Read(member_count);
+            if (!ok || member_count > m_size - m_offset || (member_count > 0 && depth >= kMaxLayoutDepth))
+                return false;
+            layout.members.resize(member_count);
+            for (auto& member : layout.members)
+            {
+                if (!Read(member, depth + 1))
+                    return false;
+            }
+            return true;
+        }
+
+        // guards the resize against counts taken from a corrupted file
+        bool ReadCount(uint32_t& count)
+        {
+            return Read(count) && count <= m_size - m_offset;
+        }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_offset = 0;
+    };
+
+    class FSerializedReflection : public IShaderReflection
+    {
+    public:
+        bool Load(const void* data, size_t size)
+        {
+            FReflectionReader reader(data, size);
+            uint32_t magic = 0;
+            uint32_t version = 0;
+            if (!reader.Read(magic) || !reader.Read(version) || magic != kReflectionMagic || version != kReflectionVersion)
+                return false;
+
+            uint32_t count = 0;
+            if (!reader.ReadCount(count))
+                return false;
+            m_entry_points.resize(count);
+            for (auto& entry_point : m_entry_points)
+            {
+                if (!reader.Read(entry_point.name) || !reader.Read(entry_point.kind, EShaderKind::kAmplification) ||
+                    !reader.Read(entry_point.payload_size) || !reader.Read(entry_point.attribute_size))
+                    return false;
+            }
+
+            if (!reader.ReadCount(count))
+                return false;
+            m_bindings.resize(count);
+            for (auto& binding : m_bindings)
+            {
+                if (!reader.Read(binding.name) || !reader.Read(binding.type, EViewType::kDepthStencil) ||
+                    !reader.Read(binding.slot) || !reader.Read(binding.space) || !reader.Read(binding.count) ||
+                    !reader.Read(binding.dimension, EViewDimension::kTextureCubeArray) ||
+                    !reader.Read(binding.return_type, EReturnType::kDouble) || !reader.Read(binding.structure_stride))
+                    return false;
+            }
+
+            if (!reader.ReadCount(count))
+                return false;
+            m_layouts.resize(count);
+            for (auto& layout : m_layouts)
+            {
+                if (!reader.Read(layout))
+                    return false;
+            }
+
+            if (!reader.ReadCount(count))
+                return false;
+            m_input_parameters.resize(count);
+            for (auto& input : m_input_parameters)
+            {
+                if (!reader.Read(input.location) || !reader.Read(input.semantic_name) ||
+                    !reader.Read(input.format, EFormat::FORMAT_LAST))
+                    return false;
+            }
+
+            if (!reader.ReadCount(count))
+                return false;
+            m_output_parameters.resize(count);
+            for (auto& output : m_output_parameters)
+            {
+                if (!reader.Read(output.slot))
+                    return false;
+            }
+
+            return reader.Read(m_shader_feature_info.resource_descriptor_heap_indexing) &&
+                   reader.Read(m_shader_feature_info.sampler_descriptor_heap_indexing);
+        }
+
+        const std::vector<FEntryPoint>& GetEntryPoints() const override { return m_entry_points; }
+        const std::vector<FResourceBindingDesc>& GetBindings() const override { return m_bindings; }
+        const std::vector<FVariableLayout>& GetVariableLayouts() const override { return m_layouts; }
+        const std::vector<FInputParameterDesc>& GetInputParameters() const override { return m_input_parameters; }
+        const std::vector<FOutputParameterDesc>& GetOutputParameters() const override { return m_output_parameters; }
+        const FShaderFeatureInfo& GetShaderFeatureInfo() const override { return m_shader_feature_info; }
+
+    private:
+        std::vector<FEntryPoint> m_entry_points;
+        std::vector<FResourceBindingDesc> m_bindings;
+        std::vector<FVariableLayout> m_layouts;
+        std::vector<FInputParameterDesc> m_input_parameters;
+        std::vector<FOutputParameterDesc> m_output_parameters;
+        FShaderFeatureInfo m_shader_feature_info = {};
+    };
+}
+
+std::vector<uint8_t> SerializeShaderReflection(const IShaderReflection& reflection)
+{
+    FReflectionWriter writer;
+    writer.Write(kReflectionMagic);
+    writer.Write(kReflectionVersion);
+
+    writer.Write<uint32_t>((uint32_t)reflection.GetEntryPoints().size());
+    for (const auto& entry_point : reflection.GetEntryPoints())
+    {
+        writer.Write(entry_point.name);
+        writer.Write(entry_point.kind);
+        writer.Write(entry_point.payload_size);
+        writer.Write(entry_point.attribute_size);
+    }
+
+    writer.Write<uint32_t>((uint32_t)reflection.GetBindings().size());
+    for (const auto& binding : reflection.GetBindings())
+    {
+        writer.Write(binding.name);
+        writer.Write(binding.type);
+        writer.Write(binding.slot);
+        writer.Write(binding.space);
+        writer.Write(binding.count);
+        writer.Write(binding.dimension);
+        writer.Write(binding.return_type);
+        writer.Write(binding.structure_stride);
+    }
+
+    writer.Write<uint32_t>((uint32_t)reflection.GetVariableLayouts().size());
+    for (const auto& layout : reflection.GetVariableLayouts())
+    {
+        writer.Write(layout);
+    }
+
+    writer.Write<uint32_t>((uint32_t)reflection.GetInputParameters().size());
+    for (const auto& input : reflection.GetInputParameters())
+    {
+        writer.Write(input.location);
+        writer.Write(input.semantic_name);
+        writer.Write(input.format);
+    }
+
+    writer.Write<uint32_t>((uint32_t)reflection.GetOutputParameters().size());
+    for (const auto& output : reflection.GetOutputParameters())
+    {
+        writer.Write(output.slot);
+    }
+
+    writer.Write(reflection.GetShaderFeatureInfo().resource_descriptor_heap_indexing);
+    writer.Write(reflection.GetShaderFeatureInfo().sampler_descriptor_heap_indexing);
+    return writer.Release();
+}
+
+std::vector<uint8_t> IShaderReflection::Serialize() const
+{
+    return SerializeShaderReflection(*this);
+}
+
+std::shared_ptr<IShaderReflection> DeserializeShaderReflection(const void* data, size_t size)
+{
+    auto reflection = std::make_shared<FSerializedReflection>();
+    if (!reflection->Load(data, size))
+        return nullptr;
+    return reflection;
+}
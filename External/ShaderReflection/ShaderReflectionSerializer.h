@@ -0,0 +1,12 @@
+#pragma once
+#include "ShaderReflection/ShaderReflection.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// flat little-endian encoding of everything IShaderReflection exposes,
+// so reflection can be stored next to the blob it was built from
+std::vector<uint8_t> SerializeShaderReflection(const IShaderReflection& reflection);
+
+// returns nullptr if the data is truncated or was written by another version
+std::shared_ptr<IShaderReflection> DeserializeShaderReflection(const void* data, size_t size);
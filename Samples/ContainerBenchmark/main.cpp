@@ -0,0 +1,221 @@
+#include "RHI/RHI.h"
+#include <array>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace Neko;
+
+// the static_vector the descs used before, every element lives from construction on, kept here as the baseline
+template <typename T, uint32_t N>
+struct legacy_static_vector : private std::array<T, N>
+{
+    legacy_static_vector() : std::array<T, N>() {}
+    void push_back(const T& value) { (*this)[current_size++] = value; }
+    size_t size() const { return current_size; }
+    using std::array<T, N>::operator[];
+    size_t current_size = 0;
+};
+
+struct FLegacyBindingLayoutDesc
+{
+    legacy_static_vector<RHI::FBindingLayoutBinding, RHI::MAX_BINDINGS_PER_LAYOUT> BindingArray;
+    RHI::EShaderStage ShaderStage = RHI::EShaderStage::All;
+};
+
+struct FLegacyPipelineBindings
+{
+    legacy_static_vector<RHI::IBindingLayoutRef, RHI::MAX_BINDING_LAYOUT_COUNT> BindingLayoutArray;
+    legacy_static_vector<RHI::IShaderRef, RHI::MAX_SHADER_STAGE_COUNT> ShaderArray;
+};
+
+struct FPipelineBindings
+{
+    static_vector<RHI::IBindingLayoutRef, RHI::MAX_BINDING_LAYOUT_COUNT> BindingLayoutArray;
+    static_vector<RHI::IShaderRef, RHI::MAX_SHADER_STAGE_COUNT> ShaderArray;
+};
+
+// stands in for a device call taking the desc, kept out of line so the desc is really built
+template <typename TDesc>
+[[gnu::noinline]] uint64_t Consume(const TDesc& Desc)
+{
+    return Desc.BindingArray.size();
+}
+
+template <typename TBindings>
+[[gnu::noinline]] uint64_t ConsumeBindings(const TBindings& Bindings)
+{
+    return Bindings.BindingLayoutArray.size() + Bindings.ShaderArray.size();
+}
+
+template <typename TList>
+[[gnu::noinline]] uint64_t ConsumeList(const TList& List)
+{
+    return List.back() + List.size();
+}
+
+template <typename TFunction>
+static double Measure(const char* Name, uint64_t Iterations, TFunction&& Function)
+{
+    auto Begin = std::chrono::steady_clock::now();
+    uint64_t Sink = Function(Iterations);
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Begin).count();
+    double NsPerOp = Seconds * 1e9 / (double)Iterations;
+    printf("    %-40s %8.2f ns  (%llu)\n", Name, NsPerOp, (unsigned long long)(Sink & 0xff));
+    return NsPerOp;
+}
+
+static void RunDescs(uint64_t Iterations)
+{
+    printf("desc with 4 of %u bindings, built and passed on :\n", RHI::MAX_BINDINGS_PER_LAYOUT);
+    auto Build = [](auto& Desc)
+    {
+        for (uint8_t i = 0; i < 4; ++i)
+        {
+            RHI::FBindingLayoutBinding Binding;
+            Binding.SetBinding(i);
+            Desc.BindingArray.push_back(Binding);
+        }
+    };
+    double LegacyNs = Measure("array backed static_vector", Iterations, [&](uint64_t Num)
+    {
+        uint64_t Sum = 0;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            FLegacyBindingLayoutDesc Desc;
+            Build(Desc);
+            Sum += Consume(Desc);
+        }
+        return Sum;
+    });
+    double NewNs = Measure("uninitialized static_vector", Iterations, [&](uint64_t Num)
+    {
+        uint64_t Sum = 0;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            RHI::FBindingLayoutDesc Desc;
+            Build(Desc);
+            Sum += Consume(Desc);
+        }
+        return Sum;
+    });
+    printf("    speedup %.2fx\n", LegacyNs / NewNs);
+
+    printf("pipeline desc arrays of RefCountPtr, one shader set :\n");
+    LegacyNs = Measure("array backed static_vector", Iterations, [&](uint64_t Num)
+    {
+        uint64_t Sum = 0;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            FLegacyPipelineBindings Bindings;
+            Bindings.ShaderArray.push_back(nullptr);
+            Sum += ConsumeBindings(Bindings);
+        }
+        return Sum;
+    });
+    NewNs = Measure("uninitialized static_vector", Iterations, [&](uint64_t Num)
+    {
+        uint64_t Sum = 0;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            FPipelineBindings Bindings;
+            Bindings.ShaderArray.push_back(nullptr);
+            Sum += ConsumeBindings(Bindings);
+        }
+        return Sum;
+    });
+    printf("    speedup %.2fx\n\n", LegacyNs / NewNs);
+}
+
+static void RunSmallVector(uint64_t Iterations)
+{
+    printf("short lists, 3 elements pushed into a fresh container :\n");
+    double VectorNs = Measure("std::vector", Iterations, [](uint64_t Num)
+    {
+        uint64_t Sum = 0;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            std::vector<uint64_t> List;
+            List.push_back(i);
+            List.push_back(i + 1);
+            List.push_back(i + 2);
+            Sum += ConsumeList(List);
+        }
+        return Sum;
+    });
+    double SmallNs = Measure("small_vector<4>", Iterations, [](uint64_t Num)
+    {
+        uint64_t Sum = 0;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            small_vector<uint64_t, 4> List;
+            List.push_back(i);
+            List.push_back(i + 1);
+            List.push_back(i + 2);
+            Sum += ConsumeList(List);
+        }
+        return Sum;
+    });
+    printf("    speedup %.2fx\n\n", VectorNs / SmallNs);
+}
+
+template <typename TMap>
+static void RunMap(const char* Name, const std::vector<uint64_t>& Keys, const std::vector<uint64_t>& Lookups, double* InsertNs, double* FindNs)
+{
+    TMap Map;
+    char Label[64];
+    snprintf(Label, sizeof(Label), "%s insert", Name);
+    *InsertNs = Measure(Label, Keys.size(), [&](uint64_t)
+    {
+        for (size_t i = 0; i < Keys.size(); ++i)
+        {
+            Map[Keys[i]] = i;
+        }
+        return (uint64_t)Map.size();
+    });
+    snprintf(Label, sizeof(Label), "%s find, half missing", Name);
+    *FindNs = Measure(Label, Lookups.size(), [&](uint64_t)
+    {
+        uint64_t Sum = 0;
+        for (auto Key : Lookups)
+        {
+            auto Iter = Map.find(Key);
+            Sum += Iter != Map.end() ? Iter->second : 1;
+        }
+        return Sum;
+    });
+}
+
+static void RunHashMap(uint64_t KeyNum)
+{
+    printf("%llu random 64 bit keys, like hashed desc keys of a cache :\n", (unsigned long long)KeyNum);
+    std::mt19937_64 Random(42);
+    std::vector<uint64_t> Keys(KeyNum);
+    for (auto& Key : Keys)
+    {
+        Key = Random();
+    }
+    std::vector<uint64_t> Lookups(KeyNum * 4);
+    for (auto& Key : Lookups)
+    {
+        Key = Random() & 1 ? Keys[Random() % KeyNum] : Random();
+    }
+
+    double StdInsertNs, StdFindNs, FlatInsertNs, FlatFindNs;
+    RunMap<std::unordered_map<uint64_t, uint64_t>>("std::unordered_map", Keys, Lookups, &StdInsertNs, &StdFindNs);
+    RunMap<flat_hash_map<uint64_t, uint64_t>>("flat_hash_map", Keys, Lookups, &FlatInsertNs, &FlatFindNs);
+    printf("    insert speedup %.2fx, find speedup %.2fx\n\n", StdInsertNs / FlatInsertNs, StdFindNs / FlatFindNs);
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t Iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 5000000;
+    RunDescs(Iterations);
+    RunSmallVector(Iterations);
+    RunHashMap(1000);
+    RunHashMap(1000000);
+    return 0;
+}
@@ -0,0 +1,42 @@
+// draws the meshlets FClusterCuller lets through, vertices are the quantized position and normal NekoMeshCook writes
+#include "../../../Source/Mesh/Shaders/MeshQuantization.hlsli"
+
+// mirrors FDrawConstants in main.cpp
+struct FDrawConstants
+{
+    row_major float4x4 ViewProjection;
+    float3 PositionOffset;
+    float Pad0;
+    float3 PositionScale;
+    float Pad1;
+};
+
+[[vk::push_constant]] FDrawConstants Constants;
+
+struct FVertexInput
+{
+    float3 Position : POSITION;
+    float2 Normal : NORMAL;
+};
+
+struct FVertexOutput
+{
+    float4 Position : SV_Position;
+    float3 Normal : NORMAL;
+};
+
+FVertexOutput mainVS(FVertexInput Input)
+{
+    float3 Position = DequantizePosition(Input.Position, Constants.PositionOffset, Constants.PositionScale);
+
+    FVertexOutput Output;
+    Output.Position = mul(Constants.ViewProjection, float4(Position, 1.0));
+    Output.Normal = DecodeOctahedral(Input.Normal);
+    return Output;
+}
+
+float4 mainPS(FVertexOutput Input) : SV_Target
+{
+    float Light = saturate(dot(normalize(Input.Normal), normalize(float3(0.4, 0.8, 0.5))));
+    return float4((0.15 + 0.85 * Light) * float3(0.9, 0.75, 0.6), 1.0);
+}
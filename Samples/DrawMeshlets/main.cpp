@@ -0,0 +1,534 @@
+#include "RHI/RHI.h"
+#include "RHI/GeometryBuffer.h"
+#include "OS/Window.h"
+#include "Mesh/ClusterCulling.h"
+#include "Mesh/MeshPackage.h"
+#include "MeshCook.h"
+#include "ShaderCompiler/ShaderArchive.h"
+#include "ShaderCompiler/VertexLayoutBuilder.h"
+#include "HLSLCompiler/SystemUtils.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace Neko;
+
+// mirrors FDrawConstants in Shaders/DrawMeshlets.hlsl
+struct FDrawConstants
+{
+    float ViewProjection[16];
+    float PositionOffset[3];
+    float Pad0;
+    float PositionScale[3];
+    float Pad1;
+};
+
+// which mesh and level of detail a meshlet of the culler belongs to, in the order they were added
+struct FMeshletSource
+{
+    const Mesh::FMeshEntry* Entry;
+    uint32_t Lod;
+};
+
+// the draws of one frame copied back for the lod check, per frame slot
+struct FDrawReadback
+{
+    RHI::IBufferRef Buffer;
+    float CameraPosition[3];
+    float LodErrorScale;
+    bool bPending = false;
+};
+
+static constexpr float PI = 3.14159265f;
+static constexpr float FOV_Y = 0.8f;
+
+// a sphere with ripples, dense enough that culling and simplification have something to work with
+static MeshCook::FCookedMesh BuildRippleSphere(uint32_t RingNum, uint32_t SegmentNum)
+{
+    MeshCook::FCookedMesh Mesh;
+    Mesh.Name = "RippleSphere";
+    Mesh.Attributes.push_back({ Mesh::EMeshAttribute::Position, Mesh::EMeshVertexFormat::Float3, 0 });
+    Mesh.Attributes.push_back({ Mesh::EMeshAttribute::Normal, Mesh::EMeshVertexFormat::Float3, 12 });
+    Mesh.VertexStride = 24;
+    Mesh.VertexNum = (RingNum + 1) * (SegmentNum + 1);
+
+    std::vector<float> Positions(Mesh.VertexNum * 3);
+    for (uint32_t Ring = 0; Ring <= RingNum; ++Ring)
+    {
+        for (uint32_t Segment = 0; Segment <= SegmentNum; ++Segment)
+        {
+            float Theta = PI * Ring / RingNum;
+            float Phi = 2.0f * PI * Segment / SegmentNum;
+            float Radius = 1.0f + 0.04f * std::sin(16.0f * Theta) * std::sin(16.0f * Phi);
+            float* Position = &Positions[(Ring * (SegmentNum + 1) + Segment) * 3];
+            Position[0] = Radius * std::sin(Theta) * std::cos(Phi);
+            Position[1] = Radius * std::cos(Theta);
+            Position[2] = Radius * std::sin(Theta) * std::sin(Phi);
+        }
+    }
+
+    for (uint32_t Ring = 0; Ring < RingNum; ++Ring)
+    {
+        for (uint32_t Segment = 0; Segment < SegmentNum; ++Segment)
+        {
+            uint32_t A = Ring * (SegmentNum + 1) + Segment;
+            uint32_t B = A + SegmentNum + 1;
+            Mesh.Indices.insert(Mesh.Indices.end(), { A, A + 1, B, A + 1, B + 1, B });
+        }
+    }
+
+    // area weighted face normals summed per vertex
+    std::vector<float> Normals(Mesh.VertexNum * 3, 0.0f);
+    for (size_t i = 0; i < Mesh.Indices.size(); i += 3)
+    {
+        const float* P0 = &Positions[Mesh.Indices[i] * 3];
+        const float* P1 = &Positions[Mesh.Indices[i + 1] * 3];
+        const float* P2 = &Positions[Mesh.Indices[i + 2] * 3];
+        float E1[3] = { P1[0] - P0[0], P1[1] - P0[1], P1[2] - P0[2] };
+        float E2[3] = { P2[0] - P0[0], P2[1] - P0[1], P2[2] - P0[2] };
+        float Normal[3] = { E1[1] * E2[2] - E1[2] * E2[1], E1[2] * E2[0] - E1[0] * E2[2], E1[0] * E2[1] - E1[1] * E2[0] };
+        for (size_t Corner = 0; Corner < 3; ++Corner)
+        {
+            for (size_t j = 0; j < 3; ++j)
+            {
+                Normals[Mesh.Indices[i + Corner] * 3 + j] += Normal[j];
+            }
+        }
+    }
+
+    Mesh.Vertices.resize((size_t)Mesh.VertexNum * Mesh.VertexStride);
+    for (uint32_t i = 0; i < Mesh.VertexNum; ++i)
+    {
+        float* Normal = &Normals[i * 3];
+        float Length = std::sqrt(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+        for (size_t j = 0; j < 3; ++j)
+        {
+            // the poles only touch degenerate triangles
+            Normal[j] = Length > 0.0f ? Normal[j] / Length : (j == 1 ? 1.0f : 0.0f);
+        }
+        std::memcpy(&Mesh.Vertices[(size_t)i * Mesh.VertexStride], &Positions[i * 3], 12);
+        std::memcpy(&Mesh.Vertices[(size_t)i * Mesh.VertexStride + 12], Normal, 12);
+    }
+    return Mesh;
+}
+
+// the meshlets of all meshes go out in one indirect draw, which sees one set of dequantization constants,
+// so the meshes of a model are merged before they are quantized against their common bounds.
+// meshes whose attributes differ from the first one are dropped
+static void MergeMeshes(std::vector<MeshCook::FCookedMesh>& Meshes)
+{
+    auto& Merged = Meshes.front();
+    for (size_t i = 1; i < Meshes.size(); ++i)
+    {
+        auto& Mesh = Meshes[i];
+        bool bSameLayout = Mesh.VertexStride == Merged.VertexStride && Mesh.Attributes.size() == Merged.Attributes.size() &&
+            std::equal(Mesh.Attributes.begin(), Mesh.Attributes.end(), Merged.Attributes.begin(), [](const Mesh::FMeshAttributeDesc& A, const Mesh::FMeshAttributeDesc& B)
+            {
+                return A.Attribute == B.Attribute && A.Format == B.Format && A.Offset == B.Offset;
+            });
+        if (!bSameLayout)
+        {
+            printf("Skipped mesh %s, its attributes differ from %s\n", Mesh.Name.c_str(), Merged.Name.c_str());
+            continue;
+        }
+        for (uint32_t Index : Mesh.Indices)
+        {
+            Merged.Indices.push_back(Merged.VertexNum + Index);
+        }
+        Merged.Vertices.insert(Merged.Vertices.end(), Mesh.Vertices.begin(), Mesh.Vertices.end());
+        Merged.VertexNum += Mesh.VertexNum;
+    }
+    Meshes.resize(1);
+}
+
+// every draw the culling pass emitted has to come from the level SelectMeshLod picks for its mesh,
+// returns how many don't
+static uint32_t CheckLodSelection(const uint8_t* Readback, const std::vector<FMeshletSource>& Meshlets, const float CameraPosition[3], float LodErrorScale, uint32_t& DrawNum)
+{
+    std::memcpy(&DrawNum, Readback, sizeof(uint32_t));
+    DrawNum = std::min(DrawNum, (uint32_t)Meshlets.size());
+    uint32_t MismatchNum = 0;
+    for (uint32_t i = 0; i < DrawNum; ++i)
+    {
+        RHI::FDrawIndexedIndirectArgs Draw;
+        std::memcpy(&Draw, Readback + sizeof(uint32_t) + (size_t)i * sizeof(Draw), sizeof(Draw));
+        if (Draw.FirstInstance >= Meshlets.size())
+        {
+            ++MismatchNum;
+            continue;
+        }
+        auto& Source = Meshlets[Draw.FirstInstance];
+        if (Mesh::SelectMeshLod(*Source.Entry, CameraPosition, LodErrorScale) != Source.Lod)
+        {
+            ++MismatchNum;
+        }
+    }
+    return MismatchNum;
+}
+
+// row major, maps column vectors to vulkan clip space with y down and depth 0..1, as FClusterCuller expects
+static void BuildViewProjection(const float Eye[3], const float Target[3], float FovY, float Aspect, float Near, float Far, float M[16])
+{
+    auto Normalize = [](float V[3])
+    {
+        float Length = std::sqrt(V[0] * V[0] + V[1] * V[1] + V[2] * V[2]);
+        V[0] /= Length;
+        V[1] /= Length;
+        V[2] /= Length;
+    };
+    float Forward[3] = { Target[0] - Eye[0], Target[1] - Eye[1], Target[2] - Eye[2] };
+    Normalize(Forward);
+    float Right[3] = { -Forward[2], 0.0f, Forward[0] }; // Forward x (0, 1, 0)
+    Normalize(Right);
+    float Up[3] = { Right[1] * Forward[2] - Right[2] * Forward[1], Right[2] * Forward[0] - Right[0] * Forward[2], Right[0] * Forward[1] - Right[1] * Forward[0] };
+
+    auto Dot = [](const float A[3], const float B[3]) { return A[0] * B[0] + A[1] * B[1] + A[2] * B[2]; };
+    float View[3][4] = {
+        { Right[0], Right[1], Right[2], -Dot(Right, Eye) },
+        { Up[0], Up[1], Up[2], -Dot(Up, Eye) },
+        { -Forward[0], -Forward[1], -Forward[2], Dot(Forward, Eye) } };
+
+    float ScaleY = 1.0f / std::tan(FovY * 0.5f);
+    float ScaleX = ScaleY / Aspect;
+    float DepthScale = Far / (Near - Far);
+    float DepthOffset = Near * Far / (Near - Far);
+    for (int j = 0; j < 4; ++j)
+    {
+        M[0 * 4 + j] = ScaleX * View[0][j];
+        M[1 * 4 + j] = -ScaleY * View[1][j];
+        M[2 * 4 + j] = DepthScale * View[2][j] + (j == 3 ? DepthOffset : 0.0f);
+        M[3 * 4 + j] = -View[2][j];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // a model given on the command line is cooked instead of the procedural sphere
+    MeshCook::FMeshCookOptions CookOptions;
+    CookOptions.bTexCoords = false;
+    std::vector<MeshCook::FCookedMesh> CookedMeshes;
+    if (argc > 1)
+    {
+        std::string Error;
+        if (!MeshCook::ImportMeshes(argv[1], CookOptions, CookedMeshes, Error))
+        {
+            printf("Failed to import %s : %s\n", argv[1], Error.c_str());
+            return 1;
+        }
+    }
+    else
+    {
+        CookedMeshes.push_back(BuildRippleSphere(128, 256));
+    }
+    MergeMeshes(CookedMeshes);
+    MeshCook::OptimizeMesh(CookedMeshes[0], CookOptions);
+    MeshCook::QuantizeMesh(CookedMeshes[0]);
+
+    std::string PackagePath = GetExecutableDir() + "/DrawMeshlets.nmesh";
+    Mesh::FMeshPackage Package;
+    if (!MeshCook::WriteMeshPackage(PackagePath, CookedMeshes) || !Package.Open(PackagePath) || Package.GetMeshNum() == 0)
+    {
+        printf("Failed to cook %s\n", PackagePath.c_str());
+        return 1;
+    }
+
+    // the package is compressed, the meshes decode while the device and pipelines are created
+    Mesh::FMeshDecoder Decoder;
+    for (uint32_t i = 0; i < Package.GetMeshNum(); ++i)
+    {
+        Decoder.Enqueue(Package.GetMesh(i));
+    }
+
+    RHI::RHIInit();
+
+    uint32_t SurfaceExtensionCount;
+    const char** SurfaceExtensionNames = OS::FWindow::GetRequiredVulkanInstanceExtensions(&SurfaceExtensionCount);
+
+    auto VkDesc = RHI::FDeviceDesc::FVulkanDesc()
+        .SetInstanceExtensions(SurfaceExtensionNames, SurfaceExtensionCount);
+
+    // the culling pass is a compute shader whose surviving meshlets are drawn with DrawIndexedIndirectCount
+    auto Features = RHI::FFeatures()
+        .SetSwapchain(true)
+        .SetCompute(true)
+        .SetDrawIndirectCount(true);
+
+    RHI::FDeviceDesc DevDesc;
+    DevDesc.SetVulkanDesc(VkDesc)
+        .SetValidation(true)
+        .SetFeatures(Features);
+
+    auto Device = CreateDevice(DevDesc);
+    printf("GPU : %s is used\n", Device->GetGPUInfo().Name);
+
+    uint32_t WindowsWidth = 1024, WindowsHeight = 768;
+    auto Window = OS::FWindowBuilder()
+        .SetSize(WindowsWidth, WindowsHeight)
+        .SetTitle("neko_drawmeshlets")
+        .CreateWindow();
+    auto SwapchainDesc = RHI::FSwapChainDesc()
+        .SetFormat(RHI::EFormat::B8G8R8A8_SNORM)
+        .SetPresentLatency(RHI::EPresentLatency::LowLatency).SetWindow(&Window);
+    auto Swapchain = Device->CreateSwapChain(SwapchainDesc);
+
+    Window.Attach([&](const OS::FWindowResizeEvent& Event)
+    {
+        Swapchain->Resize(Event.Width, Event.Height);
+    });
+
+#if NEKO_SHADER_DEV
+    std::string AssetPath = std::filesystem::exists(ASSETS_PATH) ? ASSETS_PATH : GetExecutableDir();
+
+    // same paths as Shaders.manifest
+    ShaderCompiler::FShaderCompiler ShaderCompiler(GetExecutableDir() + "/ShaderCache");
+    auto ShaderCodes = ShaderCompiler.Compile(std::vector<ShaderCompiler::FShaderCompileDesc>{
+        { AssetPath + "/Shaders/DrawMeshlets.hlsl", "mainVS", EShaderType::kVertex, EShaderFeatureLevel::k6_5 },
+        { AssetPath + "/Shaders/DrawMeshlets.hlsl", "mainPS", EShaderType::kPixel, EShaderFeatureLevel::k6_5 },
+        { AssetPath + "/../../Source/Mesh/Shaders/ClusterCulling.hlsl", "mainCS", EShaderType::kCompute, EShaderFeatureLevel::k6_5 } });
+    printf("Shader cache : %u hits, %u misses\n", ShaderCompiler.GetStats().Hits, ShaderCompiler.GetStats().Misses);
+
+    ShaderCompiler::FShaderArchiveView ShaderViews[3];
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        ShaderViews[i] = { ShaderCodes[i].Blob.data(), (uint32_t)ShaderCodes[i].Blob.size(),
+            ShaderCodes[i].Reflection.data(), (uint32_t)ShaderCodes[i].Reflection.size() };
+    }
+    auto VertexShaderCode = ShaderViews[0];
+    auto PixelShaderCode = ShaderViews[1];
+    auto CullingShaderCode = ShaderViews[2];
+#else
+    // built by NekoShaderArchiver from Shaders.manifest
+    ShaderCompiler::FShaderArchive ShaderArchive;
+    if (!ShaderArchive.Open(GetExecutableDir() + "/DrawMeshlets.nsa"))
+    {
+        printf("Failed to open the shader archive\n");
+        return 1;
+    }
+    auto VertexShaderCode = ShaderArchive.Find(ShaderCompiler::GetShaderKey("Shaders/DrawMeshlets.hlsl", "mainVS"));
+    auto PixelShaderCode = ShaderArchive.Find(ShaderCompiler::GetShaderKey("Shaders/DrawMeshlets.hlsl", "mainPS"));
+    auto CullingShaderCode = ShaderArchive.Find(ShaderCompiler::GetShaderKey("../../Source/Mesh/Shaders/ClusterCulling.hlsl", "mainCS"));
+#endif
+    if (!VertexShaderCode.IsValid() || !PixelShaderCode.IsValid() || !CullingShaderCode.IsValid())
+    {
+        printf("Failed to load the shaders\n");
+        return 1;
+    }
+
+    auto VS = Device->CreateShader(RHI::FShaderDesc()
+        .SetBlob((const char*)VertexShaderCode.Blob)
+        .SetSize(VertexShaderCode.BlobSize)
+        .SetEntryPoint("mainVS")
+        .SetStage(RHI::EShaderStage::Vertex));
+    auto PS = Device->CreateShader(RHI::FShaderDesc()
+        .SetBlob((const char*)PixelShaderCode.Blob)
+        .SetSize(PixelShaderCode.BlobSize)
+        .SetEntryPoint("mainPS")
+        .SetStage(RHI::EShaderStage::Pixel));
+    auto CS = Device->CreateShader(RHI::FShaderDesc()
+        .SetBlob((const char*)CullingShaderCode.Blob)
+        .SetSize(CullingShaderCode.BlobSize)
+        .SetEntryPoint("mainCS")
+        .SetStage(RHI::EShaderStage::Compute));
+
+    // the package holds the merged mesh, the shader has to read all of its attributes
+    auto& FirstEntry = *Package.GetMesh(0).Entry;
+    ShaderCompiler::FVertexLayoutBuilder VertexLayoutBuilder;
+    for (uint32_t i = 0; i < FirstEntry.AttributeNum; ++i)
+    {
+        auto& Attribute = FirstEntry.Attributes[i];
+        VertexLayoutBuilder.AddElement(Mesh::GetMeshAttributeSemantic(Attribute.Attribute), Mesh::GetMeshVertexRHIFormat(Attribute.Format));
+    }
+    ShaderCompiler::FVertexLayout VertexLayout;
+    if (!VertexLayoutBuilder.Build(*VertexShaderCode.GetReflection(), VertexLayout))
+    {
+        printf("Vertex layout : %s\n", VertexLayoutBuilder.GetError().c_str());
+        return 1;
+    }
+    if (VertexLayout.Streams[0].Stride != FirstEntry.VertexStride)
+    {
+        printf("Vertex layout : mainVS doesn't read every attribute of the cooked vertices\n");
+        return 1;
+    }
+
+    auto GraphicPipeline = Device->CreateGraphicPipeline(RHI::FGraphicPipelineDesc()
+        .SetVertexShader(VS)
+        .SetPixelShader(PS)
+        .SetRasterState(RHI::FRasterSate().SetCullMode(RHI::ECullMode::None))
+        .AddColorAttachmentDesc(RHI::FColorAttachmentDesc().SetFormat(SwapchainDesc.Format))
+        .SetDepthStencilFormat(RHI::EFormat::D32_SFLOAT)
+        .SetVertexInputLayout(VertexLayout.InputLayout)
+        .SetPushConstantSize(sizeof(FDrawConstants)));
+
+    auto GraphicQueue = Device->CreateQueue();
+    auto FrameScheduler = Device->CreateFrameScheduler(RHI::FFrameSchedulerDesc()
+        .SetFramesInFlight(2)
+        .SetQueue(GraphicQueue)
+        .SetSwapchain(Swapchain)
+        .SetUploadRingSize(32 << 20));
+
+    RHI::FGeometryBuffer GeometryBuffer(Device, RHI::FGeometryBufferDesc().SetVertexStride(FirstEntry.VertexStride));
+    Mesh::FClusterCuller Culler(Device, CS);
+    std::vector<FMeshletSource> MeshletSources;
+    bool bUploaded = false;
+
+    std::vector<FDrawReadback> Readbacks(FrameScheduler->GetFramesInFlight());
+    uint64_t CheckedFrameNum = 0, MismatchFrameNum = 0;
+    uint32_t LastLod = UINT32_MAX;
+
+    RHI::ITextureRef DepthTexture;
+    RHI::IDepthStencilAttachmentRef DepthAttachment;
+
+    auto StartTime = std::chrono::steady_clock::now();
+    while (!Window.ShouldClose())
+    {
+        OS::FWindow::DoEvents();
+        if (Window.GetInput().IsKeyDown(OS::EKeyCode::Escape))
+        {
+            Window.SetCloseFlag(true);
+        }
+
+        if (!FrameScheduler->BeginFrame())
+        {
+            continue;
+        }
+
+        // the gpu is done with the frame that last used this slot, check the levels its culling pass picked
+        auto& Readback = Readbacks[FrameScheduler->GetFrameIndex()];
+        if (Readback.bPending)
+        {
+            uint32_t DrawNum = 0;
+            auto Data = Device->MapBuffer(Readback.Buffer, 0, Culler.GetDrawReadbackSize());
+            uint32_t MismatchNum = CheckLodSelection(Data, MeshletSources, Readback.CameraPosition, Readback.LodErrorScale, DrawNum);
+            Device->UnmapBuffer(Readback.Buffer);
+            ++CheckedFrameNum;
+            if (MismatchNum > 0)
+            {
+                ++MismatchFrameNum;
+                printf("Lod check : %u of %u draws come from a level SelectMeshLod doesn't pick\n", MismatchNum, DrawNum);
+            }
+            Readback.bPending = false;
+        }
+
+        auto SwapchainTexture = FrameScheduler->GetSwapchainTexture();
+        WindowsWidth = SwapchainTexture->GetDesc().Width;
+        WindowsHeight = SwapchainTexture->GetDesc().Height;
+        if (!DepthTexture || DepthTexture->GetDesc().Width != WindowsWidth || DepthTexture->GetDesc().Height != WindowsHeight)
+        {
+            DepthTexture = Device->CreateTexture(RHI::FTextureDesc()
+                .SetTextureUsage(RHI::ETextureUsage::DepthStencilAttachment)
+                .SetFormat(RHI::EFormat::D32_SFLOAT)
+                .SetWidth((uint16_t)WindowsWidth)
+                .SetHeight((uint16_t)WindowsHeight)
+                .SetCategory(RHI::EResourceCategory::RenderTarget));
+            DepthAttachment = Device->CreateDepthStencilAttachment(RHI::FDepthStencilAttachmentDesc().SetTexture(DepthTexture));
+        }
+
+        auto SwapchainColorAttachment = Device->CreateColorAttachment(RHI::FColorAttachmentDesc()
+            .SetTexture(SwapchainTexture)
+            .SetFormat(SwapchainTexture->GetDesc().Format));
+
+        auto CmdList = FrameScheduler->CreateCmdList();
+        CmdList->BeginCmd();
+
+        if (!bUploaded)
+        {
+            Decoder.Flush();
+            Mesh::FDecodedMesh Decoded;
+            while (Decoder.Poll(Decoded))
+            {
+                auto Mesh = Decoded.GetView();
+                if (!Decoded.bValid)
+                {
+                    printf("Failed to decode mesh %.*s\n", (int)Mesh.Name.size(), Mesh.Name.data());
+                    continue;
+                }
+                auto Allocation = Mesh::UploadMesh(Mesh, FrameScheduler, CmdList, GeometryBuffer);
+                if (!Allocation.IsValid() || !Culler.AddMesh(Mesh, Allocation, FrameScheduler, CmdList))
+                {
+                    printf("Skipped mesh %.*s, it doesn't fit the layout or the upload ring\n", (int)Mesh.Name.size(), Mesh.Name.data());
+                    continue;
+                }
+                for (uint32_t Lod = 0; Lod < Mesh.Entry->LodNum; ++Lod)
+                {
+                    MeshletSources.insert(MeshletSources.end(), Mesh.Entry->Lods[Lod].MeshletNum, { Mesh.Entry, Lod });
+                }
+            }
+            for (auto& Readback : Readbacks)
+            {
+                Readback.Buffer = Device->CreateBuffer(RHI::FBufferDesc()
+                    .SetSize(Culler.GetDrawReadbackSize())
+                    .SetBufferUsage(RHI::EBufferUsage::HostAccess | RHI::EBufferUsage::TransferDest));
+            }
+            CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+                .SetBuffer(GeometryBuffer.GetVertexBuffer())
+                .SetSrcState(RHI::EResourceState::TransferDest)
+                .SetDestState(RHI::EResourceState::VertexBuffer));
+            CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+                .SetBuffer(GeometryBuffer.GetIndexBuffer())
+                .SetSrcState(RHI::EResourceState::TransferDest)
+                .SetDestState(RHI::EResourceState::IndexBuffer));
+            printf("%u meshlets in %u meshes\n", Culler.GetMeshletNum(), Package.GetMeshNum());
+            bUploaded = true;
+        }
+
+        // orbits the mesh so the frustum and backface cone tests keep changing what is drawn,
+        // and moves in and out so the level of detail changes
+        float Time = std::chrono::duration<float>(std::chrono::steady_clock::now() - StartTime).count();
+        float Distance = FirstEntry.Bounds.Radius * (2.5f + 4.0f * (1.0f - std::cos(0.2f * Time)));
+        float Eye[3] = {
+            FirstEntry.Bounds.Center[0] + Distance * std::sin(0.3f * Time),
+            FirstEntry.Bounds.Center[1] + 0.4f * Distance,
+            FirstEntry.Bounds.Center[2] + Distance * std::cos(0.3f * Time) };
+        FDrawConstants Constants = {};
+        std::copy(FirstEntry.PositionOffset, FirstEntry.PositionOffset + 3, Constants.PositionOffset);
+        std::copy(FirstEntry.PositionScale, FirstEntry.PositionScale + 3, Constants.PositionScale);
+        BuildViewProjection(Eye, FirstEntry.Bounds.Center, FOV_Y, (float)WindowsWidth / WindowsHeight, 0.01f * Distance, 10.0f * Distance, Constants.ViewProjection);
+
+        float LodErrorScale = Mesh::GetLodErrorScale((float)WindowsHeight, FOV_Y);
+        uint32_t Lod = Mesh::SelectMeshLod(FirstEntry, Eye, LodErrorScale);
+        if (Lod != LastLod)
+        {
+            printf("Lod %u of %u\n", Lod, FirstEntry.LodNum);
+            LastLod = Lod;
+        }
+
+        Culler.Cull(CmdList, Constants.ViewProjection, Eye, LodErrorScale);
+
+        CmdList->ResourceBarrier(SwapchainColorAttachment, RHI::EResourceState::Undefined, RHI::EResourceState::ColorAttachment);
+        CmdList->ResourceBarrier(DepthAttachment, RHI::EResourceState::Undefined, RHI::EResourceState::DepthStencilAttachment);
+
+        auto RenderPassDesc = RHI::FRenderPassDesc()
+            .AddColorAttachment(RHI::FRenderPassColorAttachment(SwapchainColorAttachment)
+                .SetLoadAction(RHI::ELoadOp::Clear)
+                .SetClearColor(RHI::FClearColor().SetR(0.1f).SetG(0.1f).SetB(0.1f)))
+            .SetDepthStencilAttachment(RHI::FRenderPassDepthStencilAttachment(DepthAttachment));
+        CmdList->BeginRenderPass(RenderPassDesc);
+        CmdList->BindGraphicPipeline(GraphicPipeline);
+        CmdList->PushConstants(&Constants, sizeof(Constants));
+        CmdList->SetViewport({ 0.0f, 0.0f, (float)WindowsWidth, (float)WindowsHeight });
+        CmdList->SetScissor({ 0, 0, WindowsWidth, WindowsHeight });
+        Culler.Draw(CmdList, GeometryBuffer);
+        CmdList->EndRenderPass();
+
+        Culler.CopyDraws(CmdList, Readback.Buffer);
+        std::copy(Eye, Eye + 3, Readback.CameraPosition);
+        Readback.LodErrorScale = LodErrorScale;
+        Readback.bPending = true;
+
+        CmdList->ResourceBarrier(SwapchainColorAttachment, RHI::EResourceState::ColorAttachment, RHI::EResourceState::Present);
+        CmdList->EndCmd();
+
+        RHI::ICmdList* CmdLists[] = { CmdList };
+        FrameScheduler->EndFrame(CmdLists, 1);
+    }
+    FrameScheduler->WaitIdle();
+    printf("Lod check : %llu of %llu frames disagreed with SelectMeshLod\n", (unsigned long long)MismatchFrameNum, (unsigned long long)CheckedFrameNum);
+
+    return 0;
+}
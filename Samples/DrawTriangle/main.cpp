@@ -1,8 +1,10 @@
 #include "RHI/RHI.h"
 #include "OS/Window.h"
-#include "HLSLCompiler/Compiler.h"
+#include "ShaderCompiler/ShaderArchive.h"
+#include "ShaderCompiler/VertexLayoutBuilder.h"
 #include "HLSLCompiler/SystemUtils.h"
 #include <GLFW/glfw3.h>
+#include <cassert>
 #include <fstream>
 #include <vector>
 #include <filesystem>
@@ -45,56 +47,62 @@ int main(int, char **)
                       .CreateWindow();
     auto SwapchainDesc = RHI::FSwapChainDesc()
         .SetFormat(RHI::EFormat::B8G8R8A8_SNORM)
-        .SetVSync(true).SetWindow(&Window);
+        .SetPresentLatency(RHI::EPresentLatency::LowLatency).SetWindow(&Window);
 
     auto Swapchain = Device->CreateSwapChain(SwapchainDesc);
     auto SwapchainTextures = Swapchain->GetTextures();
 
     Window.Attach([&](const OS::FWindowResizeEvent& Event) 
     {
-            auto SwapchainDesc = RHI::FSwapChainDesc()
-                .SetFormat(RHI::EFormat::B8G8R8A8_SNORM)
-                .SetVSync(true).SetWindow(&Window);
-            Device->WaitIdle();
-            Swapchain->Reset();
-            Swapchain = Device->CreateSwapChain(SwapchainDesc);
-            SwapchainTextures = Swapchain->GetTextures();
-
-            WindowsWidth = Event.Width;
-            WindowsHeight = Event.Height;
+            Swapchain->Resize(Event.Width, Event.Height);
     });
    
-    auto TextureCount = Swapchain->GetTextureNum();
-
 #if NEKO_SHADER_DEV
     std::string AssetPath = std::filesystem::exists(ASSETS_PATH) ? ASSETS_PATH : GetExecutableDir();
-#else
-    std::string AssetPath = GetExecutableDir();
-#endif
 
-    ShaderDesc VertexShaderDesc = {
+    ShaderCompiler::FShaderCompileDesc VertexShaderDesc = {
             AssetPath + "/shaders/DrawTriangle.hlsl",
             "mainVS",
             EShaderType::kVertex,
             EShaderFeatureLevel::k6_5};
-    ShaderDesc PixelShaderDesc = {
+    ShaderCompiler::FShaderCompileDesc PixelShaderDesc = {
             AssetPath + "/shaders/DrawTriangle.hlsl",
             "mainPS",
             EShaderType::kPixel,
             EShaderFeatureLevel::k6_5};
 
-    auto VertexShaderCode = Compile(VertexShaderDesc, EShaderBlobType::kSPIRV);
+    ShaderCompiler::FShaderCompiler ShaderCompiler(GetExecutableDir() + "/ShaderCache");
+    auto ShaderCodes = ShaderCompiler.Compile({ VertexShaderDesc, PixelShaderDesc });
+    printf("Shader cache : %u hits, %u misses\n", ShaderCompiler.GetStats().Hits, ShaderCompiler.GetStats().Misses);
+
+    ShaderCompiler::FShaderArchiveView VertexShaderCode = {
+        ShaderCodes[0].Blob.data(), (uint32_t)ShaderCodes[0].Blob.size(),
+        ShaderCodes[0].Reflection.data(), (uint32_t)ShaderCodes[0].Reflection.size() };
+    ShaderCompiler::FShaderArchiveView PixelShaderCode = {
+        ShaderCodes[1].Blob.data(), (uint32_t)ShaderCodes[1].Blob.size(),
+        ShaderCodes[1].Reflection.data(), (uint32_t)ShaderCodes[1].Reflection.size() };
+#else
+    // built by NekoShaderArchiver from Shaders.manifest, the blobs are used straight from the mapping
+    ShaderCompiler::FShaderArchive ShaderArchive;
+    if (!ShaderArchive.Open(GetExecutableDir() + "/DrawTriangle.nsa"))
+    {
+        printf("Failed to open the shader archive\n");
+        return 1;
+    }
+    auto VertexShaderCode = ShaderArchive.Find(ShaderCompiler::GetShaderKey("Shaders/DrawTriangle.hlsl", "mainVS"));
+    auto PixelShaderCode = ShaderArchive.Find(ShaderCompiler::GetShaderKey("Shaders/DrawTriangle.hlsl", "mainPS"));
+#endif
+
     auto VSDesc = RHI::FShaderDesc()
-        .SetBlob((char *)VertexShaderCode.data())
-        .SetSize(VertexShaderCode.size())
+        .SetBlob((const char *)VertexShaderCode.Blob)
+        .SetSize(VertexShaderCode.BlobSize)
         .SetEntryPoint("mainVS")
         .SetStage(RHI::EShaderStage::Vertex);
     auto VS = Device->CreateShader(VSDesc);
 
-    auto PixelShaderCode = Compile(PixelShaderDesc, EShaderBlobType::kSPIRV);;
     auto PSDesc = RHI::FShaderDesc()
-        .SetBlob((char *)PixelShaderCode.data())
-        .SetSize(PixelShaderCode.size())
+        .SetBlob((const char *)PixelShaderCode.Blob)
+        .SetSize(PixelShaderCode.BlobSize)
         .SetEntryPoint("mainPS")
         .SetStage(RHI::EShaderStage::Pixel);
     auto PS = Device->CreateShader(PSDesc);
@@ -105,12 +113,11 @@ int main(int, char **)
     
     auto GraphicQueue = Device->CreateQueue();
 
-    auto CmdPools = GraphicQueue->CreateCmdPools(TextureCount);
-
-    auto SubmissionFences = Device->CreateFences(RHI::EFenceFlag::Signal, TextureCount);
-    auto AcquireSamephores = Device->CreateSemaphores(RHI::ESemaphoreType::Binary, TextureCount);
-    auto ExcuteSamephores = Device->CreateSemaphores(RHI::ESemaphoreType::Binary, TextureCount);
-
+    auto FrameSchedulerDesc = RHI::FFrameSchedulerDesc()
+        .SetFramesInFlight(2)
+        .SetQueue(GraphicQueue)
+        .SetSwapchain(Swapchain);
+    auto FrameScheduler = Device->CreateFrameScheduler(FrameSchedulerDesc);
 
     FVertex V0;
     V0.pos.x = 0.0f;
@@ -138,15 +145,32 @@ int main(int, char **)
 
     std::vector<uint16_t> Indices = { 0,1,2 };
 
-    auto VertexBufferDesc = RHI::FBufferDesc().SetSize(sizeof(FVertex) * Vertices.size()).SetBufferUsage(RHI::EBufferUsage::VertexBuffer | RHI::EBufferUsage::HostAccess);
+    auto VertexBufferDesc = RHI::FBufferDesc().SetSize(sizeof(FVertex) * Vertices.size()).SetBufferUsage(RHI::EBufferUsage::VertexBuffer | RHI::EBufferUsage::HostAccess).SetCategory(RHI::EResourceCategory::Mesh);
     auto VertexBuffer = Device->CreateBuffer(VertexBufferDesc);
 
-    auto IndexBufferDesc = RHI::FBufferDesc().SetSize(sizeof(uint16_t) * Indices.size()).SetBufferUsage(RHI::EBufferUsage::IndexBuffer | RHI::EBufferUsage::HostAccess);
+    auto IndexBufferDesc = RHI::FBufferDesc().SetSize(sizeof(uint16_t) * Indices.size()).SetBufferUsage(RHI::EBufferUsage::IndexBuffer | RHI::EBufferUsage::HostAccess).SetCategory(RHI::EResourceCategory::Mesh);
     auto IndexBuffer = Device->CreateBuffer(IndexBufferDesc);
 
-    auto VertexInputLayout = RHI::FVertexInputLayout().AddBinding({ 0,sizeof(FVertex),RHI::EVertexRate::Vertex })
-        .AddAttribute({ "Position",RHI::EFormat::R32G32_SFLOAT,0,0,0})
-        .AddAttribute({ "VertexColor",RHI::EFormat::R32G32B32_SFLOAT,0,1, sizeof(glm::vec2)});
+    auto VertexBufferPtr = Device->MapBuffer(VertexBuffer, 0, sizeof(FVertex) * Vertices.size());
+    std::memcpy(VertexBufferPtr, Vertices.data(), sizeof(FVertex) * Vertices.size());
+    Device->UnmapBuffer(VertexBuffer);
+
+    auto IndexBufferPtr = Device->MapBuffer(IndexBuffer, 0, sizeof(uint16_t) * Indices.size());
+    std::memcpy(IndexBufferPtr, Indices.data(), sizeof(uint16_t) * Indices.size());
+    Device->UnmapBuffer(IndexBuffer);
+
+    // the layout follows the inputs mainVS reads, in the order FVertex declares them
+    ShaderCompiler::FVertexLayoutBuilder VertexLayoutBuilder;
+    VertexLayoutBuilder.AddElement("POSITION", RHI::EFormat::R32G32_SFLOAT)
+        .AddElement("COLOR", RHI::EFormat::R32G32B32_SFLOAT);
+    ShaderCompiler::FVertexLayout VertexLayout;
+    if (!VertexLayoutBuilder.Build(*VertexShaderCode.GetReflection(), VertexLayout))
+    {
+        printf("Vertex layout : %s\n", VertexLayoutBuilder.GetError().c_str());
+        return 1;
+    }
+    assert(VertexLayout.Streams[0].Stride == sizeof(FVertex));
+    auto VertexInputLayout = VertexLayout.InputLayout;
 
    /* auto BindingLayoutDesc = RHI::FBindingLayoutDesc().AddBinding({ "MVPMatrix", 0 ,RHI::EResourceType::UniformBuffer }).SetShaderStage(RHI::EShaderStage::Vertex);
     auto BindingLayout = Device->CreateBindingLayout(BindingLayoutDesc);*/
@@ -161,9 +185,16 @@ int main(int, char **)
 
     auto GraphicPipeline = Device->CreateGraphicPipeline(GraphicPipelineDesc);
 
+    auto MemoryStats = Device->GetMemoryStats();
+    for (uint32_t i = 0; i < MemoryStats.Heaps.size(); ++i)
+    {
+        auto& Heap = MemoryStats.Heaps[i];
+        printf("Heap %u%s : %llu / %llu MB used\n", i, Heap.bDeviceLocal ? " (device local)" : "",
+            (unsigned long long)(Heap.Usage >> 20), (unsigned long long)(Heap.Budget >> 20));
+    }
+
     // mainloop
       
-    uint32_t FrameNumber = 0;
     while (!Window.ShouldClose())
     {
         OS::FWindow::DoEvents();
@@ -172,35 +203,29 @@ int main(int, char **)
             Window.SetCloseFlag(true);
         }
 
-        uint32_t SwapchainTextureIndex = FrameNumber % TextureCount;
+        if (!FrameScheduler->BeginFrame())
+        {
+            continue;
+        }
+
+        auto SwapchainTexture = FrameScheduler->GetSwapchainTexture();
+        WindowsWidth = SwapchainTexture->GetDesc().Width;
+        WindowsHeight = SwapchainTexture->GetDesc().Height;
 
         auto SwapchainColorAttachmentDesc = RHI::FColorAttachmentDesc()
-            .SetTexture(SwapchainTextures[SwapchainTextureIndex])
-            .SetFormat(SwapchainTextures[SwapchainTextureIndex]->GetDesc().Format);
+            .SetTexture(SwapchainTexture)
+            .SetFormat(SwapchainTexture->GetDesc().Format);
         auto SwapchainColorAttachment = Device->CreateColorAttachment(SwapchainColorAttachmentDesc);
 
-        SubmissionFences[SwapchainTextureIndex]->Wait();
-        SubmissionFences[SwapchainTextureIndex]->Reset();
-
-        auto ImageIdex = Swapchain->AcquireNext(AcquireSamephores[SwapchainTextureIndex],nullptr);
-
-        CmdPools[SwapchainTextureIndex]->Free();
-
-        auto CmdList = CmdPools[SwapchainTextureIndex]->CreateCmdList();
+        auto CmdList = FrameScheduler->CreateCmdList();
        
         CmdList->BeginCmd();
 
-        auto VertexBufferPtr = Device->MapBuffer(VertexBuffer, 0, sizeof(FVertex) * Vertices.size());
-        std::memcpy(VertexBufferPtr, Vertices.data(), sizeof(FVertex) * Vertices.size());
-        Device->UnmapBuffer(VertexBuffer);
-
-        auto IndexBufferPtr = Device->MapBuffer(IndexBuffer, 0, sizeof(uint16_t) * Indices.size());
-        std::memcpy(IndexBufferPtr, Indices.data(), sizeof(uint16_t) * Indices.size());
-        Device->UnmapBuffer(IndexBuffer);
-  
         CmdList->ResourceBarrier(SwapchainColorAttachment, RHI::EResourceState::Undefined, RHI::EResourceState::ColorAttachment);
         
-        auto RenderPassDesc = RHI::FRenderPassDesc().AddColorAttachment(SwapchainColorAttachment);
+        auto RenderPassDesc = RHI::FRenderPassDesc().AddColorAttachment(RHI::FRenderPassColorAttachment(SwapchainColorAttachment)
+            .SetLoadAction(RHI::ELoadOp::Clear)
+            .SetClearColor(RHI::FClearColor().SetR(0.1f).SetG(0.1f).SetB(0.1f)));
         CmdList->BeginRenderPass(RenderPassDesc);
         CmdList->BindGraphicPipeline(GraphicPipeline);
         CmdList->SetViewport({0.0f,0.0f,(float)WindowsWidth,(float)WindowsHeight });
@@ -214,20 +239,11 @@ int main(int, char **)
         CmdList->ResourceBarrier(SwapchainColorAttachment, RHI::EResourceState::ColorAttachment, RHI::EResourceState::Present);
         
         CmdList->EndCmd();
-        
-        auto ExcuteDesc = RHI::FExcuteDesc().AddSignalSemaphore(ExcuteSamephores[SwapchainTextureIndex]).SetFence(SubmissionFences[SwapchainTextureIndex]);
-        GraphicQueue->ExcuteCmdList(CmdList, ExcuteDesc);
-
-        auto PresentDesc = RHI::FPresentDesc()
-            .AddWaitSemaphore(ExcuteSamephores[SwapchainTextureIndex])
-            .SetQueue(GraphicQueue)
-            .SetPresentIndex(ImageIdex);
-        Swapchain->Present(PresentDesc);
 
-        
-        FrameNumber++;
+        RHI::ICmdList* CmdLists[] = { CmdList };
+        FrameScheduler->EndFrame(CmdLists, 1);
     }
-    Device->WaitIdle();
+    FrameScheduler->WaitIdle();
 
     return 0;
 }
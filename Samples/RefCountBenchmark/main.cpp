@@ -0,0 +1,142 @@
+#include "RHI/RHI.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+using namespace Neko;
+
+// the counting RefCounter did before, virtual and sequentially consistent, kept here as the baseline
+class ILegacyResource
+{
+public:
+    virtual ~ILegacyResource() = default;
+    virtual unsigned long AddRef() = 0;
+    virtual unsigned long Release() = 0;
+};
+
+class FLegacyResource : public ILegacyResource
+{
+    std::atomic<unsigned long> RefCount = 0;
+
+public:
+    virtual unsigned long AddRef() override { return ++RefCount; }
+    virtual unsigned long Release() override
+    {
+        auto Ret = --RefCount;
+        if (Ret == 0)
+        {
+            delete this;
+        }
+        return Ret;
+    }
+};
+
+class FResource final : public RefCounter<IResource>
+{
+};
+
+// stands in for a desc setter or a function taking a reference by value, kept out of line so the copy happens
+template <typename TPtr>
+[[gnu::noinline]] void Consume(TPtr Ptr, void** Sink)
+{
+    *Sink = Ptr.GetPtr();
+}
+
+template <typename TPtr>
+[[gnu::noinline]] void ConsumeRef(const TPtr& Ptr, void** Sink)
+{
+    *Sink = Ptr.GetPtr();
+}
+
+template <typename TFunction>
+static double Measure(const char* Name, uint32_t ThreadNum, uint64_t Iterations, TFunction&& Function)
+{
+    auto Begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> Threads;
+    for (uint32_t i = 0; i < ThreadNum; ++i)
+    {
+        Threads.emplace_back([&]() { Function(Iterations); });
+    }
+    for (auto& Thread : Threads)
+    {
+        Thread.join();
+    }
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Begin).count();
+    double NsPerOp = Seconds * 1e9 / (double)Iterations;
+    printf("    %-36s %8.2f ns\n", Name, NsPerOp);
+    return NsPerOp;
+}
+
+static void Run(uint32_t ThreadNum, uint64_t Iterations)
+{
+    printf("%u thread(s), one shared object, per copy into a by-value parameter :\n", ThreadNum);
+
+    // held through the interface so the calls stay virtual, like the old IXRef handles did
+    RefCountPtr<ILegacyResource> Legacy = new FLegacyResource();
+    RefCountPtr<FResource> Resource = new FResource();
+    std::atomic<void*> Sink = nullptr;
+
+    double LegacyNs = Measure("virtual seq_cst RefCountPtr copy", ThreadNum, Iterations, [&](uint64_t Num)
+    {
+        void* Local = nullptr;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            Consume(Legacy, &Local);
+        }
+        Sink = Local;
+    });
+    double CopyNs = Measure("non-virtual relaxed RefCountPtr copy", ThreadNum, Iterations, [&](uint64_t Num)
+    {
+        void* Local = nullptr;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            Consume(Resource, &Local);
+        }
+        Sink = Local;
+    });
+    Measure("RefCountPtr by const reference", ThreadNum, Iterations, [&](uint64_t Num)
+    {
+        void* Local = nullptr;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            ConsumeRef(Resource, &Local);
+        }
+        Sink = Local;
+    });
+    double BorrowedNs = Measure("BorrowedPtr copy", ThreadNum, Iterations, [&](uint64_t Num)
+    {
+        void* Local = nullptr;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            Consume(BorrowedPtr<FResource>(Resource), &Local);
+        }
+        Sink = Local;
+    });
+    Measure("RefCountPtr move in and back", ThreadNum, Iterations, [&](uint64_t Num)
+    {
+        // a thread local owner, moving it around never touches the count
+        RefCountPtr<FResource> Owner = Resource;
+        void* Local = nullptr;
+        for (uint64_t i = 0; i < Num; ++i)
+        {
+            RefCountPtr<FResource> Moved = std::move(Owner);
+            ConsumeRef(Moved, &Local);
+            Owner = std::move(Moved);
+        }
+        Sink = Local;
+    });
+
+    printf("    copy speedup %.2fx, borrowed speedup %.2fx\n\n", LegacyNs / CopyNs, LegacyNs / BorrowedNs);
+    (void)Sink;
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t Iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000000;
+    Run(1, Iterations);
+    Run(std::max(2u, std::thread::hardware_concurrency() / 2), Iterations / 4);
+    return 0;
+}
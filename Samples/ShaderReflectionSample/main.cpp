@@ -1,5 +1,6 @@
-#include "HLSLCompiler/Compiler.h"
-#include "ShaderReflection/ShaderReflection.h"
+#include "ShaderCompiler/ShaderCompiler.h"
+#include "HLSLCompiler/SystemUtils.h"
+#include "ShaderReflection/ShaderReflectionCache.h"
 #include <iostream>
 #include <cassert>
 #include <algorithm>
@@ -24,36 +25,39 @@ inline bool operator< (const FResourceBindingTestDesc& lhs, const FResourceBindi
 
 int main()
 {
-    ShaderDesc vertexShaderDesc = {
+    Neko::ShaderCompiler::FShaderCompileDesc vertexShaderDesc = {
             ASSETS_PATH"shaders/VertexShader.hlsl",
             "mainVS",
             EShaderType::kVertex,
             EShaderFeatureLevel::k6_5};
-    ShaderDesc pixelShaderDesc = {
+    Neko::ShaderCompiler::FShaderCompileDesc pixelShaderDesc = {
             ASSETS_PATH"shaders/PixelShader.hlsl",
             "mainPS",
             EShaderType::kPixel,
             EShaderFeatureLevel::k6_5};
-    ShaderDesc rayTracingShaderDesc = {
+    Neko::ShaderCompiler::FShaderCompileDesc rayTracingShaderDesc = {
             ASSETS_PATH"shaders/RayTracing.hlsl",
             "",
             EShaderType::kLibrary,
             EShaderFeatureLevel::k6_5};
-    ShaderDesc meshShaderDesc = {
+    Neko::ShaderCompiler::FShaderCompileDesc meshShaderDesc = {
             ASSETS_PATH"shaders/MeshletMS.hlsl",
             "mainMS",
             EShaderType::kMesh,
             EShaderFeatureLevel::k6_5};
 
-    auto vs_blob = Compile(vertexShaderDesc, EShaderBlobType::kSPIRV);
-    auto ps_blob = Compile(pixelShaderDesc, EShaderBlobType::kSPIRV);
-    auto rt_sbt_blob = Compile(rayTracingShaderDesc, EShaderBlobType::kSPIRV);
-    auto ms_blob = Compile(meshShaderDesc, EShaderBlobType::kSPIRV);
+    Neko::ShaderCompiler::FShaderCompiler compiler(GetExecutableDir() + "/ShaderCache");
+    auto blobs = compiler.Compile({ vertexShaderDesc, pixelShaderDesc, rayTracingShaderDesc, meshShaderDesc });
+    auto& vs_blob = blobs[0].Blob;
+    auto& ps_blob = blobs[1].Blob;
+    auto& rt_sbt_blob = blobs[2].Blob;
+    auto& ms_blob = blobs[3].Blob;
 
-    auto vs_reflection = CreateShaderReflection(EShaBlobType::kSPIRV, vs_blob.data(), vs_blob.size());
-    auto ps_reflection = CreateShaderReflection(EShaBlobType::kSPIRV, ps_blob.data(), ps_blob.size());
-    auto rt_sbt_reflection = CreateShaderReflection(EShaBlobType::kSPIRV, rt_sbt_blob.data(), rt_sbt_blob.size());
-    auto ms_reflection = CreateShaderReflection(EShaBlobType::kSPIRV, ms_blob.data(), ms_blob.size());
+    FShaderReflectionCache reflection_cache(GetExecutableDir() + "/ReflectionCache");
+    auto vs_reflection = reflection_cache.GetOrCreate(EShaBlobType::kSPIRV, vs_blob.data(), vs_blob.size());
+    auto ps_reflection = reflection_cache.GetOrCreate(EShaBlobType::kSPIRV, ps_blob.data(), ps_blob.size());
+    auto rt_sbt_reflection = reflection_cache.GetOrCreate(EShaBlobType::kSPIRV, rt_sbt_blob.data(), rt_sbt_blob.size());
+    auto ms_reflection = reflection_cache.GetOrCreate(EShaBlobType::kSPIRV, ms_blob.data(), ms_blob.size());
 
     // Check vs
     std::vector<FEntryPoint> vs_expect = {
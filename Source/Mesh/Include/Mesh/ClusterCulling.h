@@ -0,0 +1,70 @@
+#pragma once
+#include "Mesh/MeshPackage.h"
+namespace Neko::Mesh
+{
+    constexpr uint32_t CLUSTER_CULLING_GROUP_SIZE = 64;
+
+    // a meshlet resolved against the geometry buffer its mesh was uploaded to, mirrored by Shaders/ClusterCulling.hlsl
+    struct FClusterMeshlet
+    {
+        float Center[3];
+        float Radius;
+        float ConeApex[3];
+        float ConeCutoff;
+        float ConeAxis[3];
+        uint32_t FirstIndex;
+        uint32_t IndexNum;
+        int32_t VertexOffset;
+        // the meshlet is drawn while its level is the one SelectMeshLod would pick
+        float LodError;
+        float CoarserLodError; // FLT_MAX on the last level
+        float MeshCenter[3];
+        float MeshRadius;
+    };
+    static_assert(sizeof(FClusterMeshlet) == 80);
+
+    struct FClusterCullingConstants
+    {
+        float FrustumPlanes[6][4];
+        float CameraPosition[3];
+        uint32_t MeshletNum;
+        float LodErrorScale;
+    };
+    static_assert(sizeof(FClusterCullingConstants) <= 128);
+
+    // gpu driven culling of the meshlets of every added mesh, the surviving meshlets are written as
+    // compacted indirect draws, so dense meshes only rasterize the clusters that can be visible.
+    // the meshlets of all levels of detail are added, each mesh draws only the level that fits its distance.
+    // meshes are culled in the space their vertices are in, the cooker bakes node transforms into them
+    class FClusterCuller : public FUncopyable
+    {
+    public:
+        // CullingShader is mainCS of Shaders/ClusterCulling.hlsl, Device needs the Compute and DrawIndirectCount features
+        FClusterCuller(RHI::IDevice* Device, RHI::IShader* CullingShader, uint32_t InMaxMeshletNum = 1 << 20);
+
+        // stages the meshlets of a mesh that was uploaded with UploadMesh, false if the mesh has no meshlets or the culler is full
+        bool AddMesh(const FMeshView& Mesh, const RHI::FGeometryAllocation& Allocation, RHI::IFrameScheduler* Scheduler, RHI::ICmdList* CmdList);
+
+        // ViewProjection is row major and maps column vectors to vulkan clip space, LodErrorScale comes from GetLodErrorScale
+        void Cull(RHI::ICmdList* CmdList, const float ViewProjection[16], const float CameraPosition[3], float LodErrorScale);
+
+        // call inside a render pass with the graphic pipeline bound
+        void Draw(RHI::ICmdList* CmdList, RHI::FGeometryBuffer& GeometryBuffer);
+
+        // copies the draw count and the draws the last Cull wrote to Dest, GetDrawReadbackSize bytes with the count first,
+        // the draws name their meshlet in FirstInstance, so the gpu's selection can be checked on the cpu
+        void CopyDraws(RHI::ICmdList* CmdList, RHI::IBuffer* Dest);
+        uint64_t GetDrawReadbackSize() const { return sizeof(uint32_t) + (uint64_t)sizeof(RHI::FDrawIndexedIndirectArgs) * MeshletNum; }
+
+        uint32_t GetMeshletNum() const { return MeshletNum; }
+
+    private:
+        RHI::IComputePipelineRef Pipeline;
+        RHI::IBufferRef MeshletBuffer;
+        RHI::IBufferRef DrawBuffer;
+        RHI::IBufferRef CountBuffer;
+        uint32_t MeshletNum = 0;
+        uint32_t MaxMeshletNum = 0;
+        bool bMeshletsDirty = false;
+    };
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <cstdint>
+namespace Neko::Mesh
+{
+    // on-disk layout of a cooked mesh package, written by NekoMeshCook:
+    //   header | mesh table | sections
+    // every section starts at a MESH_SECTION_ALIGNMENT boundary so it can be used in place
+    constexpr uint32_t MESH_PACKAGE_MAGIC = 0x48534D4E; // "NMSH"
+    constexpr uint32_t MESH_PACKAGE_VERSION = 5;
+    constexpr uint32_t MESH_SECTION_ALIGNMENT = 16;
+    constexpr uint32_t MAX_MESH_ATTRIBUTE_COUNT = 8;
+    // limits meshopt recommends for cluster culling and mesh shaders alike
+    constexpr uint32_t MAX_MESHLET_VERTEX_COUNT = 64;
+    constexpr uint32_t MAX_MESHLET_TRIANGLE_COUNT = 124;
+    constexpr uint32_t MAX_MESH_LOD_COUNT = 8;
+
+    enum class EMeshAttribute : uint8_t
+    {
+        Position,
+        Normal,
+        Tangent,
+        TexCoord0,
+        Color,
+        Count
+    };
+
+    // hlsl semantic a shader reads the attribute with
+    inline const char* GetMeshAttributeSemantic(EMeshAttribute Attribute)
+    {
+        switch (Attribute)
+        {
+        case EMeshAttribute::Position: return "POSITION";
+        case EMeshAttribute::Normal: return "NORMAL";
+        case EMeshAttribute::Tangent: return "TANGENT";
+        case EMeshAttribute::TexCoord0: return "TEXCOORD";
+        case EMeshAttribute::Color: return "COLOR";
+        default: return "";
+        }
+    }
+
+    // stable on-disk values, independent of RHI::EFormat
+    enum class EMeshVertexFormat : uint8_t
+    {
+        Float2,
+        Float3,
+        Float4,
+        // quantized formats, the vertex fetch expands them to float
+        Half2,
+        Half4,
+        Snorm16x2, // octahedral encoded unit vector, see MeshQuantization.hlsli
+        Snorm8x4,
+        Unorm8x4,
+        Unorm16x4, // position relative to the mesh bounds, see FMeshEntry::PositionOffset
+    };
+
+    inline uint32_t GetMeshVertexFormatSize(EMeshVertexFormat Format)
+    {
+        switch (Format)
+        {
+        case EMeshVertexFormat::Float2: return 8;
+        case EMeshVertexFormat::Float3: return 12;
+        case EMeshVertexFormat::Float4: return 16;
+        case EMeshVertexFormat::Half2: return 4;
+        case EMeshVertexFormat::Half4: return 8;
+        case EMeshVertexFormat::Snorm16x2: return 4;
+        case EMeshVertexFormat::Snorm8x4: return 4;
+        case EMeshVertexFormat::Unorm8x4: return 4;
+        case EMeshVertexFormat::Unorm16x4: return 8;
+        default: return 0;
+        }
+    }
+
+    struct FMeshSection
+    {
+        uint64_t Offset;
+        uint64_t Size;
+    };
+
+    struct FMeshBounds
+    {
+        float Min[3];
+        float Max[3];
+        float Center[3];
+        float Radius;
+    };
+
+    struct FMeshAttributeDesc
+    {
+        EMeshAttribute Attribute;
+        EMeshVertexFormat Format;
+        uint16_t Offset;
+    };
+
+    // a cluster of triangles occupying a contiguous range of the mesh indices,
+    // laid out like a std430 structured buffer element so it can be uploaded as is
+    struct FMeshlet
+    {
+        float Center[3];
+        float Radius;
+        float ConeApex[3];
+        float ConeCutoff; // cos of half the normal cone angle, 1 or more disables cone culling
+        float ConeAxis[3];
+        uint32_t FirstIndex; // relative to the first index of the mesh
+        uint32_t IndexNum;
+        uint32_t Reserved[3];
+    };
+    static_assert(sizeof(FMeshlet) == 64);
+
+    // one level of detail, all levels share the vertices of the mesh
+    struct FMeshLod
+    {
+        uint32_t FirstIndex; // relative to the first index of the mesh
+        uint32_t IndexNum;
+        uint32_t FirstMeshlet;
+        uint32_t MeshletNum;
+        // object space deviation from the full detail mesh, never decreases along the chain
+        float Error;
+        uint32_t Reserved[3];
+    };
+
+    // FMeshEntry::Flags
+    // vertex and index sections hold meshopt_encodeVertexBuffer / meshopt_encodeIndexBuffer streams,
+    // their sizes are then the encoded ones and the mesh has to be decoded before it reaches the gpu
+    // the index codec may rotate the corners of a triangle, winding and triangle order are kept
+    constexpr uint32_t MESH_ENTRY_ENCODED = 1 << 0;
+
+    struct FMeshPackageHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t MeshNum;
+        uint32_t Reserved;
+        uint64_t FileSize;
+        uint64_t MeshTableOffset;
+    };
+
+    struct FMeshEntry
+    {
+        uint64_t NameHash; // HashString of the name
+        FMeshSection Name;
+        FMeshBounds Bounds;
+        // object space position = PositionOffset + fetched position * PositionScale,
+        // identity unless the position is Unorm16x4
+        float PositionOffset[3];
+        float PositionScale[3];
+        uint32_t VertexNum;
+        uint32_t VertexStride;
+        uint32_t IndexNum;
+        uint32_t IndexSize; // 2 or 4, after decoding when the mesh is encoded
+        uint32_t AttributeNum;
+        uint32_t MeshletNum; // 0 if the mesh was cooked without meshlets
+        uint32_t LodNum; // at least 1, level 0 is the full detail mesh
+        uint32_t Flags;
+        FMeshAttributeDesc Attributes[MAX_MESH_ATTRIBUTE_COUNT];
+        FMeshLod Lods[MAX_MESH_LOD_COUNT];
+        FMeshSection Vertices;
+        FMeshSection Indices; // level after level, each in meshlet order when there are meshlets
+        FMeshSection Meshlets;
+    };
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "Mesh/MeshFormat.h"
+#include "RHI/GeometryBuffer.h"
+#include "OS/MappedFile.h"
+#include "MiniCore/JobSystem.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+namespace Neko::Mesh
+{
+    // points into the mapping, valid while the package is open
+    struct FMeshView
+    {
+        const FMeshEntry* Entry = nullptr;
+        std::string_view Name;
+        const uint8_t* Vertices = nullptr;
+        const uint8_t* Indices = nullptr;
+        const FMeshlet* Meshlets = nullptr;
+        // vertices and indices are meshopt streams of Entry->Vertices.Size and Entry->Indices.Size bytes
+        bool bEncoded = false;
+
+        bool IsValid() const { return Entry != nullptr; }
+        uint64_t GetVertexDataSize() const { return (uint64_t)Entry->VertexNum * Entry->VertexStride; }
+        uint64_t GetIndexDataSize() const { return (uint64_t)Entry->IndexNum * Entry->IndexSize; }
+    };
+
+    inline RHI::EFormat GetMeshVertexRHIFormat(EMeshVertexFormat Format)
+    {
+        switch (Format)
+        {
+        case EMeshVertexFormat::Float2: return RHI::EFormat::R32G32_SFLOAT;
+        case EMeshVertexFormat::Float3: return RHI::EFormat::R32G32B32_SFLOAT;
+        case EMeshVertexFormat::Float4: return RHI::EFormat::R32G32B32A32_SFLOAT;
+        case EMeshVertexFormat::Half2: return RHI::EFormat::R16G16_SFLOAT;
+        case EMeshVertexFormat::Half4: return RHI::EFormat::R16G16B16A16_SFLOAT;
+        case EMeshVertexFormat::Snorm16x2: return RHI::EFormat::R16G16_SNORM;
+        case EMeshVertexFormat::Snorm8x4: return RHI::EFormat::R8G8B8A8_SNORM;
+        case EMeshVertexFormat::Unorm8x4: return RHI::EFormat::R8G8B8A8_UNORM;
+        case EMeshVertexFormat::Unorm16x4: return RHI::EFormat::R16G16B16A16_UNORM;
+        default: return RHI::EFormat::Undefined;
+        }
+    }
+
+    // a cooked .nmesh file used in place, opening it reads nothing but the header and mesh table,
+    // vertex and index sections are paged in when they are copied to the gpu
+    class FMeshPackage : public FUncopyable
+    {
+    public:
+        // maps the file and validates the header and every mesh entry
+        bool Open(const std::string& Path);
+        void Close();
+        bool IsOpen() const { return Header != nullptr; }
+
+        uint32_t GetMeshNum() const;
+        FMeshView GetMesh(uint32_t Index) const;
+        FMeshView FindMesh(std::string_view Name) const;
+
+    private:
+        OS::FMappedFile File;
+        const FMeshPackageHeader* Header = nullptr;
+        const FMeshEntry* MeshTable = nullptr;
+    };
+
+    // how many pixels one unit of object space error covers at distance 1, divided by the tolerated error in pixels,
+    // FovY is the vertical field of view in radians
+    float GetLodErrorScale(float ViewportHeight, float FovY, float MaxPixelError = 1.0f);
+
+    // the coarsest level whose error stays within the tolerance at the distance of the mesh bounds
+    uint32_t SelectMeshLod(const FMeshEntry& Entry, const float CameraPosition[3], float LodErrorScale);
+
+    // draws one level of a mesh uploaded with UploadMesh, the geometry buffer must be bound
+    void DrawMeshLod(RHI::ICmdList* CmdList, const FMeshEntry& Entry, uint32_t Lod, const RHI::FGeometryAllocation& Allocation);
+
+    // copies one mesh into cpu visible memory, e.g. a persistently mapped buffer,
+    // indices are widened when IndexSize is 4 and the package stores them as 16 bit,
+    // encoded meshes are decoded straight into the destinations, which then should be cached memory.
+    // packages aren't trusted, false if an index or meshlet points past the vertices or indices of the mesh
+    bool WriteMesh(const FMeshView& Mesh, uint8_t* VertexDest, uint8_t* IndexDest, uint32_t IndexSize);
+
+    // allocates the mesh in the geometry buffer, stages it in the frame upload ring and records the copies,
+    // returns an invalid allocation if the layouts don't match, the mesh fails to decode or validate or either allocator is out of space,
+    // encoded meshes are decoded on the calling thread, FMeshDecoder moves that off the render thread
+    [[nodiscard]] RHI::FGeometryAllocation UploadMesh(const FMeshView& Mesh, RHI::IFrameScheduler* Scheduler, RHI::ICmdList* CmdList, RHI::FGeometryBuffer& GeometryBuffer);
+
+    // a mesh whose vertex and index streams were decoded into memory it owns
+    struct FDecodedMesh
+    {
+        FMeshView Source;
+        std::vector<uint8_t> Vertices;
+        std::vector<uint8_t> Indices;
+        bool bValid = false;
+
+        // a plain view over the decoded streams, valid while both this and the package are alive
+        FMeshView GetView() const;
+    };
+
+    // meshes that aren't encoded are copied, so the result never depends on the mapping being paged in
+    bool DecodeMesh(const FMeshView& Mesh, FDecodedMesh& Decoded);
+
+    // decodes meshes as jobs, several at once, the meshopt decoders use sse or neon where available,
+    // packages must stay open until their meshes are polled
+    class FMeshDecoder : public FUncopyable
+    {
+    public:
+        // without a job system the decoder starts its own on the first mesh, one without workers
+        // only decodes in Flush
+        explicit FMeshDecoder(FJobSystem* JobSystem = nullptr);
+        ~FMeshDecoder();
+
+        void Enqueue(const FMeshView& Mesh);
+        // hands out decoded meshes in the order they were enqueued, false if the next one isn't done yet
+        bool Poll(FDecodedMesh& Mesh);
+        // blocks until every enqueued mesh is decoded, runs decode jobs on the calling thread meanwhile
+        void Flush();
+
+    private:
+        struct FSlot
+        {
+            FDecodedMesh Mesh;
+            std::atomic<bool> bDone = false;
+        };
+
+        FJobSystem* JobSystem;
+        std::unique_ptr<FJobSystem> OwnedJobSystem;
+        FJobCounter Counter;
+        std::mutex Mutex;
+        // in the order they were enqueued, a deque keeps the slots in place while the jobs fill them
+        std::deque<FSlot> Slots;
+    };
+}
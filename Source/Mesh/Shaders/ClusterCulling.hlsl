@@ -0,0 +1,96 @@
+// one thread per meshlet, every meshlet of the selected level of detail that survives frustum and normal cone culling
+// appends an indexed draw of its triangles, the draw count is consumed by DrawIndexedIndirectCount
+
+// mirrors Neko::Mesh::FClusterMeshlet
+struct FClusterMeshlet
+{
+    float3 Center;
+    float Radius;
+    float3 ConeApex;
+    float ConeCutoff;
+    float3 ConeAxis;
+    uint FirstIndex;
+    uint IndexNum;
+    int VertexOffset;
+    float LodError;
+    float CoarserLodError;
+    float3 MeshCenter;
+    float MeshRadius;
+};
+
+// mirrors Neko::Mesh::FClusterCullingConstants
+struct FCullingConstants
+{
+    float4 FrustumPlanes[6];
+    float3 CameraPosition;
+    uint MeshletNum;
+    float LodErrorScale;
+};
+
+struct FDrawIndexedIndirectArgs
+{
+    uint IndexNum;
+    uint InstanceNum;
+    uint FirstIndex;
+    int VertexOffset;
+    uint FirstInstance;
+};
+
+[[vk::push_constant]] FCullingConstants Constants;
+
+[[vk::binding(0)]] StructuredBuffer<FClusterMeshlet> Meshlets;
+[[vk::binding(1)]] RWStructuredBuffer<FDrawIndexedIndirectArgs> Draws;
+[[vk::binding(2)]] RWByteAddressBuffer DrawCount;
+
+bool IsInsideFrustum(float3 Center, float Radius)
+{
+    [unroll]
+    for (uint i = 0; i < 6; ++i)
+    {
+        if (dot(Constants.FrustumPlanes[i].xyz, Center) + Constants.FrustumPlanes[i].w < -Radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// same choice as SelectMeshLod, made from per mesh values so all meshlets of a mesh agree
+bool IsSelectedLod(FClusterMeshlet Meshlet)
+{
+    float Distance = max(length(Meshlet.MeshCenter - Constants.CameraPosition) - Meshlet.MeshRadius, 0.0);
+    return Meshlet.LodError * Constants.LodErrorScale <= Distance && Meshlet.CoarserLodError * Constants.LodErrorScale > Distance;
+}
+
+// every triangle of the cluster faces away from the camera
+bool IsBackfacing(FClusterMeshlet Meshlet)
+{
+    return dot(normalize(Meshlet.ConeApex - Constants.CameraPosition), Meshlet.ConeAxis) >= Meshlet.ConeCutoff;
+}
+
+[numthreads(64, 1, 1)]
+void mainCS(uint3 DispatchThreadID : SV_DispatchThreadID)
+{
+    uint MeshletIndex = DispatchThreadID.x;
+    if (MeshletIndex >= Constants.MeshletNum)
+    {
+        return;
+    }
+
+    FClusterMeshlet Meshlet = Meshlets[MeshletIndex];
+    if (!IsSelectedLod(Meshlet) || !IsInsideFrustum(Meshlet.Center, Meshlet.Radius) || IsBackfacing(Meshlet))
+    {
+        return;
+    }
+
+    uint DrawIndex;
+    DrawCount.InterlockedAdd(0, 1, DrawIndex);
+
+    FDrawIndexedIndirectArgs Draw;
+    Draw.IndexNum = Meshlet.IndexNum;
+    Draw.InstanceNum = 1;
+    Draw.FirstIndex = Meshlet.FirstIndex;
+    Draw.VertexOffset = Meshlet.VertexOffset;
+    Draw.FirstInstance = MeshletIndex;
+    Draws[DrawIndex] = Draw;
+}
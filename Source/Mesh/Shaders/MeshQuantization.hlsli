@@ -0,0 +1,24 @@
+// decoding of the quantized vertex formats NekoMeshCook writes, the input assembler already expands
+// half, unorm and snorm elements to float, positions and octahedral normals need work in the shader
+
+// Unorm16x4 position, Offset and Scale are PositionOffset and PositionScale of the mesh entry
+float3 DequantizePosition(float3 Position, float3 Offset, float3 Scale)
+{
+    return Offset + Position * Scale;
+}
+
+// Snorm16x2 normal, the inverse of EncodeOctahedral in MeshCook.cpp
+float3 DecodeOctahedral(float2 Encoded)
+{
+    float3 Normal = float3(Encoded, 1.0 - abs(Encoded.x) - abs(Encoded.y));
+    float Fold = saturate(-Normal.z);
+    Normal.x += Normal.x >= 0.0 ? -Fold : Fold;
+    Normal.y += Normal.y >= 0.0 ? -Fold : Fold;
+    return normalize(Normal);
+}
+
+// Snorm8x4 tangent, w is the bitangent sign
+float3 DecodeBitangent(float3 Normal, float4 Tangent)
+{
+    return cross(Normal, normalize(Tangent.xyz)) * (Tangent.w < 0.0 ? -1.0 : 1.0);
+}
@@ -0,0 +1,202 @@
+#include "Mesh/ClusterCulling.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Neko::Mesh
+{
+    FClusterCuller::FClusterCuller(RHI::IDevice* Device, RHI::IShader* CullingShader, uint32_t InMaxMeshletNum)
+        : MaxMeshletNum(InMaxMeshletNum)
+    {
+        assert(Device != nullptr && CullingShader != nullptr);
+        assert(Device->GetFeatures().Compute && Device->GetFeatures().DrawIndirectCount);
+
+        auto PipelineDesc = RHI::FComputePipelineDesc()
+            .SetComputeShader(CullingShader)
+            .SetStorageBufferNum(3)
+            .SetPushConstantSize(sizeof(FClusterCullingConstants));
+        Pipeline = Device->CreateComputePipeline(PipelineDesc);
+
+        auto MeshletBufferDesc = RHI::FBufferDesc()
+            .SetSize((uint64_t)sizeof(FClusterMeshlet) * MaxMeshletNum)
+            .SetBufferUsage(RHI::EBufferUsage::StorageBuffer | RHI::EBufferUsage::TransferDest)
+            .SetCategory(RHI::EResourceCategory::Mesh);
+        MeshletBuffer = Device->CreateBuffer(MeshletBufferDesc);
+
+        auto DrawBufferDesc = RHI::FBufferDesc()
+            .SetSize((uint64_t)sizeof(RHI::FDrawIndexedIndirectArgs) * MaxMeshletNum)
+            .SetBufferUsage(RHI::EBufferUsage::StorageBuffer | RHI::EBufferUsage::IndirectBuffer | RHI::EBufferUsage::TransferSrc)
+            .SetCategory(RHI::EResourceCategory::Mesh);
+        DrawBuffer = Device->CreateBuffer(DrawBufferDesc);
+
+        auto CountBufferDesc = RHI::FBufferDesc()
+            .SetSize(sizeof(uint32_t))
+            .SetBufferUsage(RHI::EBufferUsage::StorageBuffer | RHI::EBufferUsage::IndirectBuffer | RHI::EBufferUsage::TransferSrc | RHI::EBufferUsage::TransferDest)
+            .SetCategory(RHI::EResourceCategory::Mesh);
+        CountBuffer = Device->CreateBuffer(CountBufferDesc);
+    }
+
+    bool FClusterCuller::AddMesh(const FMeshView& Mesh, const RHI::FGeometryAllocation& Allocation, RHI::IFrameScheduler* Scheduler, RHI::ICmdList* CmdList)
+    {
+        assert(Mesh.IsValid() && Allocation.IsValid());
+        uint32_t Num = Mesh.Entry->MeshletNum;
+        if (Num == 0 || Num > MaxMeshletNum - MeshletNum)
+        {
+            return false;
+        }
+
+        uint64_t Size = (uint64_t)sizeof(FClusterMeshlet) * Num;
+        auto Staging = Scheduler->AllocateUpload(Size, alignof(FClusterMeshlet));
+        if (!Staging.IsValid())
+        {
+            return false;
+        }
+
+        auto& Entry = *Mesh.Entry;
+        auto Meshlets = reinterpret_cast<FClusterMeshlet*>(Staging.Data);
+        for (uint32_t i = 0; i < Num; ++i)
+        {
+            uint32_t Lod = 0;
+            while (Lod + 1 < Entry.LodNum && i >= Entry.Lods[Lod].FirstMeshlet + Entry.Lods[Lod].MeshletNum)
+            {
+                ++Lod;
+            }
+
+            auto& Source = Mesh.Meshlets[i];
+            auto& Meshlet = Meshlets[i];
+            std::copy(Source.Center, Source.Center + 3, Meshlet.Center);
+            Meshlet.Radius = Source.Radius;
+            std::copy(Source.ConeApex, Source.ConeApex + 3, Meshlet.ConeApex);
+            Meshlet.ConeCutoff = Source.ConeCutoff;
+            std::copy(Source.ConeAxis, Source.ConeAxis + 3, Meshlet.ConeAxis);
+            Meshlet.FirstIndex = Allocation.GetFirstIndex() + Source.FirstIndex;
+            Meshlet.IndexNum = Source.IndexNum;
+            Meshlet.VertexOffset = (int32_t)Allocation.GetVertexOffset();
+            Meshlet.LodError = Entry.Lods[Lod].Error;
+            Meshlet.CoarserLodError = Lod + 1 < Entry.LodNum ? Entry.Lods[Lod + 1].Error : FLT_MAX;
+            std::copy(Entry.Bounds.Center, Entry.Bounds.Center + 3, Meshlet.MeshCenter);
+            Meshlet.MeshRadius = Entry.Bounds.Radius;
+        }
+
+        auto CopyDesc = RHI::FCopyBufferDesc()
+            .SetSrcOffset(Staging.Offset)
+            .SetDestOffset((uint64_t)sizeof(FClusterMeshlet) * MeshletNum)
+            .SetSize(Size);
+        CmdList->CopyBuffer(MeshletBuffer, Staging.Buffer, CopyDesc);
+
+        MeshletNum += Num;
+        bMeshletsDirty = true;
+        return true;
+    }
+
+    static void ExtractFrustumPlanes(const float M[16], float Planes[6][4])
+    {
+        // rows of the matrix combined as in gribb and hartmann, near uses vulkan's 0..1 depth range
+        auto Row = [M](int i, int j) { return M[i * 4 + j]; };
+        for (int j = 0; j < 4; ++j)
+        {
+            Planes[0][j] = Row(3, j) + Row(0, j);
+            Planes[1][j] = Row(3, j) - Row(0, j);
+            Planes[2][j] = Row(3, j) + Row(1, j);
+            Planes[3][j] = Row(3, j) - Row(1, j);
+            Planes[4][j] = Row(2, j);
+            Planes[5][j] = Row(3, j) - Row(2, j);
+        }
+        // normalized so the shader can compare the plane distance to the sphere radius
+        for (int i = 0; i < 6; ++i)
+        {
+            float Length = std::sqrt(Planes[i][0] * Planes[i][0] + Planes[i][1] * Planes[i][1] + Planes[i][2] * Planes[i][2]);
+            for (int j = 0; j < 4; ++j)
+            {
+                Planes[i][j] /= Length;
+            }
+        }
+    }
+
+    void FClusterCuller::Cull(RHI::ICmdList* CmdList, const float ViewProjection[16], const float CameraPosition[3], float LodErrorScale)
+    {
+        if (bMeshletsDirty)
+        {
+            CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+                .SetBuffer(MeshletBuffer)
+                .SetSrcState(RHI::EResourceState::TransferDest)
+                .SetDestState(RHI::EResourceState::ShaderRead));
+            bMeshletsDirty = false;
+        }
+
+        // the previous frame's indirect draw must be done with both buffers before they are overwritten
+        CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+            .SetBuffer(CountBuffer)
+            .SetSrcState(RHI::EResourceState::IndirectArgument)
+            .SetDestState(RHI::EResourceState::TransferDest));
+        CmdList->FillBuffer(CountBuffer, 0, sizeof(uint32_t), 0);
+        CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+            .SetBuffer(CountBuffer)
+            .SetSrcState(RHI::EResourceState::TransferDest)
+            .SetDestState(RHI::EResourceState::ShaderWrite));
+        CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+            .SetBuffer(DrawBuffer)
+            .SetSrcState(RHI::EResourceState::IndirectArgument)
+            .SetDestState(RHI::EResourceState::ShaderWrite));
+
+        FClusterCullingConstants Constants = {};
+        ExtractFrustumPlanes(ViewProjection, Constants.FrustumPlanes);
+        std::copy(CameraPosition, CameraPosition + 3, Constants.CameraPosition);
+        Constants.MeshletNum = MeshletNum;
+        Constants.LodErrorScale = LodErrorScale;
+
+        CmdList->BindComputePipeline(Pipeline);
+        CmdList->BindStorageBuffer(0, MeshletBuffer);
+        CmdList->BindStorageBuffer(1, DrawBuffer);
+        CmdList->BindStorageBuffer(2, CountBuffer);
+        CmdList->PushConstants(&Constants, sizeof(Constants));
+        CmdList->Dispatch((MeshletNum + CLUSTER_CULLING_GROUP_SIZE - 1) / CLUSTER_CULLING_GROUP_SIZE);
+
+        CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+            .SetBuffer(DrawBuffer)
+            .SetSrcState(RHI::EResourceState::ShaderWrite)
+            .SetDestState(RHI::EResourceState::IndirectArgument));
+        CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+            .SetBuffer(CountBuffer)
+            .SetSrcState(RHI::EResourceState::ShaderWrite)
+            .SetDestState(RHI::EResourceState::IndirectArgument));
+    }
+
+    void FClusterCuller::Draw(RHI::ICmdList* CmdList, RHI::FGeometryBuffer& GeometryBuffer)
+    {
+        GeometryBuffer.Bind(CmdList);
+        CmdList->DrawIndexedIndirectCount(DrawBuffer, 0, CountBuffer, 0, MeshletNum);
+    }
+
+    void FClusterCuller::CopyDraws(RHI::ICmdList* CmdList, RHI::IBuffer* Dest)
+    {
+        assert(Dest->GetDesc().Size >= GetDrawReadbackSize());
+        for (RHI::IBuffer* Buffer : { CountBuffer.GetPtr(), DrawBuffer.GetPtr() })
+        {
+            CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+                .SetBuffer(Buffer)
+                .SetSrcState(RHI::EResourceState::IndirectArgument)
+                .SetDestState(RHI::EResourceState::TransferSrc));
+        }
+
+        CmdList->CopyBuffer(Dest, CountBuffer, RHI::FCopyBufferDesc().SetSize(sizeof(uint32_t)));
+        if (MeshletNum > 0)
+        {
+            CmdList->CopyBuffer(Dest, DrawBuffer, RHI::FCopyBufferDesc()
+                .SetDestOffset(sizeof(uint32_t))
+                .SetSize(GetDrawReadbackSize() - sizeof(uint32_t)));
+        }
+
+        CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+            .SetBuffer(Dest)
+            .SetSrcState(RHI::EResourceState::TransferDest)
+            .SetDestState(RHI::EResourceState::HostRead));
+        for (RHI::IBuffer* Buffer : { CountBuffer.GetPtr(), DrawBuffer.GetPtr() })
+        {
+            CmdList->ResourceBarrier(RHI::FBufferBarrierDesc()
+                .SetBuffer(Buffer)
+                .SetSrcState(RHI::EResourceState::TransferSrc)
+                .SetDestState(RHI::EResourceState::IndirectArgument));
+        }
+    }
+}
@@ -0,0 +1,365 @@
+#include "Mesh/MeshPackage.h"
+#include "MiniCore/Hash.h"
+#include <meshoptimizer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace Neko::Mesh
+{
+    static bool IsSectionValid(const FMeshSection& Section, uint64_t FileSize)
+    {
+        return Section.Offset % MESH_SECTION_ALIGNMENT == 0 && Section.Offset <= FileSize && Section.Size <= FileSize - Section.Offset;
+    }
+
+    static bool IsLodValid(const FMeshLod& Lod, const FMeshEntry& Entry)
+    {
+        return Lod.FirstIndex <= Entry.IndexNum && Lod.IndexNum <= Entry.IndexNum - Lod.FirstIndex &&
+            Lod.FirstMeshlet <= Entry.MeshletNum && Lod.MeshletNum <= Entry.MeshletNum - Lod.FirstMeshlet;
+    }
+
+    static bool IsEntryValid(const FMeshEntry& Entry, uint64_t FileSize)
+    {
+        // encoded streams only have their sizes checked once they are decoded
+        bool bEncoded = Entry.Flags & MESH_ENTRY_ENCODED;
+        if (Entry.LodNum == 0 || Entry.LodNum > MAX_MESH_LOD_COUNT)
+        {
+            return false;
+        }
+        // the meshlets of the levels follow each other, so a meshlet index maps to its level
+        uint32_t NextMeshlet = 0;
+        for (uint32_t i = 0; i < Entry.LodNum; ++i)
+        {
+            if (!IsLodValid(Entry.Lods[i], Entry) || Entry.Lods[i].FirstMeshlet != NextMeshlet)
+            {
+                return false;
+            }
+            NextMeshlet += Entry.Lods[i].MeshletNum;
+        }
+        if (NextMeshlet != Entry.MeshletNum)
+        {
+            return false;
+        }
+
+        return IsSectionValid(Entry.Name, FileSize) &&
+            IsSectionValid(Entry.Vertices, FileSize) &&
+            IsSectionValid(Entry.Indices, FileSize) &&
+            IsSectionValid(Entry.Meshlets, FileSize) &&
+            (Entry.IndexSize == 2 || Entry.IndexSize == 4) &&
+            Entry.AttributeNum <= MAX_MESH_ATTRIBUTE_COUNT &&
+            (bEncoded || Entry.Vertices.Size == (uint64_t)Entry.VertexNum * Entry.VertexStride) &&
+            (bEncoded || Entry.Indices.Size == (uint64_t)Entry.IndexNum * Entry.IndexSize) &&
+            Entry.Meshlets.Size == (uint64_t)Entry.MeshletNum * sizeof(FMeshlet);
+    }
+
+    bool FMeshPackage::Open(const std::string& Path)
+    {
+        Close();
+        if (!File.Open(Path) || File.GetSize() < sizeof(FMeshPackageHeader))
+        {
+            Close();
+            return false;
+        }
+
+        auto Data = File.GetData();
+        auto Size = File.GetSize();
+        auto PackageHeader = reinterpret_cast<const FMeshPackageHeader*>(Data);
+        bool bValidHeader = PackageHeader->Magic == MESH_PACKAGE_MAGIC &&
+            PackageHeader->Version == MESH_PACKAGE_VERSION &&
+            PackageHeader->FileSize == Size &&
+            PackageHeader->MeshTableOffset % alignof(FMeshEntry) == 0 &&
+            PackageHeader->MeshTableOffset <= Size &&
+            (Size - PackageHeader->MeshTableOffset) / sizeof(FMeshEntry) >= PackageHeader->MeshNum;
+        if (!bValidHeader)
+        {
+            Close();
+            return false;
+        }
+
+        auto PackageMeshTable = reinterpret_cast<const FMeshEntry*>(Data + PackageHeader->MeshTableOffset);
+        for (uint32_t i = 0; i < PackageHeader->MeshNum; ++i)
+        {
+            if (!IsEntryValid(PackageMeshTable[i], Size))
+            {
+                Close();
+                return false;
+            }
+        }
+
+        Header = PackageHeader;
+        MeshTable = PackageMeshTable;
+        return true;
+    }
+
+    void FMeshPackage::Close()
+    {
+        File.Close();
+        Header = nullptr;
+        MeshTable = nullptr;
+    }
+
+    uint32_t FMeshPackage::GetMeshNum() const
+    {
+        return Header ? Header->MeshNum : 0;
+    }
+
+    FMeshView FMeshPackage::GetMesh(uint32_t Index) const
+    {
+        if (Index >= GetMeshNum())
+        {
+            return {};
+        }
+
+        auto& Entry = MeshTable[Index];
+        auto Data = File.GetData();
+        FMeshView View;
+        View.Entry = &Entry;
+        View.Name = std::string_view(reinterpret_cast<const char*>(Data + Entry.Name.Offset), Entry.Name.Size);
+        View.Vertices = Data + Entry.Vertices.Offset;
+        View.Indices = Data + Entry.Indices.Offset;
+        View.Meshlets = reinterpret_cast<const FMeshlet*>(Data + Entry.Meshlets.Offset);
+        View.bEncoded = Entry.Flags & MESH_ENTRY_ENCODED;
+        return View;
+    }
+
+    FMeshView FMeshPackage::FindMesh(std::string_view Name) const
+    {
+        // the table holds a handful of meshes per package, compare hashes before touching the names
+        uint64_t NameHash = HashString(Name);
+        for (uint32_t i = 0; i < GetMeshNum(); ++i)
+        {
+            if (MeshTable[i].NameHash != NameHash)
+            {
+                continue;
+            }
+            auto View = GetMesh(i);
+            if (View.Name == Name)
+            {
+                return View;
+            }
+        }
+        return {};
+    }
+
+    float GetLodErrorScale(float ViewportHeight, float FovY, float MaxPixelError)
+    {
+        return ViewportHeight / (2.0f * std::tan(FovY * 0.5f)) / MaxPixelError;
+    }
+
+    uint32_t SelectMeshLod(const FMeshEntry& Entry, const float CameraPosition[3], float LodErrorScale)
+    {
+        // distance to the closest point of the bounds, the error can't look larger anywhere on the mesh
+        float DistanceSquared = 0.0f;
+        for (int Axis = 0; Axis < 3; ++Axis)
+        {
+            float Delta = Entry.Bounds.Center[Axis] - CameraPosition[Axis];
+            DistanceSquared += Delta * Delta;
+        }
+        float Distance = std::max(std::sqrt(DistanceSquared) - Entry.Bounds.Radius, 0.0f);
+
+        uint32_t Lod = 0;
+        while (Lod + 1 < Entry.LodNum && Entry.Lods[Lod + 1].Error * LodErrorScale <= Distance)
+        {
+            ++Lod;
+        }
+        return Lod;
+    }
+
+    void DrawMeshLod(RHI::ICmdList* CmdList, const FMeshEntry& Entry, uint32_t Lod, const RHI::FGeometryAllocation& Allocation)
+    {
+        assert(Lod < Entry.LodNum);
+        auto& MeshLod = Entry.Lods[Lod];
+        CmdList->DrawIndexed(MeshLod.IndexNum, Allocation.GetFirstIndex() + MeshLod.FirstIndex, Allocation.GetVertexOffset());
+    }
+
+    template <typename TIndex>
+    static bool AreIndicesInRange(const TIndex* Indices, uint32_t IndexNum, uint32_t VertexNum)
+    {
+        // a max over the whole range instead of an early out, the compiler vectorizes it
+        TIndex Max = 0;
+        for (uint32_t i = 0; i < IndexNum; ++i)
+        {
+            Max = std::max(Max, Indices[i]);
+        }
+        return IndexNum == 0 || Max < VertexNum;
+    }
+
+    static bool AreIndicesInRange(const uint8_t* Indices, uint32_t IndexSize, const FMeshView& Mesh)
+    {
+        auto& Entry = *Mesh.Entry;
+        for (uint32_t i = 0; i < Entry.MeshletNum; ++i)
+        {
+            auto& Meshlet = Mesh.Meshlets[i];
+            if (Meshlet.FirstIndex > Entry.IndexNum || Meshlet.IndexNum > Entry.IndexNum - Meshlet.FirstIndex)
+            {
+                return false;
+            }
+        }
+        return IndexSize == 2 ?
+            AreIndicesInRange(reinterpret_cast<const uint16_t*>(Indices), Entry.IndexNum, Entry.VertexNum) :
+            AreIndicesInRange(reinterpret_cast<const uint32_t*>(Indices), Entry.IndexNum, Entry.VertexNum);
+    }
+
+    bool WriteMesh(const FMeshView& Mesh, uint8_t* VertexDest, uint8_t* IndexDest, uint32_t IndexSize)
+    {
+        assert(Mesh.IsValid());
+        auto& Entry = *Mesh.Entry;
+        if (IndexSize < Entry.IndexSize)
+        {
+            return false;
+        }
+
+        if (Mesh.bEncoded)
+        {
+            // the index codec writes either width, so no widening pass, the destination is cached memory so it's checked there
+            return meshopt_decodeVertexBuffer(VertexDest, Entry.VertexNum, Entry.VertexStride, Mesh.Vertices, Entry.Vertices.Size) == 0 &&
+                meshopt_decodeIndexBuffer(IndexDest, Entry.IndexNum, IndexSize, Mesh.Indices, Entry.Indices.Size) == 0 &&
+                AreIndicesInRange(IndexDest, IndexSize, Mesh);
+        }
+
+        // checked at the source, the destination may be write combined
+        if (!AreIndicesInRange(Mesh.Indices, Entry.IndexSize, Mesh))
+        {
+            return false;
+        }
+        std::memcpy(VertexDest, Mesh.Vertices, Mesh.GetVertexDataSize());
+        if (IndexSize == Entry.IndexSize)
+        {
+            std::memcpy(IndexDest, Mesh.Indices, Mesh.GetIndexDataSize());
+        }
+        else
+        {
+            auto Src = reinterpret_cast<const uint16_t*>(Mesh.Indices);
+            auto Dest = reinterpret_cast<uint32_t*>(IndexDest);
+            for (uint32_t i = 0; i < Entry.IndexNum; ++i)
+            {
+                Dest[i] = Src[i];
+            }
+        }
+        return true;
+    }
+
+    RHI::FGeometryAllocation UploadMesh(const FMeshView& Mesh, RHI::IFrameScheduler* Scheduler, RHI::ICmdList* CmdList, RHI::FGeometryBuffer& GeometryBuffer)
+    {
+        assert(Mesh.IsValid());
+        if (Mesh.bEncoded)
+        {
+            // the decoders write scattered, the upload ring is write combined, go through cached memory
+            FDecodedMesh Decoded;
+            if (!DecodeMesh(Mesh, Decoded))
+            {
+                return {};
+            }
+            return UploadMesh(Decoded.GetView(), Scheduler, CmdList, GeometryBuffer);
+        }
+
+        auto& Entry = *Mesh.Entry;
+        uint32_t IndexSize = GeometryBuffer.GetIndexSize();
+        if (Entry.VertexStride != GeometryBuffer.GetDesc().VertexStride || IndexSize < Entry.IndexSize)
+        {
+            return {};
+        }
+
+        auto Allocation = GeometryBuffer.Allocate(Entry.VertexNum, Entry.IndexNum);
+        if (!Allocation.IsValid())
+        {
+            return {};
+        }
+
+        // vertices and indices share one staging allocation so the mapped sections are read exactly once
+        uint64_t VertexSize = Mesh.GetVertexDataSize();
+        uint64_t IndexOffset = (VertexSize + MESH_SECTION_ALIGNMENT - 1) & ~(uint64_t)(MESH_SECTION_ALIGNMENT - 1);
+        auto Staging = Scheduler->AllocateUpload(IndexOffset + (uint64_t)Entry.IndexNum * IndexSize, MESH_SECTION_ALIGNMENT);
+        if (!Staging.IsValid())
+        {
+            GeometryBuffer.Free(Allocation);
+            return {};
+        }
+
+        // the staging memory of a mesh that fails the index check is simply left unused until the ring wraps
+        if (!WriteMesh(Mesh, Staging.Data, Staging.Data + IndexOffset, IndexSize))
+        {
+            GeometryBuffer.Free(Allocation);
+            return {};
+        }
+        GeometryBuffer.Upload(CmdList, Staging.Buffer, Staging.Offset, Staging.Offset + IndexOffset, Allocation);
+        return Allocation;
+    }
+
+    FMeshView FDecodedMesh::GetView() const
+    {
+        FMeshView View = Source;
+        View.Vertices = Vertices.data();
+        View.Indices = Indices.data();
+        View.bEncoded = false;
+        return View;
+    }
+
+    bool DecodeMesh(const FMeshView& Mesh, FDecodedMesh& Decoded)
+    {
+        assert(Mesh.IsValid());
+        Decoded.Source = Mesh;
+        Decoded.Vertices.resize(Mesh.GetVertexDataSize());
+        Decoded.Indices.resize(Mesh.GetIndexDataSize());
+        Decoded.bValid = WriteMesh(Mesh, Decoded.Vertices.data(), Decoded.Indices.data(), Mesh.Entry->IndexSize);
+        return Decoded.bValid;
+    }
+
+    FMeshDecoder::FMeshDecoder(FJobSystem* InJobSystem)
+        : JobSystem(InJobSystem)
+    {
+    }
+
+    FMeshDecoder::~FMeshDecoder()
+    {
+        // the jobs write into the slots and count down Counter, both must outlive them
+        Flush();
+    }
+
+    void FMeshDecoder::Enqueue(const FMeshView& Mesh)
+    {
+        assert(Mesh.IsValid());
+        FSlot* Slot = nullptr;
+        {
+            std::lock_guard Lock(Mutex);
+            if (!JobSystem)
+            {
+                // at least one worker, on a single core machine Poll would otherwise wait for a Flush
+                OwnedJobSystem = std::make_unique<FJobSystem>(std::max(2u, std::thread::hardware_concurrency()) - 1);
+                JobSystem = OwnedJobSystem.get();
+            }
+            Slot = &Slots.emplace_back();
+        }
+        JobSystem->Run([Slot, Mesh]()
+        {
+            DecodeMesh(Mesh, Slot->Mesh);
+            Slot->bDone.store(true, std::memory_order_release);
+        }, &Counter);
+    }
+
+    bool FMeshDecoder::Poll(FDecodedMesh& Mesh)
+    {
+        std::lock_guard Lock(Mutex);
+        if (Slots.empty() || !Slots.front().bDone.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        Mesh = std::move(Slots.front().Mesh);
+        Slots.pop_front();
+        return true;
+    }
+
+    void FMeshDecoder::Flush()
+    {
+        FJobSystem* System = nullptr;
+        {
+            std::lock_guard Lock(Mutex);
+            System = JobSystem;
+        }
+        if (System)
+        {
+            System->Wait(Counter);
+        }
+    }
+}
@@ -1,148 +1,856 @@
 #pragma once
-#include <array>
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 namespace Neko
-{ 
-    // from nvrhi
-    // a static vector is a vector with a capacity defined at compile-time
+{
+    namespace Detail
+    {
+        // element moves shared by the vectors, trivially copyable elements are memcpy'd
+        template <typename T>
+        void UninitializedMove(T* Src, size_t Num, T* Dest)
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                if (Num)
+                {
+                    std::memcpy((void*)Dest, (const void*)Src, Num * sizeof(T));
+                }
+            }
+            else
+            {
+                std::uninitialized_move_n(Src, Num, Dest);
+            }
+        }
+
+        template <typename T>
+        void UninitializedCopy(const T* Src, size_t Num, T* Dest)
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                if (Num)
+                {
+                    std::memcpy((void*)Dest, (const void*)Src, Num * sizeof(T));
+                }
+            }
+            else
+            {
+                std::uninitialized_copy_n(Src, Num, Dest);
+            }
+        }
+    }
+
+    // a vector with a capacity defined at compile-time, interface from nvrhi.
+    // storage is left uninitialized, only the first size() elements are alive, so an empty
+    // static_vector of a large capacity costs nothing to create and elements are destroyed when removed
     template <typename T, uint32_t _max_elements>
-    struct static_vector : private std::array<T, _max_elements>
+    struct static_vector
     {
-        typedef std::array<T, _max_elements> base;
         enum
         {
             max_elements = _max_elements
         };
 
-        using typename base::const_iterator;
-        using typename base::const_pointer;
-        using typename base::const_reference;
-        using typename base::difference_type;
-        using typename base::iterator;
-        using typename base::pointer;
-        using typename base::reference;
-        using typename base::size_type;
-        using typename base::value_type;
+        typedef T value_type;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T* iterator;
+        typedef const T* const_iterator;
         // xxxnsubtil: reverse iterators not implemented
 
-        static_vector()
-            : base(), current_size(0)
+        static_vector() noexcept {}
+
+        explicit static_vector(size_t size)
         {
+            resize(size);
         }
 
-        static_vector(size_t size)
-            : base(), current_size(size)
+        static_vector(size_t size, const T& value)
         {
-            assert(size <= max_elements);
+            resize(size, value);
         }
 
-        static_vector(const static_vector &other) = default;
-
         static_vector(std::initializer_list<T> il)
-            : current_size(0)
         {
-            for (auto i : il)
-                push_back(i);
+            assert(il.size() <= max_elements);
+            Detail::UninitializedCopy(il.begin(), il.size(), data());
+            current_size = il.size();
         }
 
-        using base::at;
+        static_vector(const static_vector& other)
+        {
+            Detail::UninitializedCopy(other.data(), other.current_size, data());
+            current_size = other.current_size;
+        }
 
-        reference operator[](size_type pos)
+        static_vector(static_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
         {
-            assert(pos < current_size);
-            return base::operator[](pos);
+            Detail::UninitializedMove(other.data(), other.current_size, data());
+            current_size = other.current_size;
+            other.clear();
         }
 
-        const_reference operator[](size_type pos) const
+        static_vector& operator=(const static_vector& other)
         {
-            assert(pos < current_size);
-            return base::operator[](pos);
+            if (this != &other)
+            {
+                clear();
+                Detail::UninitializedCopy(other.data(), other.current_size, data());
+                current_size = other.current_size;
+            }
+            return *this;
+        }
+
+        static_vector& operator=(static_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            if (this != &other)
+            {
+                clear();
+                Detail::UninitializedMove(other.data(), other.current_size, data());
+                current_size = other.current_size;
+                other.clear();
+            }
+            return *this;
+        }
+
+        ~static_vector() requires std::is_trivially_destructible_v<T> = default;
+        ~static_vector()
+        {
+            clear();
+        }
+
+        reference at(size_type pos)
+        {
+            if (pos >= current_size)
+                throw std::out_of_range("static_vector::at");
+            return data()[pos];
         }
 
-        using base::front;
+        const_reference at(size_type pos) const
+        {
+            if (pos >= current_size)
+                throw std::out_of_range("static_vector::at");
+            return data()[pos];
+        }
 
-        reference back() noexcept
+        reference operator[](size_type pos)
         {
-            auto tmp = end();
-            --tmp;
-            return *tmp;
+            assert(pos < current_size);
+            return data()[pos];
         }
-        const_reference back() const noexcept
+
+        const_reference operator[](size_type pos) const
         {
-            auto tmp = cend();
-            --tmp;
-            return *tmp;
+            assert(pos < current_size);
+            return data()[pos];
         }
 
-        using base::begin;
-        using base::cbegin;
-        using base::data;
+        reference front() noexcept { assert(current_size > 0); return data()[0]; }
+        const_reference front() const noexcept { assert(current_size > 0); return data()[0]; }
+        reference back() noexcept { assert(current_size > 0); return data()[current_size - 1]; }
+        const_reference back() const noexcept { assert(current_size > 0); return data()[current_size - 1]; }
+
+        pointer data() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+        const_pointer data() const noexcept { return std::launder(reinterpret_cast<const T*>(storage)); }
 
-        iterator end() noexcept { return iterator(begin()) + current_size; }
-        const_iterator end() const noexcept { return cend(); }
-        const_iterator cend() const noexcept { return const_iterator(cbegin()) + current_size; }
+        iterator begin() noexcept { return data(); }
+        const_iterator begin() const noexcept { return data(); }
+        const_iterator cbegin() const noexcept { return data(); }
+        iterator end() noexcept { return data() + current_size; }
+        const_iterator end() const noexcept { return data() + current_size; }
+        const_iterator cend() const noexcept { return data() + current_size; }
 
         bool empty() const noexcept { return current_size == 0; }
         size_t size() const noexcept { return current_size; }
         constexpr size_t max_size() const noexcept { return max_elements; }
+        constexpr size_t capacity() const noexcept { return max_elements; }
 
-        void fill(const T &value) noexcept
+        void fill(const T& value)
         {
-            base::fill(value);
+            std::fill(begin(), end(), value);
+            std::uninitialized_fill(end(), data() + max_elements, value);
             current_size = max_elements;
         }
 
-        void swap(static_vector &other) noexcept
+        void swap(static_vector& other)
         {
-            base::swap(*this);
-            std::swap(current_size, other.current_size);
+            static_vector tmp = std::move(other);
+            other = std::move(*this);
+            *this = std::move(tmp);
         }
 
-        void push_back(const T &value) noexcept
+        void push_back(const T& value)
         {
-            assert(current_size < max_elements);
-            *(data() + current_size) = value;
-            current_size++;
+            emplace_back(value);
         }
 
-        void push_back(T &&value) noexcept
+        void push_back(T&& value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        template <typename... Args>
+        reference emplace_back(Args&&... args)
         {
             assert(current_size < max_elements);
-            *(data() + current_size) = std::move(value);
+            T* element = new (data() + current_size) T(std::forward<Args>(args)...);
             current_size++;
+            return *element;
         }
 
         void pop_back() noexcept
         {
             assert(current_size > 0);
             current_size--;
+            std::destroy_at(data() + current_size);
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            assert(pos >= begin() && pos < end());
+            iterator it = begin() + (pos - cbegin());
+            std::move(it + 1, end(), it);
+            pop_back();
+            return it;
+        }
+
+        void clear() noexcept
+        {
+            std::destroy_n(data(), current_size);
+            current_size = 0;
         }
 
-        void resize(size_type new_size) noexcept
+        void resize(size_type new_size)
         {
             assert(new_size <= max_elements);
+            if (current_size > new_size)
+                std::destroy(data() + new_size, end());
+            else
+                std::uninitialized_value_construct(end(), data() + new_size);
+            current_size = new_size;
+        }
 
+        void resize(size_type new_size, const T& value)
+        {
+            assert(new_size <= max_elements);
             if (current_size > new_size)
+                std::destroy(data() + new_size, end());
+            else
+                std::uninitialized_fill(end(), data() + new_size, value);
+            current_size = new_size;
+        }
+
+        bool operator==(const static_vector& other) const
+        {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+
+    private:
+        alignas(T) unsigned char storage[sizeof(T) * (max_elements > 0 ? max_elements : 1)];
+        size_type current_size = 0;
+    };
+
+    // a vector that keeps up to N elements inline and only goes to the heap past that,
+    // for lists that are short nearly always but have no hard upper bound
+    template <typename T, uint32_t N>
+    class small_vector
+    {
+    public:
+        typedef T value_type;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T* iterator;
+        typedef const T* const_iterator;
+
+        static_assert(N > 0, "use std::vector without inline elements");
+
+        small_vector() noexcept : elements(inline_data()) {}
+
+        explicit small_vector(size_t size) : small_vector()
+        {
+            resize(size);
+        }
+
+        small_vector(std::initializer_list<T> il) : small_vector()
+        {
+            reserve(il.size());
+            Detail::UninitializedCopy(il.begin(), il.size(), elements);
+            current_size = il.size();
+        }
+
+        small_vector(const small_vector& other) : small_vector()
+        {
+            reserve(other.current_size);
+            Detail::UninitializedCopy(other.elements, other.current_size, elements);
+            current_size = other.current_size;
+        }
+
+        small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) : small_vector()
+        {
+            steal(other);
+        }
+
+        small_vector& operator=(const small_vector& other)
+        {
+            if (this != &other)
             {
-                for (size_type i = new_size; i < current_size; i++)
-                    (data() + i)->~T();
+                clear();
+                reserve(other.current_size);
+                Detail::UninitializedCopy(other.elements, other.current_size, elements);
+                current_size = other.current_size;
             }
-            else
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            if (this != &other)
             {
-                for (size_type i = current_size; i < new_size; i++)
-                    new (data() + i) T();
+                clear();
+                free_heap();
+                steal(other);
             }
+            return *this;
+        }
+
+        ~small_vector()
+        {
+            clear();
+            free_heap();
+        }
+
+        reference operator[](size_type pos)
+        {
+            assert(pos < current_size);
+            return elements[pos];
+        }
 
+        const_reference operator[](size_type pos) const
+        {
+            assert(pos < current_size);
+            return elements[pos];
+        }
+
+        reference front() noexcept { assert(current_size > 0); return elements[0]; }
+        const_reference front() const noexcept { assert(current_size > 0); return elements[0]; }
+        reference back() noexcept { assert(current_size > 0); return elements[current_size - 1]; }
+        const_reference back() const noexcept { assert(current_size > 0); return elements[current_size - 1]; }
+
+        pointer data() noexcept { return elements; }
+        const_pointer data() const noexcept { return elements; }
+
+        iterator begin() noexcept { return elements; }
+        const_iterator begin() const noexcept { return elements; }
+        const_iterator cbegin() const noexcept { return elements; }
+        iterator end() noexcept { return elements + current_size; }
+        const_iterator end() const noexcept { return elements + current_size; }
+        const_iterator cend() const noexcept { return elements + current_size; }
+
+        bool empty() const noexcept { return current_size == 0; }
+        size_t size() const noexcept { return current_size; }
+        size_t capacity() const noexcept { return current_capacity; }
+        // true while the elements live in the inline storage
+        bool is_inline() const noexcept { return elements == inline_data(); }
+
+        void reserve(size_type new_capacity)
+        {
+            if (new_capacity <= current_capacity)
+                return;
+            T* new_elements = static_cast<T*>(::operator new(new_capacity * sizeof(T), std::align_val_t(alignof(T))));
+            Detail::UninitializedMove(elements, current_size, new_elements);
+            std::destroy_n(elements, current_size);
+            free_heap();
+            elements = new_elements;
+            current_capacity = new_capacity;
+        }
+
+        void push_back(const T& value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        template <typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            if (current_size == current_capacity)
+            {
+                // the argument may alias an element, so it is constructed before the elements move
+                T value(std::forward<Args>(args)...);
+                reserve(current_capacity * 2);
+                return *new (elements + current_size++) T(std::move(value));
+            }
+            return *new (elements + current_size++) T(std::forward<Args>(args)...);
+        }
+
+        void pop_back() noexcept
+        {
+            assert(current_size > 0);
+            current_size--;
+            std::destroy_at(elements + current_size);
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            assert(pos >= begin() && pos < end());
+            iterator it = begin() + (pos - cbegin());
+            std::move(it + 1, end(), it);
+            pop_back();
+            return it;
+        }
+
+        void clear() noexcept
+        {
+            std::destroy_n(elements, current_size);
+            current_size = 0;
+        }
+
+        void resize(size_type new_size)
+        {
+            reserve(new_size);
+            if (current_size > new_size)
+                std::destroy(elements + new_size, end());
+            else
+                std::uninitialized_value_construct(end(), elements + new_size);
             current_size = new_size;
         }
 
-        reference emplace_back() noexcept
+        bool operator==(const small_vector& other) const
         {
-            resize(current_size + 1);
-            return back();
+            return std::equal(begin(), end(), other.begin(), other.end());
         }
 
     private:
+        T* inline_data() noexcept { return std::launder(reinterpret_cast<T*>(inline_storage)); }
+        const T* inline_data() const noexcept { return std::launder(reinterpret_cast<const T*>(inline_storage)); }
+
+        void free_heap() noexcept
+        {
+            if (!is_inline())
+            {
+                ::operator delete(elements, std::align_val_t(alignof(T)));
+                elements = inline_data();
+                current_capacity = N;
+            }
+        }
+
+        // expects this to be empty and inline, other is left empty
+        void steal(small_vector& other)
+        {
+            if (other.is_inline())
+            {
+                Detail::UninitializedMove(other.elements, other.current_size, elements);
+                current_size = other.current_size;
+                other.clear();
+            }
+            else
+            {
+                elements = std::exchange(other.elements, other.inline_data());
+                current_size = std::exchange(other.current_size, 0);
+                current_capacity = std::exchange(other.current_capacity, N);
+            }
+        }
+
+        T* elements;
         size_type current_size = 0;
+        size_type current_capacity = N;
+        alignas(T) unsigned char inline_storage[sizeof(T) * N];
+    };
+
+    // open addressing hash map with linear probing over one flat slot array, no node per element.
+    // a control byte per slot keeps 7 bits of the hash, so probing compares keys only on a likely match.
+    // erase leaves a tombstone, inserts reuse them and a rehash drops them.
+    // pointers and iterators are invalidated by any insert that grows the table
+    template <typename K, typename V, typename THash = std::hash<K>, typename TEqual = std::equal_to<K>>
+    class flat_hash_map
+    {
+    public:
+        typedef K key_type;
+        typedef V mapped_type;
+        typedef std::pair<const K, V> value_type;
+        typedef size_t size_type;
+
+        template <bool bConst>
+        class basic_iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef std::pair<const K, V> value_type;
+            typedef ptrdiff_t difference_type;
+            typedef std::conditional_t<bConst, const value_type*, value_type*> pointer;
+            typedef std::conditional_t<bConst, const value_type&, value_type&> reference;
+
+            basic_iterator() = default;
+            // a const iterator from a mutable one
+            template <bool bOtherConst, typename = std::enable_if_t<bConst && !bOtherConst>>
+            basic_iterator(const basic_iterator<bOtherConst>& other) : map(other.map), index(other.index) {}
+
+            reference operator*() const { return map->slots[index]; }
+            pointer operator->() const { return &map->slots[index]; }
+
+            basic_iterator& operator++()
+            {
+                index = map->next_full(index + 1);
+                return *this;
+            }
+
+            basic_iterator operator++(int)
+            {
+                basic_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            bool operator==(const basic_iterator& other) const { return index == other.index; }
+            bool operator!=(const basic_iterator& other) const { return index != other.index; }
+
+        private:
+            friend class flat_hash_map;
+            template <bool>
+            friend class basic_iterator;
+            typedef std::conditional_t<bConst, const flat_hash_map*, flat_hash_map*> map_pointer;
+
+            basic_iterator(map_pointer in_map, size_t in_index) : map(in_map), index(in_index) {}
+
+            map_pointer map = nullptr;
+            size_t index = 0;
+        };
+        typedef basic_iterator<false> iterator;
+        typedef basic_iterator<true> const_iterator;
+
+        flat_hash_map() = default;
+
+        flat_hash_map(std::initializer_list<value_type> il)
+        {
+            reserve(il.size());
+            for (auto& value : il)
+                try_emplace(value.first, value.second);
+        }
+
+        flat_hash_map(const flat_hash_map& other)
+        {
+            reserve(other.current_size);
+            for (auto& value : other)
+                try_emplace(value.first, value.second);
+        }
+
+        flat_hash_map(flat_hash_map&& other) noexcept
+        {
+            steal(other);
+        }
+
+        flat_hash_map& operator=(const flat_hash_map& other)
+        {
+            if (this != &other)
+            {
+                clear();
+                reserve(other.current_size);
+                for (auto& value : other)
+                    try_emplace(value.first, value.second);
+            }
+            return *this;
+        }
+
+        flat_hash_map& operator=(flat_hash_map&& other) noexcept
+        {
+            if (this != &other)
+            {
+                destroy();
+                steal(other);
+            }
+            return *this;
+        }
+
+        ~flat_hash_map()
+        {
+            destroy();
+        }
+
+        iterator begin() noexcept { return iterator(this, next_full(0)); }
+        const_iterator begin() const noexcept { return const_iterator(this, next_full(0)); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return iterator(this, slot_count); }
+        const_iterator end() const noexcept { return const_iterator(this, slot_count); }
+        const_iterator cend() const noexcept { return end(); }
+
+        bool empty() const noexcept { return current_size == 0; }
+        size_t size() const noexcept { return current_size; }
+        size_t bucket_count() const noexcept { return slot_count; }
+
+        iterator find(const K& key)
+        {
+            return iterator(this, find_index(key));
+        }
+
+        const_iterator find(const K& key) const
+        {
+            return const_iterator(this, find_index(key));
+        }
+
+        bool contains(const K& key) const { return find_index(key) != slot_count; }
+        size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+        V& at(const K& key)
+        {
+            size_t index = find_index(key);
+            if (index == slot_count)
+                throw std::out_of_range("flat_hash_map::at");
+            return slots[index].second;
+        }
+
+        const V& at(const K& key) const
+        {
+            size_t index = find_index(key);
+            if (index == slot_count)
+                throw std::out_of_range("flat_hash_map::at");
+            return slots[index].second;
+        }
+
+        V& operator[](const K& key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        V& operator[](K&& key)
+        {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        // the value is only constructed from args if the key is new
+        template <typename KeyArg, typename... Args>
+        std::pair<iterator, bool> try_emplace(KeyArg&& key, Args&&... args)
+        {
+            size_t hash = hash_key(key);
+            size_t index = find_index(key, hash);
+            if (index != slot_count)
+                return { iterator(this, index), false };
+
+            if ((current_size + tombstone_count + 1) * MAX_LOAD_DEN > slot_count * MAX_LOAD_NUM)
+            {
+                // mostly tombstones, dropping them at the same size is enough
+                bool grow = (current_size + 1) * MAX_LOAD_DEN * 2 > slot_count * MAX_LOAD_NUM;
+                rehash(std::max<size_t>(MIN_SLOT_COUNT, grow ? slot_count * 2 : slot_count));
+            }
+
+            index = insert_index(hash);
+            if (controls[index] == TOMBSTONE)
+                tombstone_count--;
+            new (&slots[index]) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<KeyArg>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+            controls[index] = control_byte(hash);
+            current_size++;
+            return { iterator(this, index), true };
+        }
+
+        template <typename KeyArg, typename ValueArg>
+        std::pair<iterator, bool> emplace(KeyArg&& key, ValueArg&& value)
+        {
+            return try_emplace(std::forward<KeyArg>(key), std::forward<ValueArg>(value));
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        template <typename ValueArg>
+        std::pair<iterator, bool> insert_or_assign(const K& key, ValueArg&& value)
+        {
+            auto result = try_emplace(key, std::forward<ValueArg>(value));
+            if (!result.second)
+                result.first->second = std::forward<ValueArg>(value);
+            return result;
+        }
+
+        size_t erase(const K& key)
+        {
+            size_t index = find_index(key);
+            if (index == slot_count)
+                return 0;
+            erase_index(index);
+            return 1;
+        }
+
+        // returns the iterator to the next element
+        iterator erase(const_iterator pos)
+        {
+            assert(pos.map == this && pos.index < slot_count && controls[pos.index] & FULL_BIT);
+            erase_index(pos.index);
+            return iterator(this, next_full(pos.index + 1));
+        }
+
+        void clear() noexcept
+        {
+            for (size_t i = 0; i < slot_count; ++i)
+            {
+                if (controls[i] & FULL_BIT)
+                    std::destroy_at(&slots[i]);
+            }
+            if (controls)
+                std::memset(controls, EMPTY, slot_count);
+            current_size = 0;
+            tombstone_count = 0;
+        }
+
+        // makes room for count elements without growing
+        void reserve(size_t count)
+        {
+            size_t needed = std::max<size_t>(MIN_SLOT_COUNT, count * MAX_LOAD_DEN / MAX_LOAD_NUM + 1);
+            if (needed > slot_count)
+                rehash(needed);
+        }
+
+    private:
+        static constexpr uint8_t EMPTY = 0;
+        static constexpr uint8_t TOMBSTONE = 1;
+        static constexpr uint8_t FULL_BIT = 0x80;
+        static constexpr size_t MIN_SLOT_COUNT = 16;
+        // at most 7/8 of the slots hold elements or tombstones
+        static constexpr size_t MAX_LOAD_NUM = 7;
+        static constexpr size_t MAX_LOAD_DEN = 8;
+
+        // std::hash of integers is the identity, the multiply spreads it before masking and taking 7 bits
+        size_t hash_key(const K& key) const
+        {
+            uint64_t hash = (uint64_t)THash()(key) * 0x9e3779b97f4a7c15ull;
+            return (size_t)(hash ^ (hash >> 32));
+        }
+
+        static uint8_t control_byte(size_t hash) { return FULL_BIT | (uint8_t)(hash >> 25); }
+
+        size_t find_index(const K& key) const
+        {
+            return slot_count ? find_index(key, hash_key(key)) : slot_count;
+        }
+
+        size_t find_index(const K& key, size_t hash) const
+        {
+            if (!slot_count)
+                return 0;
+            size_t mask = slot_count - 1;
+            uint8_t control = control_byte(hash);
+            for (size_t index = hash & mask;; index = (index + 1) & mask)
+            {
+                if (controls[index] == EMPTY)
+                    return slot_count;
+                if (controls[index] == control && TEqual()(slots[index].first, key))
+                    return index;
+            }
+        }
+
+        // first empty or tombstone slot of the probe sequence, the table always has an empty slot
+        size_t insert_index(size_t hash) const
+        {
+            size_t mask = slot_count - 1;
+            size_t index = hash & mask;
+            while (controls[index] & FULL_BIT)
+                index = (index + 1) & mask;
+            return index;
+        }
+
+        size_t next_full(size_t index) const
+        {
+            while (index < slot_count && !(controls[index] & FULL_BIT))
+                index++;
+            return index;
+        }
+
+        void erase_index(size_t index)
+        {
+            std::destroy_at(&slots[index]);
+            current_size--;
+            // a slot followed by an empty one ends no probe sequence, it can go back to empty
+            if (controls[(index + 1) & (slot_count - 1)] == EMPTY)
+            {
+                controls[index] = EMPTY;
+            }
+            else
+            {
+                controls[index] = TOMBSTONE;
+                tombstone_count++;
+            }
+        }
+
+        void rehash(size_t new_slot_count)
+        {
+            new_slot_count = std::bit_ceil(new_slot_count);
+            uint8_t* old_controls = controls;
+            value_type* old_slots = slots;
+            size_t old_slot_count = slot_count;
+
+            controls = static_cast<uint8_t*>(::operator new(new_slot_count));
+            std::memset(controls, EMPTY, new_slot_count);
+            slots = static_cast<value_type*>(::operator new(new_slot_count * sizeof(value_type), std::align_val_t(alignof(value_type))));
+            slot_count = new_slot_count;
+            tombstone_count = 0;
+
+            for (size_t i = 0; i < old_slot_count; ++i)
+            {
+                if (!(old_controls[i] & FULL_BIT))
+                    continue;
+                // the old slot is destroyed right after, so its key may be moved from
+                size_t hash = hash_key(old_slots[i].first);
+                size_t index = insert_index(hash);
+                new (&slots[index]) value_type(std::move(const_cast<K&>(old_slots[i].first)), std::move(old_slots[i].second));
+                controls[index] = control_byte(hash);
+                std::destroy_at(&old_slots[i]);
+            }
+            free_storage(old_controls, old_slots);
+        }
+
+        static void free_storage(uint8_t* in_controls, value_type* in_slots)
+        {
+            if (in_controls)
+            {
+                ::operator delete(in_controls);
+                ::operator delete(in_slots, std::align_val_t(alignof(value_type)));
+            }
+        }
+
+        void destroy() noexcept
+        {
+            clear();
+            free_storage(controls, slots);
+            controls = nullptr;
+            slots = nullptr;
+            slot_count = 0;
+        }
+
+        void steal(flat_hash_map& other) noexcept
+        {
+            controls = std::exchange(other.controls, nullptr);
+            slots = std::exchange(other.slots, nullptr);
+            slot_count = std::exchange(other.slot_count, 0);
+            current_size = std::exchange(other.current_size, 0);
+            tombstone_count = std::exchange(other.tombstone_count, 0);
+        }
+
+        uint8_t* controls = nullptr;
+        value_type* slots = nullptr;
+        size_t slot_count = 0;
+        size_t current_size = 0;
+        size_t tombstone_count = 0;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "MiniCore/Uncopyable.h"
+namespace Neko
+{
+    // 32 bits, the pool that made it splits them into a slot index and the generation the slot had,
+    // Tag keeps handles of different pools apart. the zero handle is never valid
+    template <typename Tag>
+    struct THandle
+    {
+        uint32_t Value = 0;
+
+        bool IsNull() const { return Value == 0; }
+
+        bool operator==(const THandle& Other) const { return Value == Other.Value; }
+        bool operator!=(const THandle& Other) const { return Value != Other.Value; }
+    };
+
+    // fixed capacity slots stored as one array per column, so a system that only needs one field of thousands
+    // of objects walks one dense array. Allocate and Free need external synchronization, the arrays never move
+    // and generations are atomic, so IsValid and reading a live slot are safe while another thread allocates or
+    // frees other slots. handles use as few index bits as the capacity needs and give the rest to the generation,
+    // which is odd while a slot is live and wraps around. freed slots are reused oldest first, so a stale handle
+    // only aliases once its slot went through half the generations
+    template <typename Tag, typename... TColumns>
+    class THandlePool : public FUncopyable
+    {
+    public:
+        using FHandle = THandle<Tag>;
+
+        static constexpr uint32_t MAX_CAPACITY = 1u << 24;
+
+        explicit THandlePool(uint32_t Capacity)
+            : IndexBits(std::max<uint32_t>(1, (uint32_t)std::bit_width(Capacity - 1)))
+            , IndexMask((1u << IndexBits) - 1)
+            , Generations(new std::atomic<uint32_t>[Capacity])
+            , Capacity(Capacity)
+            , FreeSlots(Capacity)
+            , FreeNum(Capacity)
+        {
+            assert(Capacity > 0 && Capacity <= MAX_CAPACITY);
+            for (uint32_t i = 0; i < Capacity; ++i)
+            {
+                Generations[i].store(0, std::memory_order_relaxed);
+                FreeSlots[i] = i;
+            }
+            std::apply([Capacity](auto&... Column) { (Column.resize(Capacity), ...); }, Columns);
+        }
+
+        // a null handle when the pool is full
+        FHandle Allocate(TColumns... Values)
+        {
+            if (FreeNum == 0)
+            {
+                return {};
+            }
+            uint32_t Index = FreeSlots[FreeHead];
+            FreeHead = FreeHead + 1 == Capacity ? 0 : FreeHead + 1;
+            --FreeNum;
+            SetColumns(Index, std::index_sequence_for<TColumns...>(), std::move(Values)...);
+            ++LiveNum;
+            uint32_t Generation = NextGeneration(Generations[Index].load(std::memory_order_relaxed));
+            Generations[Index].store(Generation, std::memory_order_release);
+            return MakeHandle(Index, Generation);
+        }
+
+        void Free(FHandle Handle)
+        {
+            assert(IsValid(Handle));
+            uint32_t Index = GetIndex(Handle);
+            Generations[Index].store(NextGeneration(GetGeneration(Handle)), std::memory_order_release);
+            SetColumns(Index, std::index_sequence_for<TColumns...>(), TColumns()...);
+            --LiveNum;
+            uint32_t Tail = FreeHead + FreeNum;
+            FreeSlots[Tail >= Capacity ? Tail - Capacity : Tail] = Index;
+            ++FreeNum;
+        }
+
+        bool IsValid(FHandle Handle) const
+        {
+            uint32_t Index = GetIndex(Handle);
+            uint32_t Generation = GetGeneration(Handle);
+            return Index < Capacity && (Generation & 1) && Generations[Index].load(std::memory_order_acquire) == Generation;
+        }
+
+        template <size_t Column>
+        auto& Get(FHandle Handle)
+        {
+            assert(IsValid(Handle));
+            return std::get<Column>(Columns)[GetIndex(Handle)];
+        }
+
+        template <size_t Column>
+        const auto& Get(FHandle Handle) const
+        {
+            assert(IsValid(Handle));
+            return std::get<Column>(Columns)[GetIndex(Handle)];
+        }
+
+        // calls Function with the handle of every live slot
+        template <typename TFunction>
+        void ForEach(TFunction&& Function) const
+        {
+            for (uint32_t Index = 0; Index < Capacity; ++Index)
+            {
+                uint32_t Generation = Generations[Index].load(std::memory_order_relaxed);
+                if (Generation & 1)
+                {
+                    Function(MakeHandle(Index, Generation));
+                }
+            }
+        }
+
+        uint32_t GetLiveNum() const { return LiveNum; }
+        uint32_t GetCapacity() const { return Capacity; }
+
+    private:
+        uint32_t GetIndex(FHandle Handle) const { return Handle.Value & IndexMask; }
+        uint32_t GetGeneration(FHandle Handle) const { return Handle.Value >> IndexBits; }
+        FHandle MakeHandle(uint32_t Index, uint32_t Generation) const { return { Index | (Generation << IndexBits) }; }
+        uint32_t NextGeneration(uint32_t Generation) const { return (Generation + 1) & (UINT32_MAX >> IndexBits); }
+
+        template <size_t... Column, typename... TValues>
+        void SetColumns(uint32_t Index, std::index_sequence<Column...>, TValues&&... Values)
+        {
+            ((std::get<Column>(Columns)[Index] = std::forward<TValues>(Values)), ...);
+        }
+
+        const uint32_t IndexBits;
+        const uint32_t IndexMask;
+        std::unique_ptr<std::atomic<uint32_t>[]> Generations;
+        std::tuple<std::vector<TColumns>...> Columns;
+        uint32_t Capacity;
+        // ring of free slot indices, FreeHead is the oldest
+        std::vector<uint32_t> FreeSlots;
+        uint32_t FreeHead = 0;
+        uint32_t FreeNum;
+        uint32_t LiveNum = 0;
+    };
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+namespace Neko
+{
+    // 64-bit FNV-1a, stable across runs and platforms so it can key on-disk caches
+    constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+
+    inline uint64_t HashBytes(const void* Data, size_t Size, uint64_t Seed = HASH_SEED)
+    {
+        auto Bytes = static_cast<const uint8_t*>(Data);
+        uint64_t Hash = Seed;
+        for (size_t i = 0; i < Size; ++i)
+        {
+            Hash ^= Bytes[i];
+            Hash *= 0x100000001b3ull;
+        }
+        return Hash;
+    }
+
+    inline uint64_t HashString(std::string_view String, uint64_t Seed = HASH_SEED)
+    {
+        // the length keeps ("ab", "c") and ("a", "bc") apart when strings are chained
+        uint64_t Size = String.size();
+        return HashBytes(String.data(), String.size(), HashBytes(&Size, sizeof(Size), Seed));
+    }
+
+    template <typename T>
+    inline uint64_t HashValue(const T& Value, uint64_t Seed = HASH_SEED)
+    {
+        return HashBytes(&Value, sizeof(T), Seed);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MiniCore/Uncopyable.h"
+namespace Neko
+{
+    struct FJob;
+
+    // counts unfinished jobs, jobs started with RunAfter on it are queued once it drops to zero,
+    // must outlive every job it counts
+    class FJobCounter : public FUncopyable
+    {
+    public:
+        bool IsDone() const { return Value.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class FJobSystem;
+
+        std::atomic<uint32_t> Value = 0;
+        std::mutex Mutex;
+        std::vector<FJob*> Continuations;
+    };
+
+    // one worker per core, each with a work-stealing deque, idle workers steal from the others,
+    // the thread that creates the system owns a deque too and runs jobs whenever it waits
+    class FJobSystem : public FUncopyable
+    {
+    public:
+        using FFunction = std::function<void()>;
+        using FRangeFunction = std::function<void(uint32_t Begin, uint32_t End)>;
+
+        // 0 spawns a worker for every hardware thread but the calling one
+        explicit FJobSystem(uint32_t WorkerNum = 0);
+        ~FJobSystem();
+
+        // Counter, if any, is incremented now and decremented once the job returned, jobs must not throw
+        void Run(FFunction Function, FJobCounter* Counter = nullptr);
+        // queues the job once Dependency reaches zero, right away if it already is
+        void RunAfter(FJobCounter& Dependency, FFunction Function, FJobCounter* Counter = nullptr);
+
+        // runs queued jobs on the calling thread until the counter reaches zero
+        void Wait(FJobCounter& Counter);
+
+        // calls Function on ranges of at most Grain items covering [0, Num) and waits for all of them,
+        // Grain 0 picks one that gives every thread a few ranges to balance uneven items
+        void ParallelFor(uint32_t Num, uint32_t Grain, const FRangeFunction& Function);
+
+        uint32_t GetWorkerNum() const { return (uint32_t)Threads.size(); }
+
+    private:
+        struct FQueue;
+
+        // the deque the calling thread owns in this system, nullptr if it has none
+        FQueue* GetOwnQueue() const;
+        void Push(FJob* Job);
+        FJob* Pop(FQueue* Own);
+        bool RunOne();
+        void Execute(FJob* Job);
+        void Finish(FJobCounter& Counter);
+        void WorkerMain(uint32_t Index);
+
+        // Queues[0] belongs to the creating thread, Queues[i + 1] to worker i
+        std::vector<std::unique_ptr<FQueue>> Queues;
+        std::vector<std::thread> Threads;
+        std::thread::id OwnerThread;
+
+        // jobs pushed from threads without a deque
+        std::mutex SharedMutex;
+        std::vector<FJob*> SharedJobs;
+
+        // sleeping workers are woken when QueuedNum goes up
+        std::atomic<uint32_t> QueuedNum = 0;
+        std::atomic<uint32_t> SleepingNum = 0;
+        std::mutex SleepMutex;
+        std::condition_variable SleepCondition;
+        std::atomic<bool> bExit = false;
+    };
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MiniCore/Uncopyable.h"
+namespace Neko
+{
+    // bump allocator over a chain of blocks, memory is given back all at once by Reset or Rewind,
+    // destructors of objects placed in it never run, so keep it to trivially destructible data
+    class FLinearArena : public FUncopyable
+    {
+    public:
+        struct FMarker
+        {
+            void* Block = nullptr;
+            size_t Offset = 0;
+        };
+
+        explicit FLinearArena(size_t BlockSize = 64 << 10);
+        ~FLinearArena();
+
+        [[nodiscard]] void* Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t));
+        // only reclaims the memory when it was the last allocation, i.e. a lifo release, anything else stays
+        // allocated until Rewind or Reset
+        void Deallocate(void* Ptr, size_t Size);
+
+        template <typename T>
+        [[nodiscard]] T* AllocateArray(size_t Num)
+        {
+            return static_cast<T*>(Allocate(Num * sizeof(T), alignof(T)));
+        }
+
+        FMarker GetMarker() const { return { Current, Offset }; }
+        // frees everything allocated after the marker was taken, blocks are kept for reuse
+        void Rewind(const FMarker& Marker);
+        // frees everything, if the arena spilled into several blocks they are merged into one that fits the peak
+        void Reset();
+
+        size_t GetCapacity() const;
+
+    private:
+        struct FBlock
+        {
+            FBlock* Next;
+            size_t Size; // including this header
+        };
+        static constexpr size_t HEADER_SIZE = (sizeof(FBlock) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+        FBlock* AllocateBlock(size_t Size);
+        void FreeBlocks();
+
+        size_t BlockSize;
+        FBlock* First = nullptr;
+        FBlock* Current = nullptr;
+        size_t Offset = HEADER_SIZE;
+    };
+
+    // the calling thread's scratch arena, used like a stack through FScratchScope
+    FLinearArena& GetScratchArena();
+
+    // rewinds the scratch arena of the thread when it goes out of scope, scopes nest,
+    // for temporaries of a single call that would otherwise hit the heap every time
+    class FScratchScope : public FUncopyable
+    {
+    public:
+        FScratchScope() : Arena(GetScratchArena()), Marker(Arena.GetMarker()) {}
+        ~FScratchScope() { Arena.Rewind(Marker); }
+
+        FLinearArena& GetArena() { return Arena; }
+
+        template <typename T>
+        [[nodiscard]] T* AllocateArray(size_t Num)
+        {
+            return Arena.AllocateArray<T>(Num);
+        }
+
+    private:
+        FLinearArena& Arena;
+        FLinearArena::FMarker Marker;
+    };
+
+    // stl allocator over an arena, the container must not outlive the arena state it was created in
+    template <typename T>
+    class TArenaAllocator
+    {
+    public:
+        using value_type = T;
+
+        TArenaAllocator(FLinearArena& InArena) noexcept : Arena(&InArena) {}
+        TArenaAllocator(FScratchScope& Scope) noexcept : Arena(&Scope.GetArena()) {}
+        template <typename U>
+        TArenaAllocator(const TArenaAllocator<U>& Other) noexcept : Arena(Other.GetArena()) {}
+
+        T* allocate(size_t Num) { return Arena->AllocateArray<T>(Num); }
+        void deallocate(T* Ptr, size_t Num) noexcept { Arena->Deallocate(Ptr, Num * sizeof(T)); }
+
+        FLinearArena* GetArena() const { return Arena; }
+
+        template <typename U>
+        bool operator==(const TArenaAllocator<U>& Other) const { return Arena == Other.GetArena(); }
+
+    private:
+        FLinearArena* Arena;
+    };
+
+    template <typename T>
+    using TArenaVector = std::vector<T, TArenaAllocator<T>>;
+}
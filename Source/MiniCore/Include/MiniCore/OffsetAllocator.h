@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "MiniCore/Uncopyable.h"
+namespace Neko
+{
+    // from sebbbi/OffsetAllocator
+    // a TLSF style allocator that hands out ranges of an abstract [0, Size) space in O(1),
+    // the space is usually a sub-range of a gpu buffer, it never touches the memory itself
+    class FOffsetAllocator : public FUncopyable
+    {
+    public:
+        static constexpr uint32_t NO_SPACE = 0xffffffff;
+
+        struct FAllocation
+        {
+            uint32_t Offset = NO_SPACE;
+            uint32_t Metadata = NO_SPACE; // internal node index
+
+            bool IsValid() const { return Offset != NO_SPACE; }
+        };
+
+        struct FStorageReport
+        {
+            uint32_t TotalFreeSpace = 0;
+            uint32_t LargestFreeRegion = 0;
+        };
+
+        FOffsetAllocator(uint32_t Size, uint32_t MaxAllocs = 128 * 1024);
+
+        void Reset();
+
+        [[nodiscard]] FAllocation Allocate(uint32_t Size);
+        void Free(const FAllocation& Allocation);
+
+        uint32_t GetAllocationSize(const FAllocation& Allocation) const;
+        FStorageReport GetStorageReport() const;
+
+    private:
+        static constexpr uint32_t NUM_TOP_BINS = 32;
+        static constexpr uint32_t BINS_PER_LEAF = 8;
+        static constexpr uint32_t TOP_BINS_INDEX_SHIFT = 3;
+        static constexpr uint32_t LEAF_BINS_INDEX_MASK = 0x7;
+        static constexpr uint32_t NUM_LEAF_BINS = NUM_TOP_BINS * BINS_PER_LEAF;
+
+        struct FNode
+        {
+            static constexpr uint32_t UNUSED = 0xffffffff;
+
+            uint32_t DataOffset = 0;
+            uint32_t DataSize = 0;
+            uint32_t BinListPrev = UNUSED;
+            uint32_t BinListNext = UNUSED;
+            uint32_t NeighborPrev = UNUSED;
+            uint32_t NeighborNext = UNUSED;
+            bool bUsed = false;
+        };
+
+        uint32_t InsertNodeIntoBin(uint32_t Size, uint32_t DataOffset);
+        void RemoveNodeFromBin(uint32_t NodeIndex);
+
+        uint32_t Size;
+        uint32_t MaxAllocs;
+        uint32_t FreeStorage = 0;
+
+        uint32_t UsedBinsTop = 0;
+        uint8_t UsedBins[NUM_TOP_BINS] = {};
+        uint32_t BinIndices[NUM_LEAF_BINS] = {};
+
+        std::vector<FNode> Nodes;
+        std::vector<uint32_t> FreeNodes;
+        uint32_t FreeOffset = 0;
+    };
+}
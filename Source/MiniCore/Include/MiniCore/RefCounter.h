@@ -1,6 +1,7 @@
 #pragma once
 
 #include <type_traits>
+#include <utility>
 
 namespace Neko
 { 
@@ -94,10 +95,21 @@ namespace Neko
         {
             if (other.ptr != ptr)
             {
-                RefCountPtr(other).Swap(*this);
+                RefCountPtr(std::move(other)).Swap(*this);
             }
             return *this;
         }
+        template <class U> requires std::is_convertible_v<U *, T *>
+        RefCountPtr &operator=(RefCountPtr<U> &&other) noexcept
+        {
+            RefCountPtr(std::move(other)).Swap(*this);
+            return *this;
+        }
+        RefCountPtr &operator=(std::nullptr_t) noexcept
+        {
+            InternalRelease();
+            return *this;
+        }
         ~RefCountPtr() noexcept
         {
             InternalRelease();
@@ -113,7 +125,7 @@ namespace Neko
             return ptr != nullptr;
         }
 
-        operator bool() noexcept
+        operator bool() const noexcept
         {
             return IsValid();
         }
@@ -123,25 +135,40 @@ namespace Neko
         operator element_type* () const { return ptr; }
     };
 
+    // non-owning, for hot paths that use an object while some owner keeps it alive,
+    // copies never touch the reference count, ToRef takes one when the object has to be kept
     template <typename T>
-    class RefCounter : public T
+    class BorrowedPtr
     {
+    public:
+        typedef T element_type;
+
+        BorrowedPtr() noexcept = default;
+        BorrowedPtr(std::nullptr_t) noexcept {}
+        template <class U> requires std::is_convertible_v<U *, T *>
+        BorrowedPtr(U *other) noexcept : ptr(other) {}
+        template <class U> requires std::is_convertible_v<U *, T *>
+        BorrowedPtr(const RefCountPtr<U> &other) noexcept : ptr(other.GetPtr()) {}
+        // borrowing from a temporary would dangle as soon as the statement ends
+        template <class U>
+        BorrowedPtr(RefCountPtr<U> &&) = delete;
+
+        element_type *operator->() const noexcept { return ptr; }
+        bool IsValid() const noexcept { return ptr != nullptr; }
+        operator bool() const noexcept { return IsValid(); }
+        element_type *GetPtr() const { return ptr; }
+        operator element_type* () const { return ptr; }
+
+        RefCountPtr<T> ToRef() const { return RefCountPtr<T>(ptr); }
+
     private:
-        std::atomic<unsigned long> refCount = 0;
+        element_type *ptr = nullptr;
+    };
 
-    public:
-        virtual unsigned long AddRef() override
-        {
-            return ++refCount;
-        }
-        virtual unsigned long Release() override
-        {
-            auto ret = --refCount;
-            if (ret == 0)
-            {
-                delete this;
-            }
-            return ret;
-        }
+    // counting lives in the non-virtual AddRef and Release of the interface base,
+    // kept so implementations still read as RefCounter<IInterface>
+    template <typename T>
+    class RefCounter : public T
+    {
     };
 }
\ No newline at end of file
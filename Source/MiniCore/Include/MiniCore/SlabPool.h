@@ -0,0 +1,230 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <mimalloc.h>
+namespace Neko
+{
+    struct FSlabPoolStats
+    {
+        uint64_t LiveNum = 0;
+        uint64_t PeakNum = 0;
+        uint64_t SlabNum = 0;
+    };
+
+    // fixed size blocks for one type, carved from slabs of a mimalloc heap the allocating thread owns,
+    // freed blocks go to the free list of the thread that frees them, so neither path takes a lock.
+    // slabs are never returned, the pool keeps the peak number of objects around for reuse
+    template <typename T>
+    class TSlabPool
+    {
+    public:
+        static constexpr size_t BLOCK_ALIGNMENT = alignof(T) < alignof(void*) ? alignof(void*) : alignof(T);
+        static constexpr size_t BLOCK_SIZE = (sizeof(T) + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+        static constexpr size_t BLOCKS_PER_SLAB = BLOCK_SIZE >= 4096 ? 4 : 16384 / BLOCK_SIZE;
+        // a thread that frees more than it allocates, e.g. one releasing objects another created,
+        // hands its surplus back once its list grows past this
+        static constexpr size_t MAX_THREAD_FREE_NUM = BLOCKS_PER_SLAB * 4;
+
+        static void* Allocate()
+        {
+            void* Block = nullptr;
+            if (tCacheDestroyed)
+            {
+                Block = AllocateOrphan();
+            }
+            else if (auto& Cache = GetCache(); Cache.FreeList)
+            {
+                Block = Cache.FreeList;
+                Cache.FreeList = Cache.FreeList->Next;
+                --Cache.FreeNum;
+            }
+            else
+            {
+                Block = AllocateSlow(Cache);
+            }
+
+            uint64_t LiveNum = Stats.LiveNum.fetch_add(1, std::memory_order_relaxed) + 1;
+            uint64_t PeakNum = Stats.PeakNum.load(std::memory_order_relaxed);
+            while (LiveNum > PeakNum && !Stats.PeakNum.compare_exchange_weak(PeakNum, LiveNum, std::memory_order_relaxed))
+            {
+            }
+            return Block;
+        }
+
+        static void Free(void* Ptr)
+        {
+            if (!Ptr)
+            {
+                return;
+            }
+            auto Block = static_cast<FFreeBlock*>(Ptr);
+            Stats.LiveNum.fetch_sub(1, std::memory_order_relaxed);
+            if (tCacheDestroyed)
+            {
+                std::lock_guard Lock(OrphanMutex);
+                Block->Next = Orphans;
+                Orphans = Block;
+                return;
+            }
+
+            auto& Cache = GetCache();
+            Block->Next = Cache.FreeList;
+            Cache.FreeList = Block;
+            if (++Cache.FreeNum > MAX_THREAD_FREE_NUM)
+            {
+                Cache.ReleaseFreeList();
+            }
+        }
+
+        static FSlabPoolStats GetStats()
+        {
+            FSlabPoolStats Result;
+            Result.LiveNum = Stats.LiveNum.load(std::memory_order_relaxed);
+            Result.PeakNum = Stats.PeakNum.load(std::memory_order_relaxed);
+            Result.SlabNum = Stats.SlabNum.load(std::memory_order_relaxed);
+            return Result;
+        }
+
+    private:
+        struct FFreeBlock
+        {
+            FFreeBlock* Next;
+        };
+
+        struct FThreadCache
+        {
+            mi_heap_t* Heap = nullptr;
+            FFreeBlock* FreeList = nullptr;
+            size_t FreeNum = 0;
+            uint8_t* SlabCursor = nullptr;
+            uint8_t* SlabEnd = nullptr;
+
+            // moves the free list to the orphans, whichever thread runs dry next adopts them
+            void ReleaseFreeList()
+            {
+                if (!FreeList)
+                {
+                    return;
+                }
+                auto Last = FreeList;
+                while (Last->Next)
+                {
+                    Last = Last->Next;
+                }
+                std::lock_guard Lock(OrphanMutex);
+                Last->Next = Orphans;
+                Orphans = FreeList;
+                FreeList = nullptr;
+                FreeNum = 0;
+            }
+
+            ~FThreadCache()
+            {
+                while (SlabCursor != SlabEnd)
+                {
+                    auto Block = reinterpret_cast<FFreeBlock*>(SlabCursor);
+                    Block->Next = FreeList;
+                    FreeList = Block;
+                    SlabCursor += BLOCK_SIZE;
+                }
+                ReleaseFreeList();
+                tCacheDestroyed = true;
+                // the heap isn't deleted, that would free the slabs, mimalloc lets other threads adopt it
+            }
+        };
+
+        struct FStats
+        {
+            std::atomic<uint64_t> LiveNum = 0;
+            std::atomic<uint64_t> PeakNum = 0;
+            std::atomic<uint64_t> SlabNum = 0;
+        };
+
+        static FThreadCache& GetCache()
+        {
+            static thread_local FThreadCache Cache;
+            return Cache;
+        }
+
+        static void* AllocateSlow(FThreadCache& Cache)
+        {
+            if (Cache.SlabCursor == Cache.SlabEnd)
+            {
+                {
+                    std::lock_guard Lock(OrphanMutex);
+                    if (Orphans)
+                    {
+                        // the count is only a trigger for handing blocks back, it doesn't need to be exact
+                        Cache.FreeList = Orphans->Next;
+                        Cache.FreeNum = 0;
+                        return std::exchange(Orphans, nullptr);
+                    }
+                }
+
+                if (!Cache.Heap)
+                {
+                    Cache.Heap = mi_heap_new();
+                }
+                auto Slab = static_cast<uint8_t*>(mi_heap_malloc_aligned(Cache.Heap, BLOCK_SIZE * BLOCKS_PER_SLAB, BLOCK_ALIGNMENT));
+                if (!Slab)
+                {
+                    throw std::bad_alloc();
+                }
+                Cache.SlabCursor = Slab;
+                Cache.SlabEnd = Slab + BLOCK_SIZE * BLOCKS_PER_SLAB;
+                Stats.SlabNum.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void* Block = Cache.SlabCursor;
+            Cache.SlabCursor += BLOCK_SIZE;
+            return Block;
+        }
+
+        // allocations while the thread exits, e.g. from destructors of other thread_locals, have no cache left
+        static void* AllocateOrphan()
+        {
+            std::lock_guard Lock(OrphanMutex);
+            if (!Orphans)
+            {
+                auto Slab = static_cast<uint8_t*>(mi_malloc_aligned(BLOCK_SIZE * BLOCKS_PER_SLAB, BLOCK_ALIGNMENT));
+                if (!Slab)
+                {
+                    throw std::bad_alloc();
+                }
+                for (size_t i = 0; i < BLOCKS_PER_SLAB; ++i)
+                {
+                    auto Block = reinterpret_cast<FFreeBlock*>(Slab + i * BLOCK_SIZE);
+                    Block->Next = Orphans;
+                    Orphans = Block;
+                }
+                Stats.SlabNum.fetch_add(1, std::memory_order_relaxed);
+            }
+            return std::exchange(Orphans, Orphans->Next);
+        }
+
+        static inline FStats Stats;
+        // set once the cache of the calling thread is destroyed, blocks then go straight through the orphans.
+        // a plain bool has no destructor, so it stays usable until the thread is gone
+        static inline thread_local bool tCacheDestroyed = false;
+        // only touched when a thread exits, runs out of blocks or frees more than it keeps
+        static inline std::mutex OrphanMutex;
+        static inline FFreeBlock* Orphans = nullptr;
+    };
+}
+
+// routes new and delete of a class through its slab pool, including RefCounter's delete this
+#define NEKO_SLAB_POOLED(T)                                     \
+    static void* operator new(size_t Size)                      \
+    {                                                           \
+        assert(Size == sizeof(T));                              \
+        return ::Neko::TSlabPool<T>::Allocate();                \
+    }                                                           \
+    static void operator delete(void* Ptr)                      \
+    {                                                           \
+        ::Neko::TSlabPool<T>::Free(Ptr);                        \
+    }
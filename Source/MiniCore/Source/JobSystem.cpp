@@ -0,0 +1,315 @@
+#include "MiniCore/JobSystem.h"
+#include <algorithm>
+#include <cassert>
+namespace Neko
+{
+    struct FJob
+    {
+        FJobSystem::FFunction Function;
+        FJobCounter* Counter;
+    };
+
+    // Chase-Lev deque after "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al.),
+    // the owner pushes and pops at the bottom, thieves take from the top, a full deque makes Push fail
+    struct FJobSystem::FQueue
+    {
+        static constexpr int64_t CAPACITY = 4096;
+        static constexpr int64_t MASK = CAPACITY - 1;
+
+        std::atomic<int64_t> Top = 0;
+        std::atomic<int64_t> Bottom = 0;
+        std::atomic<FJob*> Jobs[CAPACITY] = {};
+
+        bool Push(FJob* Job)
+        {
+            int64_t B = Bottom.load(std::memory_order_relaxed);
+            int64_t T = Top.load(std::memory_order_acquire);
+            if (B - T >= CAPACITY)
+            {
+                return false;
+            }
+            Jobs[B & MASK].store(Job, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            Bottom.store(B + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        FJob* Pop()
+        {
+            int64_t B = Bottom.load(std::memory_order_relaxed) - 1;
+            Bottom.store(B, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t T = Top.load(std::memory_order_relaxed);
+            if (T > B)
+            {
+                Bottom.store(B + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            FJob* Job = Jobs[B & MASK].load(std::memory_order_relaxed);
+            if (T == B)
+            {
+                // the last job, race the thieves for it
+                if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    Job = nullptr;
+                }
+                Bottom.store(B + 1, std::memory_order_relaxed);
+            }
+            return Job;
+        }
+
+        FJob* Steal()
+        {
+            int64_t T = Top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t B = Bottom.load(std::memory_order_acquire);
+            if (T >= B)
+            {
+                return nullptr;
+            }
+
+            FJob* Job = Jobs[T & MASK].load(std::memory_order_relaxed);
+            if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return Job;
+        }
+    };
+
+    // set on worker threads only, a worker belongs to one system for its whole life.
+    // the deque of the creating thread is found through OwnerThread, so one thread can create several systems
+    static thread_local const FJobSystem* tWorkerSystem = nullptr;
+    static thread_local uint32_t tWorkerQueue = 0;
+    static thread_local uint32_t tStealSeed = 0;
+
+    FJobSystem::FJobSystem(uint32_t WorkerNum)
+    {
+        if (WorkerNum == 0)
+        {
+            WorkerNum = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        }
+
+        for (uint32_t i = 0; i <= WorkerNum; ++i)
+        {
+            Queues.push_back(std::make_unique<FQueue>());
+        }
+        OwnerThread = std::this_thread::get_id();
+
+        for (uint32_t i = 1; i <= WorkerNum; ++i)
+        {
+            Threads.emplace_back(&FJobSystem::WorkerMain, this, i);
+        }
+    }
+
+    FJobSystem::~FJobSystem()
+    {
+        // jobs still queued run here, continuations of counters that never reach zero are dropped
+        while (RunOne())
+        {
+        }
+
+        {
+            std::lock_guard Lock(SleepMutex);
+            bExit = true;
+        }
+        SleepCondition.notify_all();
+        for (auto& Thread : Threads)
+        {
+            Thread.join();
+        }
+    }
+
+    void FJobSystem::Run(FFunction Function, FJobCounter* Counter)
+    {
+        if (Counter)
+        {
+            Counter->Value.fetch_add(1, std::memory_order_relaxed);
+        }
+        Push(new FJob{ std::move(Function), Counter });
+    }
+
+    void FJobSystem::RunAfter(FJobCounter& Dependency, FFunction Function, FJobCounter* Counter)
+    {
+        if (Counter)
+        {
+            Counter->Value.fetch_add(1, std::memory_order_relaxed);
+        }
+        auto Job = new FJob{ std::move(Function), Counter };
+        {
+            // Finish takes the continuations under the same lock, so none is left behind
+            std::lock_guard Lock(Dependency.Mutex);
+            if (Dependency.Value.load(std::memory_order_acquire) != 0)
+            {
+                Dependency.Continuations.push_back(Job);
+                return;
+            }
+        }
+        Push(Job);
+    }
+
+    void FJobSystem::Wait(FJobCounter& Counter)
+    {
+        while (!Counter.IsDone())
+        {
+            if (!RunOne())
+            {
+                std::this_thread::yield();
+            }
+        }
+        // the job that finished last may still hold the lock, the counter can't be destroyed before it lets go
+        std::lock_guard Lock(Counter.Mutex);
+    }
+
+    void FJobSystem::ParallelFor(uint32_t Num, uint32_t Grain, const FRangeFunction& Function)
+    {
+        if (Grain == 0)
+        {
+            Grain = std::max(1u, Num / ((GetWorkerNum() + 1) * 4));
+        }
+        if (Num <= Grain)
+        {
+            if (Num > 0)
+            {
+                Function(0, Num);
+            }
+            return;
+        }
+
+        // the first range stays on the calling thread, the others can be stolen meanwhile
+        FJobCounter Counter;
+        for (uint32_t Begin = Grain; Begin < Num; Begin += std::min(Grain, Num - Begin))
+        {
+            uint32_t End = Begin + std::min(Grain, Num - Begin);
+            Run([&Function, Begin, End]() { Function(Begin, End); }, &Counter);
+        }
+        Function(0, Grain);
+        Wait(Counter);
+    }
+
+    void FJobSystem::Push(FJob* Job)
+    {
+        // counted before it becomes visible, so QueuedNum never drops below the jobs actually queued
+        QueuedNum.fetch_add(1);
+        auto Own = GetOwnQueue();
+        if (!Own || !Own->Push(Job))
+        {
+            std::lock_guard Lock(SharedMutex);
+            SharedJobs.push_back(Job);
+        }
+
+        if (SleepingNum.load() > 0)
+        {
+            // a worker between its check and the wait holds the mutex, taking it here can't miss the wakeup
+            std::lock_guard Lock(SleepMutex);
+            SleepCondition.notify_one();
+        }
+    }
+
+    FJob* FJobSystem::Pop(FQueue* Own)
+    {
+        FJob* Job = Own ? Own->Pop() : nullptr;
+        if (!Job)
+        {
+            std::lock_guard Lock(SharedMutex);
+            if (!SharedJobs.empty())
+            {
+                Job = SharedJobs.back();
+                SharedJobs.pop_back();
+            }
+        }
+        if (!Job)
+        {
+            // start at a random victim so thieves spread over the deques
+            tStealSeed = tStealSeed * 1664525u + 1013904223u;
+            uint32_t QueueNum = (uint32_t)Queues.size();
+            uint32_t First = (tStealSeed >> 16) % QueueNum;
+            for (uint32_t i = 0; i < QueueNum && !Job; ++i)
+            {
+                auto Queue = Queues[(First + i) % QueueNum].get();
+                if (Queue != Own)
+                {
+                    Job = Queue->Steal();
+                }
+            }
+        }
+        if (Job)
+        {
+            QueuedNum.fetch_sub(1);
+        }
+        return Job;
+    }
+
+    FJobSystem::FQueue* FJobSystem::GetOwnQueue() const
+    {
+        if (tWorkerSystem == this)
+        {
+            return Queues[tWorkerQueue].get();
+        }
+        if (std::this_thread::get_id() == OwnerThread)
+        {
+            return Queues[0].get();
+        }
+        return nullptr;
+    }
+
+    bool FJobSystem::RunOne()
+    {
+        auto Job = Pop(GetOwnQueue());
+        if (!Job)
+        {
+            return false;
+        }
+        Execute(Job);
+        return true;
+    }
+
+    void FJobSystem::Execute(FJob* Job)
+    {
+        Job->Function();
+        auto Counter = Job->Counter;
+        delete Job;
+        if (Counter)
+        {
+            Finish(*Counter);
+        }
+    }
+
+    void FJobSystem::Finish(FJobCounter& Counter)
+    {
+        std::vector<FJob*> Ready;
+        {
+            std::lock_guard Lock(Counter.Mutex);
+            if (Counter.Value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                Ready.swap(Counter.Continuations);
+            }
+        }
+        // the counter may be gone by now, only the jobs taken from it are touched
+        for (auto Job : Ready)
+        {
+            Push(Job);
+        }
+    }
+
+    void FJobSystem::WorkerMain(uint32_t Index)
+    {
+        tWorkerSystem = this;
+        tWorkerQueue = Index;
+        tStealSeed = Index;
+
+        while (!bExit.load(std::memory_order_relaxed))
+        {
+            if (RunOne())
+            {
+                continue;
+            }
+
+            std::unique_lock Lock(SleepMutex);
+            SleepingNum.fetch_add(1);
+            SleepCondition.wait(Lock, [this]() { return QueuedNum.load() > 0 || bExit.load(); });
+            SleepingNum.fetch_sub(1);
+        }
+    }
+}
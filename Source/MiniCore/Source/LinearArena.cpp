@@ -0,0 +1,116 @@
+#include "MiniCore/LinearArena.h"
+#include <algorithm>
+#include <cassert>
+#include <new>
+namespace Neko
+{
+    FLinearArena::FLinearArena(size_t InBlockSize) : BlockSize(InBlockSize)
+    {
+    }
+
+    FLinearArena::~FLinearArena()
+    {
+        FreeBlocks();
+    }
+
+    void FLinearArena::FreeBlocks()
+    {
+        while (First)
+        {
+            auto Next = First->Next;
+            ::operator delete(First);
+            First = Next;
+        }
+        Current = nullptr;
+    }
+
+    FLinearArena::FBlock* FLinearArena::AllocateBlock(size_t Size)
+    {
+        auto Block = static_cast<FBlock*>(::operator new(Size));
+        Block->Next = nullptr;
+        Block->Size = Size;
+        return Block;
+    }
+
+    void* FLinearArena::Allocate(size_t Size, size_t Alignment)
+    {
+        assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0);
+        if (!Current)
+        {
+            First = Current = AllocateBlock(std::max(BlockSize, HEADER_SIZE + Size + Alignment));
+            Offset = HEADER_SIZE;
+        }
+
+        // block payloads start max_align_t aligned, larger alignments are padded in place
+        while (true)
+        {
+            auto Base = reinterpret_cast<uintptr_t>(Current);
+            size_t Aligned = ((Base + Offset + Alignment - 1) & ~(uintptr_t)(Alignment - 1)) - Base;
+            if (Aligned + Size <= Current->Size)
+            {
+                Offset = Aligned + Size;
+                return reinterpret_cast<uint8_t*>(Current) + Aligned;
+            }
+
+            // blocks left behind by Rewind are reused if they fit, a new one goes in front of them otherwise
+            if (!Current->Next || Current->Next->Size < HEADER_SIZE + Size + Alignment)
+            {
+                auto Block = AllocateBlock(std::max(BlockSize, HEADER_SIZE + Size + Alignment));
+                Block->Next = Current->Next;
+                Current->Next = Block;
+            }
+            Current = Current->Next;
+            Offset = HEADER_SIZE;
+        }
+    }
+
+    void FLinearArena::Deallocate(void* Ptr, size_t Size)
+    {
+        auto Begin = reinterpret_cast<uint8_t*>(Current);
+        if (Begin && static_cast<uint8_t*>(Ptr) + Size == Begin + Offset)
+        {
+            Offset = static_cast<uint8_t*>(Ptr) - Begin;
+        }
+    }
+
+    void FLinearArena::Rewind(const FMarker& Marker)
+    {
+        if (!Marker.Block)
+        {
+            // taken before the first allocation
+            Current = First;
+            Offset = HEADER_SIZE;
+            return;
+        }
+        Current = static_cast<FBlock*>(Marker.Block);
+        Offset = Marker.Offset;
+    }
+
+    void FLinearArena::Reset()
+    {
+        if (First && First->Next)
+        {
+            size_t Capacity = GetCapacity();
+            FreeBlocks();
+            First = AllocateBlock(Capacity);
+        }
+        Current = First;
+        Offset = HEADER_SIZE;
+    }
+
+    size_t FLinearArena::GetCapacity() const
+    {
+        size_t Capacity = 0;
+        for (auto Block = First; Block; Block = Block->Next)
+        {
+            Capacity += Block->Size;
+        }
+        return Capacity;
+    }
+
+    FLinearArena& GetScratchArena()
+    {
+        static thread_local FLinearArena Arena(256 << 10);
+        return Arena;
+    }
+}
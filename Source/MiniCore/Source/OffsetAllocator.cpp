@@ -0,0 +1,387 @@
+#include "MiniCore/OffsetAllocator.h"
+#include <bit>
+#include <cassert>
+namespace Neko
+{
+    namespace SmallFloat
+    {
+        // 3 bit mantissa, 5 bit exponent, bins are at most 12.5% apart
+        constexpr uint32_t MANTISSA_BITS = 3;
+        constexpr uint32_t MANTISSA_VALUE = 1 << MANTISSA_BITS;
+        constexpr uint32_t MANTISSA_MASK = MANTISSA_VALUE - 1;
+
+        // bin sizes follow floating point (exponent + mantissa) distribution (piecewise linear log approx),
+        // this ensures that for each size class, the average overhead percentage stays the same
+        static uint32_t UintToFloatRoundUp(uint32_t Size)
+        {
+            uint32_t Exp = 0;
+            uint32_t Mantissa = 0;
+
+            if (Size < MANTISSA_VALUE)
+            {
+                // denorm: 0..(MANTISSA_VALUE-1)
+                Mantissa = Size;
+            }
+            else
+            {
+                // normalized: hidden high bit always 1, not stored, just like float
+                uint32_t HighestSetBit = 31 - std::countl_zero(Size);
+                uint32_t MantissaStartBit = HighestSetBit - MANTISSA_BITS;
+                Exp = MantissaStartBit + 1;
+                Mantissa = (Size >> MantissaStartBit) & MANTISSA_MASK;
+
+                uint32_t LowBitsMask = (1 << MantissaStartBit) - 1;
+
+                // round up
+                if ((Size & LowBitsMask) != 0)
+                {
+                    Mantissa++;
+                }
+            }
+
+            return (Exp << MANTISSA_BITS) + Mantissa; // + allows mantissa->exp overflow for round up
+        }
+
+        static uint32_t UintToFloatRoundDown(uint32_t Size)
+        {
+            uint32_t Exp = 0;
+            uint32_t Mantissa = 0;
+
+            if (Size < MANTISSA_VALUE)
+            {
+                Mantissa = Size;
+            }
+            else
+            {
+                uint32_t HighestSetBit = 31 - std::countl_zero(Size);
+                uint32_t MantissaStartBit = HighestSetBit - MANTISSA_BITS;
+                Exp = MantissaStartBit + 1;
+                Mantissa = (Size >> MantissaStartBit) & MANTISSA_MASK;
+            }
+
+            return (Exp << MANTISSA_BITS) | Mantissa;
+        }
+
+        static uint32_t FloatToUint(uint32_t FloatValue)
+        {
+            uint32_t Exponent = FloatValue >> MANTISSA_BITS;
+            uint32_t Mantissa = FloatValue & MANTISSA_MASK;
+            if (Exponent == 0)
+            {
+                return Mantissa;
+            }
+            return (Mantissa | MANTISSA_VALUE) << (Exponent - 1);
+        }
+    }
+
+    static uint32_t FindLowestSetBitAfter(uint32_t BitMask, uint32_t StartBitIndex)
+    {
+        if (StartBitIndex >= 32)
+        {
+            return FOffsetAllocator::NO_SPACE;
+        }
+        uint32_t MaskBeforeStartIndex = (1u << StartBitIndex) - 1;
+        uint32_t BitsAfter = BitMask & ~MaskBeforeStartIndex;
+        if (BitsAfter == 0)
+        {
+            return FOffsetAllocator::NO_SPACE;
+        }
+        return std::countr_zero(BitsAfter);
+    }
+
+    FOffsetAllocator::FOffsetAllocator(uint32_t InSize, uint32_t InMaxAllocs) : Size(InSize), MaxAllocs(InMaxAllocs)
+    {
+        assert(MaxAllocs > 1);
+        Reset();
+    }
+
+    void FOffsetAllocator::Reset()
+    {
+        FreeStorage = 0;
+        UsedBinsTop = 0;
+        FreeOffset = MaxAllocs - 1;
+
+        for (uint32_t i = 0; i < NUM_TOP_BINS; ++i)
+        {
+            UsedBins[i] = 0;
+        }
+
+        for (uint32_t i = 0; i < NUM_LEAF_BINS; ++i)
+        {
+            BinIndices[i] = FNode::UNUSED;
+        }
+
+        Nodes.assign(MaxAllocs, FNode());
+        FreeNodes.resize(MaxAllocs);
+
+        // freelist is a stack, nodes in inverse order so that [0] pops first
+        for (uint32_t i = 0; i < MaxAllocs; ++i)
+        {
+            FreeNodes[i] = MaxAllocs - i - 1;
+        }
+
+        // start state: whole storage as one big node
+        InsertNodeIntoBin(Size, 0);
+    }
+
+    FOffsetAllocator::FAllocation FOffsetAllocator::Allocate(uint32_t AllocSize)
+    {
+        // out of nodes, the remainder of a split needs one too
+        if (FreeOffset == 0 || AllocSize == 0)
+        {
+            return {};
+        }
+
+        // round up to bin index to ensure that alloc >= bin,
+        // gives us min bin index that fits the size
+        uint32_t MinBinIndex = SmallFloat::UintToFloatRoundUp(AllocSize);
+
+        uint32_t MinTopBinIndex = MinBinIndex >> TOP_BINS_INDEX_SHIFT;
+        uint32_t MinLeafBinIndex = MinBinIndex & LEAF_BINS_INDEX_MASK;
+
+        uint32_t TopBinIndex = MinTopBinIndex;
+        uint32_t LeafBinIndex = NO_SPACE;
+
+        // if top bin exists, scan its leaf bin, this can fail
+        if (TopBinIndex < NUM_TOP_BINS && (UsedBinsTop & (1u << TopBinIndex)))
+        {
+            LeafBinIndex = FindLowestSetBitAfter(UsedBins[TopBinIndex], MinLeafBinIndex);
+        }
+
+        // if we didn't find space in top bin, we search top bin from +1
+        if (LeafBinIndex == NO_SPACE)
+        {
+            TopBinIndex = FindLowestSetBitAfter(UsedBinsTop, MinTopBinIndex + 1);
+
+            // out of space
+            if (TopBinIndex == NO_SPACE)
+            {
+                return {};
+            }
+
+            // all leaf bins here fit the alloc, since the top bin was rounded up, start leaf search from bit 0
+            LeafBinIndex = std::countr_zero((uint32_t)UsedBins[TopBinIndex]);
+        }
+
+        uint32_t BinIndex = (TopBinIndex << TOP_BINS_INDEX_SHIFT) | LeafBinIndex;
+
+        // pop the top node of the bin, bin top = node.next
+        uint32_t NodeIndex = BinIndices[BinIndex];
+        FNode& Node = Nodes[NodeIndex];
+        uint32_t NodeTotalSize = Node.DataSize;
+        Node.DataSize = AllocSize;
+        Node.bUsed = true;
+        BinIndices[BinIndex] = Node.BinListNext;
+        if (Node.BinListNext != FNode::UNUSED)
+        {
+            Nodes[Node.BinListNext].BinListPrev = FNode::UNUSED;
+        }
+        FreeStorage -= NodeTotalSize;
+
+        // bin empty?
+        if (BinIndices[BinIndex] == FNode::UNUSED)
+        {
+            UsedBins[TopBinIndex] &= ~(1u << LeafBinIndex);
+
+            // all leaf bins empty?
+            if (UsedBins[TopBinIndex] == 0)
+            {
+                UsedBinsTop &= ~(1u << TopBinIndex);
+            }
+        }
+
+        // push back reminder N elements to a lower bin
+        uint32_t ReminderSize = NodeTotalSize - AllocSize;
+        if (ReminderSize > 0)
+        {
+            uint32_t NewNodeIndex = InsertNodeIntoBin(ReminderSize, Nodes[NodeIndex].DataOffset + AllocSize);
+
+            // link nodes next to each other so that we can merge them later if both are free,
+            // and update the old next neighbor to point to the new node (in middle)
+            FNode& AllocatedNode = Nodes[NodeIndex];
+            if (AllocatedNode.NeighborNext != FNode::UNUSED)
+            {
+                Nodes[AllocatedNode.NeighborNext].NeighborPrev = NewNodeIndex;
+            }
+            Nodes[NewNodeIndex].NeighborPrev = NodeIndex;
+            Nodes[NewNodeIndex].NeighborNext = AllocatedNode.NeighborNext;
+            AllocatedNode.NeighborNext = NewNodeIndex;
+        }
+
+        return { Nodes[NodeIndex].DataOffset, NodeIndex };
+    }
+
+    void FOffsetAllocator::Free(const FAllocation& Allocation)
+    {
+        if (!Allocation.IsValid())
+        {
+            return;
+        }
+
+        uint32_t NodeIndex = Allocation.Metadata;
+        FNode& Node = Nodes[NodeIndex];
+
+        // double delete check
+        assert(Node.bUsed);
+
+        // merge with neighbors
+        uint32_t Offset = Node.DataOffset;
+        uint32_t MergedSize = Node.DataSize;
+
+        if ((Node.NeighborPrev != FNode::UNUSED) && (Nodes[Node.NeighborPrev].bUsed == false))
+        {
+            // previous (contiguous) free node: change offset to previous node offset, sum sizes
+            FNode& PrevNode = Nodes[Node.NeighborPrev];
+            Offset = PrevNode.DataOffset;
+            MergedSize += PrevNode.DataSize;
+
+            // remove node from the bin linked list and put it in the freelist
+            RemoveNodeFromBin(Node.NeighborPrev);
+
+            assert(PrevNode.NeighborNext == NodeIndex);
+            Node.NeighborPrev = PrevNode.NeighborPrev;
+        }
+
+        if ((Node.NeighborNext != FNode::UNUSED) && (Nodes[Node.NeighborNext].bUsed == false))
+        {
+            // next (contiguous) free node: offset remains the same, sum sizes
+            FNode& NextNode = Nodes[Node.NeighborNext];
+            MergedSize += NextNode.DataSize;
+
+            RemoveNodeFromBin(Node.NeighborNext);
+
+            assert(NextNode.NeighborPrev == NodeIndex);
+            Node.NeighborNext = NextNode.NeighborNext;
+        }
+
+        uint32_t NeighborNext = Node.NeighborNext;
+        uint32_t NeighborPrev = Node.NeighborPrev;
+
+        // insert the removed node to freelist
+        FreeNodes[++FreeOffset] = NodeIndex;
+
+        // insert the (combined) free node to bin
+        uint32_t CombinedNodeIndex = InsertNodeIntoBin(MergedSize, Offset);
+
+        // connect neighbors with the new combined node
+        if (NeighborNext != FNode::UNUSED)
+        {
+            Nodes[CombinedNodeIndex].NeighborNext = NeighborNext;
+            Nodes[NeighborNext].NeighborPrev = CombinedNodeIndex;
+        }
+        if (NeighborPrev != FNode::UNUSED)
+        {
+            Nodes[CombinedNodeIndex].NeighborPrev = NeighborPrev;
+            Nodes[NeighborPrev].NeighborNext = CombinedNodeIndex;
+        }
+    }
+
+    uint32_t FOffsetAllocator::InsertNodeIntoBin(uint32_t NodeSize, uint32_t DataOffset)
+    {
+        // round down to bin index to ensure that bin >= alloc
+        uint32_t BinIndex = SmallFloat::UintToFloatRoundDown(NodeSize);
+
+        uint32_t TopBinIndex = BinIndex >> TOP_BINS_INDEX_SHIFT;
+        uint32_t LeafBinIndex = BinIndex & LEAF_BINS_INDEX_MASK;
+
+        // bin was empty before?
+        if (BinIndices[BinIndex] == FNode::UNUSED)
+        {
+            // set bin mask bits
+            UsedBins[TopBinIndex] |= 1u << LeafBinIndex;
+            UsedBinsTop |= 1u << TopBinIndex;
+        }
+
+        // take a freelist node and insert on top of the bin linked list (next = old top)
+        uint32_t TopNodeIndex = BinIndices[BinIndex];
+        uint32_t NodeIndex = FreeNodes[FreeOffset--];
+
+        FNode NewNode;
+        NewNode.DataOffset = DataOffset;
+        NewNode.DataSize = NodeSize;
+        NewNode.BinListNext = TopNodeIndex;
+        Nodes[NodeIndex] = NewNode;
+
+        if (TopNodeIndex != FNode::UNUSED)
+        {
+            Nodes[TopNodeIndex].BinListPrev = NodeIndex;
+        }
+        BinIndices[BinIndex] = NodeIndex;
+
+        FreeStorage += NodeSize;
+        return NodeIndex;
+    }
+
+    void FOffsetAllocator::RemoveNodeFromBin(uint32_t NodeIndex)
+    {
+        FNode& Node = Nodes[NodeIndex];
+
+        if (Node.BinListPrev != FNode::UNUSED)
+        {
+            // easy case: we have previous node, just remove this node from the middle of the list
+            Nodes[Node.BinListPrev].BinListNext = Node.BinListNext;
+            if (Node.BinListNext != FNode::UNUSED)
+            {
+                Nodes[Node.BinListNext].BinListPrev = Node.BinListPrev;
+            }
+        }
+        else
+        {
+            // hard case: we are the first node in a bin, find the bin
+            uint32_t BinIndex = SmallFloat::UintToFloatRoundDown(Node.DataSize);
+
+            uint32_t TopBinIndex = BinIndex >> TOP_BINS_INDEX_SHIFT;
+            uint32_t LeafBinIndex = BinIndex & LEAF_BINS_INDEX_MASK;
+
+            BinIndices[BinIndex] = Node.BinListNext;
+            if (Node.BinListNext != FNode::UNUSED)
+            {
+                Nodes[Node.BinListNext].BinListPrev = FNode::UNUSED;
+            }
+
+            // bin empty?
+            if (BinIndices[BinIndex] == FNode::UNUSED)
+            {
+                UsedBins[TopBinIndex] &= ~(1u << LeafBinIndex);
+
+                if (UsedBins[TopBinIndex] == 0)
+                {
+                    UsedBinsTop &= ~(1u << TopBinIndex);
+                }
+            }
+        }
+
+        // insert the node to freelist
+        FreeNodes[++FreeOffset] = NodeIndex;
+
+        FreeStorage -= Node.DataSize;
+    }
+
+    uint32_t FOffsetAllocator::GetAllocationSize(const FAllocation& Allocation) const
+    {
+        if (!Allocation.IsValid())
+        {
+            return 0;
+        }
+        return Nodes[Allocation.Metadata].DataSize;
+    }
+
+    FOffsetAllocator::FStorageReport FOffsetAllocator::GetStorageReport() const
+    {
+        FStorageReport Report;
+
+        // out of allocations -> no free space either
+        if (FreeOffset > 0)
+        {
+            Report.TotalFreeSpace = FreeStorage;
+            if (UsedBinsTop)
+            {
+                uint32_t TopBinIndex = 31 - std::countl_zero(UsedBinsTop);
+                uint32_t LeafBinIndex = 31 - std::countl_zero((uint32_t)UsedBins[TopBinIndex]);
+                Report.LargestFreeRegion = SmallFloat::FloatToUint((TopBinIndex << TOP_BINS_INDEX_SHIFT) | LeafBinIndex);
+                assert(FreeStorage >= Report.LargestFreeRegion);
+            }
+        }
+        return Report;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "MiniCore/Uncopyable.h"
+namespace Neko::OS
+{
+    // read-only view of a whole file through the os page cache,
+    // nothing is read until a page is touched
+    class FMappedFile : public FUncopyable
+    {
+    public:
+
+        FMappedFile() = default;
+
+        ~FMappedFile();
+
+        bool Open(const std::string& Path);
+
+        void Close();
+
+        bool IsOpen() const { return Data != nullptr; }
+
+        const uint8_t* GetData() const { return Data; }
+
+        uint64_t GetSize() const { return Size; }
+
+    private:
+
+        const uint8_t* Data = nullptr;
+        uint64_t Size = 0;
+#ifdef _WIN32
+        void* FileHandle = nullptr;
+        void* MappingHandle = nullptr;
+#endif
+    };
+}
@@ -0,0 +1,122 @@
+#include "OS/MappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Neko::OS
+{
+
+    FMappedFile::~FMappedFile()
+    {
+        Close();
+    }
+
+#ifdef _WIN32
+
+    bool FMappedFile::Open(const std::string& Path)
+    {
+        Close();
+
+        HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (File == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER FileSize = {};
+        if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+        {
+            CloseHandle(File);
+            return false;
+        }
+
+        HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!Mapping)
+        {
+            CloseHandle(File);
+            return false;
+        }
+
+        auto View = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!View)
+        {
+            CloseHandle(Mapping);
+            CloseHandle(File);
+            return false;
+        }
+
+        FileHandle = File;
+        MappingHandle = Mapping;
+        Data = static_cast<const uint8_t*>(View);
+        Size = (uint64_t)FileSize.QuadPart;
+        return true;
+    }
+
+    void FMappedFile::Close()
+    {
+        if (Data)
+        {
+            UnmapViewOfFile(Data);
+            CloseHandle(MappingHandle);
+            CloseHandle(FileHandle);
+        }
+        Data = nullptr;
+        Size = 0;
+        FileHandle = nullptr;
+        MappingHandle = nullptr;
+    }
+
+#else
+
+    bool FMappedFile::Open(const std::string& Path)
+    {
+        Close();
+
+        int File = open(Path.c_str(), O_RDONLY);
+        if (File < 0)
+        {
+            return false;
+        }
+
+        struct stat FileStat = {};
+        if (fstat(File, &FileStat) != 0 || FileStat.st_size == 0)
+        {
+            close(File);
+            return false;
+        }
+
+        // the mapping keeps its own reference to the file
+        void* View = mmap(nullptr, (size_t)FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+        close(File);
+        if (View == MAP_FAILED)
+        {
+            return false;
+        }
+
+        Data = static_cast<const uint8_t*>(View);
+        Size = (uint64_t)FileStat.st_size;
+        return true;
+    }
+
+    void FMappedFile::Close()
+    {
+        if (Data)
+        {
+            munmap(const_cast<uint8_t*>(Data), (size_t)Size);
+        }
+        Data = nullptr;
+        Size = 0;
+    }
+
+#endif
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "RHI/RHI.h"
+#include "MiniCore/OffsetAllocator.h"
+namespace Neko::RHI
+{
+    struct FGeometryBufferDesc
+    {
+        NEKO_PARAM_WITH_DEFAULT(uint32_t, VertexStride, 0);
+        NEKO_PARAM_WITH_DEFAULT(uint32_t, MaxVertexNum, 1 << 22);
+        NEKO_PARAM_WITH_DEFAULT(EIndexBufferType, IndexType, EIndexBufferType::BIT32);
+        NEKO_PARAM_WITH_DEFAULT(uint32_t, MaxIndexNum, 1 << 24);
+        NEKO_PARAM_WITH_DEFAULT(uint32_t, MaxMeshNum, 64 * 1024);
+    };
+
+    // ranges of one mesh inside the shared vertex and index buffer, in elements, not bytes
+    struct FGeometryAllocation
+    {
+        FOffsetAllocator::FAllocation Vertices;
+        FOffsetAllocator::FAllocation Indices;
+        uint32_t VertexNum = 0;
+        uint32_t IndexNum = 0;
+
+        bool IsValid() const { return Vertices.IsValid() && (IndexNum == 0 || Indices.IsValid()); }
+        uint32_t GetVertexOffset() const { return Vertices.Offset; }
+        uint32_t GetFirstIndex() const { return Indices.Offset; }
+    };
+
+    // one large device local vertex buffer and index buffer shared by many meshes,
+    // meshes are drawn with a base vertex, so all of them can use the same bindings
+    class FGeometryBuffer : public FUncopyable
+    {
+    private:
+        FGeometryBufferDesc Desc;
+        IBufferRef VertexBuffer;
+        IBufferRef IndexBuffer;
+        FOffsetAllocator VertexAllocator;
+        FOffsetAllocator IndexAllocator;
+    public:
+        FGeometryBuffer(IDevice* Device, const FGeometryBufferDesc& InDesc);
+
+        [[nodiscard]] FGeometryAllocation Allocate(uint32_t VertexNum, uint32_t IndexNum);
+        void Free(const FGeometryAllocation& Allocation);
+
+        uint64_t GetVertexByteOffset(const FGeometryAllocation& Allocation) const;
+        uint64_t GetIndexByteOffset(const FGeometryAllocation& Allocation) const;
+        uint32_t GetIndexSize() const { return Desc.IndexType == EIndexBufferType::BIT16 ? 2 : 4; }
+
+        // copies tightly packed vertices and indices of one mesh from a staging buffer
+        void Upload(ICmdList* CmdList, IBuffer* SrcBuffer, uint64_t SrcVertexOffset, uint64_t SrcIndexOffset, const FGeometryAllocation& Allocation);
+
+        void Bind(ICmdList* CmdList, uint32_t Binding = 0);
+        void Draw(ICmdList* CmdList, const FGeometryAllocation& Allocation);
+
+        IBuffer* GetVertexBuffer() const { return VertexBuffer; }
+        IBuffer* GetIndexBuffer() const { return IndexBuffer; }
+        const FGeometryBufferDesc& GetDesc() const { return Desc; }
+        FOffsetAllocator::FStorageReport GetVertexStorageReport() const { return VertexAllocator.GetStorageReport(); }
+        FOffsetAllocator::FStorageReport GetIndexStorageReport() const { return IndexAllocator.GetStorageReport(); }
+    };
+}
@@ -1,9 +1,15 @@
 #pragma once
+#include <cstdint>
 #include <atomic>
 #include <memory>
 #include <cassert>
+#include <array>
+#include <string>
+#include <utility>
 #include "MiniCore/RefCounter.h"
 #include "MiniCore/Container.h"
+#include "MiniCore/HandlePool.h"
+#include "MiniCore/LinearArena.h"
 #include "OS/Window.h"
 #include "Resource.h"
 namespace Neko::RHI
@@ -28,6 +34,11 @@ namespace Neko::RHI
     {                                                      \
         Param = value;                                     \
         return *this;                                      \
+    }                                                      \
+    auto &Set##Param(_rhi##Param##Type &&value)            \
+    {                                                      \
+        Param = std::move(value);                          \
+        return *this;                                      \
     }
 
 #define NEKO_PARAM_STATIC_ARRAY(ParamType, Param, Size)     \
@@ -37,6 +48,11 @@ namespace Neko::RHI
     {                                                \
         Param##Array.push_back(value);               \
         return *this;                                \
+    }                                                \
+    auto &Add##Param(_rhi##Param##Type &&value)      \
+    {                                                \
+        Param##Array.push_back(std::move(value));    \
+        return *this;                                \
     }
 
 #define NEKO_PARAM_DYNAMIC_ARRAY(ParamType, Param)     \
@@ -46,6 +62,11 @@ namespace Neko::RHI
     {                                                \
         Param##Array.push_back(value);               \
         return *this;                                \
+    }                                                \
+    auto &Add##Param(_rhi##Param##Type &&value)      \
+    {                                                \
+        Param##Array.push_back(std::move(value));    \
+        return *this;                                \
     }
 
 #define NEKO_PARAM_ARRAY_PRI_PARAM_PUB_FUNC(ParamType, Param, Size)     \
@@ -57,6 +78,11 @@ namespace Neko::RHI
     {                                                \
         Param##Array.push_back(value);               \
         return *this;                                \
+    }                                                \
+    auto &Add##Param(_rhi##Param##Type &&value)      \
+    {                                                \
+        Param##Array.push_back(std::move(value));    \
+        return *this;                                \
     }
 
     constexpr uint32_t MAX_COLOR_ATTACHMENT_COUNT = 8;
@@ -65,16 +91,89 @@ namespace Neko::RHI
     constexpr uint32_t MAX_BINDING_LAYOUT_COUNT = 5;
     constexpr uint32_t MAX_BINDINGS_PER_LAYOUT = 128;
     constexpr uint32_t MAX_SHADER_STAGE_COUNT = 2; // vs,ps
+    constexpr uint32_t MAX_MEMORY_HEAP_COUNT = 16;
+    constexpr uint32_t SWAPCHAIN_INVALID_INDEX = ~0u; // returned by AcquireNext when there is nothing to present to
     
     enum class EFormat : uint8_t
     {
         B8G8R8A8_SNORM,
         B8G8R8A8_UNORM,
+        R32_SFLOAT,
         R32G32_SFLOAT,
         R32G32B32_SFLOAT,
+        R32G32B32A32_SFLOAT,
+        R32_UINT,
+        R32G32_UINT,
+        R32G32B32_UINT,
+        R32G32B32A32_UINT,
+        R32_SINT,
+        R32G32_SINT,
+        R32G32B32_SINT,
+        R32G32B32A32_SINT,
+        // quantized vertex elements, expanded to float by the vertex fetch
+        R8G8B8A8_UNORM,
+        R8G8B8A8_SNORM,
+        R16G16_SFLOAT,
+        R16G16_SNORM,
+        R16G16B16A16_SFLOAT,
+        R16G16B16A16_UNORM,
+        D16_UNORM,
+        D32_SFLOAT,
+        D24_UNORM_S8_UINT,
+        D32_SFLOAT_S8_UINT,
         Undefined
     };
 
+    inline bool IsDepthFormat(EFormat Format)
+    {
+        return Format == EFormat::D16_UNORM || Format == EFormat::D32_SFLOAT
+            || Format == EFormat::D24_UNORM_S8_UINT || Format == EFormat::D32_SFLOAT_S8_UINT;
+    }
+
+    inline bool IsStencilFormat(EFormat Format)
+    {
+        return Format == EFormat::D24_UNORM_S8_UINT || Format == EFormat::D32_SFLOAT_S8_UINT;
+    }
+
+    // size of one texel or vertex element in bytes
+    inline uint32_t GetFormatSize(EFormat Format)
+    {
+        switch (Format)
+        {
+        case EFormat::D16_UNORM:
+            return 2;
+        case EFormat::B8G8R8A8_SNORM:
+        case EFormat::B8G8R8A8_UNORM:
+        case EFormat::R8G8B8A8_UNORM:
+        case EFormat::R8G8B8A8_SNORM:
+        case EFormat::R16G16_SFLOAT:
+        case EFormat::R16G16_SNORM:
+        case EFormat::R32_SFLOAT:
+        case EFormat::R32_UINT:
+        case EFormat::R32_SINT:
+        case EFormat::D32_SFLOAT:
+        case EFormat::D24_UNORM_S8_UINT:
+            return 4;
+        case EFormat::R32G32_SFLOAT:
+        case EFormat::R32G32_UINT:
+        case EFormat::R32G32_SINT:
+        case EFormat::R16G16B16A16_SFLOAT:
+        case EFormat::R16G16B16A16_UNORM:
+        case EFormat::D32_SFLOAT_S8_UINT:
+            return 8;
+        case EFormat::R32G32B32_SFLOAT:
+        case EFormat::R32G32B32_UINT:
+        case EFormat::R32G32B32_SINT:
+            return 12;
+        case EFormat::R32G32B32A32_SFLOAT:
+        case EFormat::R32G32B32A32_UINT:
+        case EFormat::R32G32B32A32_SINT:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
     enum class ECmdQueueType : uint8_t
     {
         Undefined = 0x0,
@@ -89,8 +188,9 @@ namespace Neko::RHI
     {
         Vertex = BIT(0),
         Pixel  = BIT(1),
+        Compute = BIT(2),
 
-        All = Vertex | Pixel,
+        All = Vertex | Pixel | Compute,
     };
     NEKO_ENUM_CLASS_FLAG_OPERATORS(EShaderStage)
 
@@ -169,17 +269,21 @@ namespace Neko::RHI
 
     enum class EResourceType : uint8_t
     {
-        UniformBuffer
+        UniformBuffer,
+        StorageBuffer
     };
 
     enum class ELoadOp : uint8_t
     {
-        Load
+        Load,
+        Clear,
+        DontCare
     };
 
     enum class EStoreOp : uint8_t
     {
-        Store
+        Store,
+        DontCare
     };
 
     enum class ESemaphoreType : uint8_t
@@ -205,7 +309,8 @@ namespace Neko::RHI
     {
         Texture  = BIT(0),
         StorageTexture = BIT(1),
-        ColorAttachment    = BIT(2)
+        ColorAttachment    = BIT(2),
+        DepthStencilAttachment = BIT(3)
     };
     NEKO_ENUM_CLASS_FLAG_OPERATORS(ETextureUsage);
 
@@ -216,9 +321,22 @@ namespace Neko::RHI
         HostAccess = BIT(2),
         TransferSrc = BIT(3),
         TransferDest = BIT(4),
+        StorageBuffer = BIT(5),
+        IndirectBuffer = BIT(6),
     };
     NEKO_ENUM_CLASS_FLAG_OPERATORS(EBufferUsage);
 
+    // used to tag allocations, so memory usage can be tracked per kind of resource
+    enum class EResourceCategory : uint8_t
+    {
+        Unknown,
+        Mesh,
+        Texture,
+        RenderTarget,
+        Upload,
+        Count
+    };
+
     enum class EIndexBufferType : uint8_t
     {
         BIT16,
@@ -230,13 +348,25 @@ namespace Neko::RHI
         Undefined    = BIT(0),
         ColorAttachment = BIT(1),
         Present      = BIT(2),
+        DepthStencilAttachment = BIT(3),
+        // buffer states
+        TransferDest = BIT(4),
+        ShaderRead   = BIT(5),
+        ShaderWrite  = BIT(6),
+        IndirectArgument = BIT(7),
+        IndexBuffer  = BIT(8),
+        VertexBuffer = BIT(9),
+        TransferSrc  = BIT(10),
+        // read by the cpu once the submission is done, e.g. a readback buffer
+        HostRead     = BIT(11),
     };
     NEKO_ENUM_CLASS_FLAG_OPERATORS(EResourceState);
 
     struct FBufferDesc
     {
-        NEKO_PARAM_WITH_DEFAULT(uint16_t, Size, 1);
+        NEKO_PARAM_WITH_DEFAULT(uint64_t, Size, 1);
         NEKO_PARAM_WITH_DEFAULT(EBufferUsage, BufferUsage, EBufferUsage::VertexBuffer);
+        NEKO_PARAM_WITH_DEFAULT(EResourceCategory, Category, EResourceCategory::Unknown);
     };
 
     class IBuffer : public IResource
@@ -246,11 +376,26 @@ namespace Neko::RHI
     };
     typedef RefCountPtr<IBuffer> IBufferRef;
 
+    // a buffer owned by the device and named by index and generation instead of a reference count,
+    // copying one is free, using one after DestroyBufferHandle is caught by the generation check
+    struct FBufferHandleTag;
+    typedef THandle<FBufferHandleTag> FBufferHandle;
+
     struct FCopyBufferDesc
     {
-        NEKO_PARAM_WITH_DEFAULT(uint32_t, SrcOffset, 0);
-        NEKO_PARAM_WITH_DEFAULT(uint32_t, DestOffset, 0);
-        NEKO_PARAM_WITH_DEFAULT(uint32_t, Size, 0);
+        NEKO_PARAM_WITH_DEFAULT(uint64_t, SrcOffset, 0);
+        NEKO_PARAM_WITH_DEFAULT(uint64_t, DestOffset, 0);
+        NEKO_PARAM_WITH_DEFAULT(uint64_t, Size, 0);
+    };
+
+    // layout of one indirect indexed draw as the gpu reads it, written by compute shaders
+    struct FDrawIndexedIndirectArgs
+    {
+        uint32_t IndexNum;
+        uint32_t InstanceNum;
+        uint32_t FirstIndex;
+        int32_t VertexOffset;
+        uint32_t FirstInstance;
     };
 
     struct FTextureDesc
@@ -263,6 +408,7 @@ namespace Neko::RHI
         NEKO_PARAM_WITH_DEFAULT(uint16_t, Depth, 1);
         NEKO_PARAM_WITH_DEFAULT(uint16_t, MipNum, 1);
         NEKO_PARAM_WITH_DEFAULT(uint16_t, ArraySize, 1);
+        NEKO_PARAM_WITH_DEFAULT(EResourceCategory, Category, EResourceCategory::Texture);
     };
 
     class ITexture : public IResource
@@ -288,8 +434,12 @@ namespace Neko::RHI
         NEKO_PARAM_WITH_DEFAULT(uint16_t, MipNum, 1);
         NEKO_PARAM_WITH_DEFAULT(uint16_t, ArrayOffset, 0);
         NEKO_PARAM_WITH_DEFAULT(uint16_t, ArraySize, 1);
+
+        bool operator==(const FTexture2DViewDesc&) const = default;
     };
 
+    // views are cached by their texture, creating the same view twice returns the same object.
+    // a view is only valid as long as its texture is alive
     class ITexture2DView : public IResource
     {
     public:
@@ -309,6 +459,18 @@ namespace Neko::RHI
         NEKO_PARAM_WITH_DEFAULT(EBlendFactor, DestAlpha, EBlendFactor::Zero);
         NEKO_PARAM_WITH_DEFAULT(EBlendOp, AlphaOp, EBlendOp::Add);
         NEKO_PARAM_WITH_DEFAULT(EColorComponent, WriteMask, EColorComponent::All);
+
+        bool operator==(const FColorAttachmentBlendSate&) const = default;
+    };
+
+    struct FClearColor
+    {
+        NEKO_PARAM_WITH_DEFAULT(float, R, 0.0f);
+        NEKO_PARAM_WITH_DEFAULT(float, G, 0.0f);
+        NEKO_PARAM_WITH_DEFAULT(float, B, 0.0f);
+        NEKO_PARAM_WITH_DEFAULT(float, A, 1.0f);
+
+        bool operator==(const FClearColor&) const = default;
     };
 
     struct FColorAttachmentDesc
@@ -319,11 +481,14 @@ namespace Neko::RHI
         NEKO_PARAM_WITH_DEFAULT(uint16_t, MipNum, 1);
         NEKO_PARAM_WITH_DEFAULT(uint16_t, ArrayOffset, 0);
         NEKO_PARAM_WITH_DEFAULT(uint16_t, ArraySize, 1);
-        NEKO_PARAM_WITH_DEFAULT(ELoadOp, LoadAction, ELoadOp::Load);
-        NEKO_PARAM_WITH_DEFAULT(EStoreOp, StoreAction, EStoreOp::Store);
+        // only read by pipelines, the attachment object ignores it
         NEKO_PARAM_WITH_DEFAULT(FColorAttachmentBlendSate, BlendState, FColorAttachmentBlendSate());
+
+        bool operator==(const FColorAttachmentDesc&) const = default;
     };
 
+    // cached by the texture like ITexture2DView, keyed on the view part of the desc only,
+    // load and store ops and clear values are given per render pass
     struct IColorAttachment : public IResource
     {
     public:
@@ -331,6 +496,26 @@ namespace Neko::RHI
     };
     typedef RefCountPtr<IColorAttachment> IColorAttachmentRef;
 
+    // stencil ops are ignored for formats without stencil
+    struct FDepthStencilAttachmentDesc
+    {
+        NEKO_PARAM_WITH_DEFAULT(ITexture*, Texture, nullptr);
+        NEKO_PARAM_WITH_DEFAULT(EFormat, Format, EFormat::D32_SFLOAT);
+        NEKO_PARAM_WITH_DEFAULT(uint16_t, MipOffset, 0);
+        NEKO_PARAM_WITH_DEFAULT(uint16_t, ArrayOffset, 0);
+        NEKO_PARAM_WITH_DEFAULT(uint16_t, ArraySize, 1);
+
+        bool operator==(const FDepthStencilAttachmentDesc&) const = default;
+    };
+
+    // cached by the texture like IColorAttachment
+    struct IDepthStencilAttachment : public IResource
+    {
+    public:
+        virtual const FDepthStencilAttachmentDesc& GetDesc() = 0;
+    };
+    typedef RefCountPtr<IDepthStencilAttachment> IDepthStencilAttachmentRef;
+
     struct FTextureTransitionDesc
     {
         NEKO_PARAM_WITH_DEFAULT(ITexture*, Texture, nullptr);
@@ -350,8 +535,15 @@ namespace Neko::RHI
     class ISemaphore : public IResource
     {
     public:
+        // value used when the semaphore is waited on or signaled by a queue submission
         virtual void SetCounter(uint64_t) = 0;
         virtual uint64_t GetCounter() = 0;
+
+        // timeline semaphores only, timeouts are in nanoseconds
+        // returns false when the timeout expired before the semaphore reached the value
+        virtual bool Wait(uint64_t Value, uint64_t Timeout = UINT64_MAX) = 0;
+        virtual void Signal(uint64_t Value) = 0;
+        virtual uint64_t GetCompletedValue() = 0;
     };
     typedef RefCountPtr<ISemaphore> ISemaphoreRef;
 
@@ -455,6 +647,10 @@ namespace Neko::RHI
         NEKO_PARAM_STATIC_ARRAY(IBindingLayoutRef, BindingLayout, MAX_BINDING_LAYOUT_COUNT);
 
         NEKO_PARAM_STATIC_ARRAY(FColorAttachmentDesc, ColorAttachmentDesc, MAX_COLOR_ATTACHMENT_COUNT);
+        // Undefined when the pipeline renders without depth
+        NEKO_PARAM_WITH_DEFAULT(EFormat, DepthStencilFormat, EFormat::Undefined);
+        // visible to the vertex and pixel shader, at most 128 bytes
+        NEKO_PARAM_WITH_DEFAULT(uint8_t, PushConstantSize, 0);
     };
 
     class IGraphicPipeline : public IResource
@@ -462,9 +658,59 @@ namespace Neko::RHI
     };
     typedef RefCountPtr<IGraphicPipeline> IGraphicPipelineRef;
 
+    // storage buffers are bound per dispatch with BindStorageBuffer, no descriptor sets are allocated
+    struct FComputePipelineDesc
+    {
+        NEKO_PARAM_WITH_DEFAULT(IShaderRef, ComputeShader, IShaderRef());
+        // bindings 0..StorageBufferNum-1 of set 0
+        NEKO_PARAM_WITH_DEFAULT(uint8_t, StorageBufferNum, 0);
+        // at most 128 bytes, the minimum every device supports
+        NEKO_PARAM_WITH_DEFAULT(uint8_t, PushConstantSize, 0);
+    };
+
+    class IComputePipeline : public IResource
+    {
+    };
+    typedef RefCountPtr<IComputePipeline> IComputePipelineRef;
+
+    struct FBufferBarrierDesc
+    {
+        NEKO_PARAM_WITH_DEFAULT(IBuffer*, Buffer, nullptr);
+        NEKO_PARAM_WITH_DEFAULT(EResourceState, SrcState, EResourceState::Undefined);
+        NEKO_PARAM_WITH_DEFAULT(EResourceState, DestState, EResourceState::Undefined);
+        NEKO_PARAM_WITH_DEFAULT(uint64_t, Offset, 0);
+        NEKO_PARAM_WITH_DEFAULT(uint64_t, Size, UINT64_MAX);
+    };
+
+    struct FRenderPassColorAttachment
+    {
+        NEKO_PARAM_WITH_DEFAULT(IColorAttachmentRef, Attachment, nullptr);
+        NEKO_PARAM_WITH_DEFAULT(ELoadOp, LoadAction, ELoadOp::Load);
+        NEKO_PARAM_WITH_DEFAULT(EStoreOp, StoreAction, EStoreOp::Store);
+        NEKO_PARAM_WITH_DEFAULT(FClearColor, ClearColor, FClearColor());
+
+        FRenderPassColorAttachment() = default;
+        FRenderPassColorAttachment(IColorAttachmentRef InAttachment) : Attachment(std::move(InAttachment)) {}
+    };
+
+    struct FRenderPassDepthStencilAttachment
+    {
+        NEKO_PARAM_WITH_DEFAULT(IDepthStencilAttachmentRef, Attachment, nullptr);
+        NEKO_PARAM_WITH_DEFAULT(ELoadOp, DepthLoadAction, ELoadOp::Clear);
+        NEKO_PARAM_WITH_DEFAULT(EStoreOp, DepthStoreAction, EStoreOp::DontCare);
+        NEKO_PARAM_WITH_DEFAULT(ELoadOp, StencilLoadAction, ELoadOp::DontCare);
+        NEKO_PARAM_WITH_DEFAULT(EStoreOp, StencilStoreAction, EStoreOp::DontCare);
+        NEKO_PARAM_WITH_DEFAULT(float, ClearDepth, 1.0f);
+        NEKO_PARAM_WITH_DEFAULT(uint8_t, ClearStencil, 0);
+
+        FRenderPassDepthStencilAttachment() = default;
+        FRenderPassDepthStencilAttachment(IDepthStencilAttachmentRef InAttachment) : Attachment(std::move(InAttachment)) {}
+    };
+
     struct FRenderPassDesc
     {
-        NEKO_PARAM_STATIC_ARRAY(IColorAttachmentRef, ColorAttachment, MAX_COLOR_ATTACHMENT_COUNT);
+        NEKO_PARAM_STATIC_ARRAY(FRenderPassColorAttachment, ColorAttachment, MAX_COLOR_ATTACHMENT_COUNT);
+        NEKO_PARAM_WITH_DEFAULT(FRenderPassDepthStencilAttachment, DepthStencilAttachment, FRenderPassDepthStencilAttachment());
     };
 
     struct FViewport
@@ -507,14 +753,33 @@ namespace Neko::RHI
        
         virtual void Draw(uint32_t VertexNum, uint32_t VertexOffset) = 0;
         virtual void DrawIndexed(uint32_t IndexCount, uint32_t FirstIndex, uint32_t VertexOffset) = 0;
+        // ArgsBuffer holds tightly packed FDrawIndexedIndirectArgs, the draw count is read from CountBuffer on the gpu,
+        // needs the DrawIndirectCount feature
+        virtual void DrawIndexedIndirectCount(IBuffer* ArgsBuffer, uint64_t ArgsOffset, IBuffer* CountBuffer, uint64_t CountOffset, uint32_t MaxDrawNum) = 0;
         virtual void BindGraphicPipeline(IGraphicPipeline*) = 0;
 
+        virtual void BindComputePipeline(IComputePipeline*) = 0;
+        // binds to the last bound compute pipeline, Size UINT64_MAX binds the rest of the buffer
+        virtual void BindStorageBuffer(uint32_t Binding, IBuffer* InBuffer, uint64_t Offset = 0, uint64_t Size = UINT64_MAX) = 0;
+        virtual void BindStorageBuffer(uint32_t Binding, FBufferHandle InBuffer, uint64_t Offset = 0, uint64_t Size = UINT64_MAX) = 0;
+        // to the last bound graphic or compute pipeline
+        virtual void PushConstants(const void* Data, uint32_t Size) = 0;
+        virtual void Dispatch(uint32_t GroupNumX, uint32_t GroupNumY = 1, uint32_t GroupNumZ = 1) = 0;
+
         virtual void ResourceBarrier(const FTextureTransitionDesc&) = 0;
         virtual void ResourceBarrier(IColorAttachment*,const EResourceState& Src, const EResourceState& Dest) = 0;
+        virtual void ResourceBarrier(IDepthStencilAttachment*, const EResourceState& Src, const EResourceState& Dest) = 0;
+        virtual void ResourceBarrier(const FBufferBarrierDesc&) = 0;
 
         virtual void CopyBuffer(IBuffer*, IBuffer*, const FCopyBufferDesc&) = 0;
+        // Offset and Size must be multiples of 4
+        virtual void FillBuffer(IBuffer*, uint64_t Offset, uint64_t Size, uint32_t Value) = 0;
         virtual void BindVertexBuffer(IBuffer* InBuffer, uint32_t Binding, uint64_t Offset) = 0;
         virtual void BindIndexBuffer(IBuffer* InBuffer, uint64_t Offset, const EIndexBufferType& Type) = 0;
+
+        virtual void CopyBuffer(FBufferHandle, FBufferHandle, const FCopyBufferDesc&) = 0;
+        virtual void BindVertexBuffer(FBufferHandle InBuffer, uint32_t Binding, uint64_t Offset) = 0;
+        virtual void BindIndexBuffer(FBufferHandle InBuffer, uint64_t Offset, const EIndexBufferType& Type) = 0;
     };
     typedef RefCountPtr<ICmdList> ICmdListRef;
 
@@ -529,10 +794,20 @@ namespace Neko::RHI
     };
     typedef RefCountPtr<ICmdPool> ICmdPoolRef;
     
+    class IQueue;
+
+    // makes a submission wait until another queue has finished the submission that returned Value
+    struct FQueueWait
+    {
+        IQueue* Queue = nullptr;
+        uint64_t Value = 0;
+    };
+
     struct FExcuteDesc
     {
         NEKO_PARAM_DYNAMIC_ARRAY(ISemaphore*,WaitSemaphore);
         NEKO_PARAM_DYNAMIC_ARRAY(ISemaphore*, SignalSemaphore);
+        NEKO_PARAM_DYNAMIC_ARRAY(FQueueWait, QueueWait);
         NEKO_PARAM_WITH_DEFAULT(IFence*, Fence, nullptr);
     };
 
@@ -542,8 +817,13 @@ namespace Neko::RHI
         [[nodiscard]] virtual ICmdPoolRef CreateCmdPool() = 0;
         [[nodiscard]] virtual std::vector<ICmdPoolRef> CreateCmdPools(uint32_t) = 0;
 
-        virtual void ExcuteCmdLists(ICmdList** CmdLists, uint32_t CmdListNum, const FExcuteDesc& Desc) = 0;
-        virtual void ExcuteCmdList(ICmdList* CmdList, const FExcuteDesc& Desc) = 0;
+        // every submission advances the queue timeline, the returned value can be waited on by other queues or the host
+        virtual uint64_t ExcuteCmdLists(ICmdList** CmdLists, uint32_t CmdListNum, const FExcuteDesc& Desc) = 0;
+        virtual uint64_t ExcuteCmdList(ICmdList* CmdList, const FExcuteDesc& Desc) = 0;
+
+        virtual ECmdQueueType GetCmdQueueType() = 0;
+        virtual uint64_t GetCompletedValue() = 0;
+        virtual void Wait(uint64_t Value) = 0;
     };
     typedef RefCountPtr<IQueue> IQueueRef;
 
@@ -554,6 +834,14 @@ namespace Neko::RHI
         NEKO_PARAM_DYNAMIC_ARRAY(ISemaphore*, WaitSemaphore);
     };
 
+    // unsupported modes fall back to the next one in the list, fifo is always available
+    enum class EPresentLatency : uint8_t
+    {
+        VSync,      // fifo
+        LowLatency, // mailbox, immediate, fifo
+        Immediate,  // immediate, mailbox, fifo
+    };
+
     struct FSwapChainDesc
     {
         OS::FWindow* WindowRawPtr = nullptr;
@@ -564,29 +852,97 @@ namespace Neko::RHI
         }
         NEKO_PARAM_WITH_DEFAULT(uint32_t, ImageCount, 3);
         NEKO_PARAM_WITH_DEFAULT(EFormat, Format, EFormat::Undefined);
-        NEKO_PARAM_WITH_DEFAULT(bool, VSync, true);
+        NEKO_PARAM_WITH_DEFAULT(EPresentLatency, PresentLatency, EPresentLatency::VSync);
     };
     
     class ISwapchain : public IResource
     {
     public:
+        // returns SWAPCHAIN_INVALID_INDEX while the window is minimized, skip the frame in that case
         virtual uint32_t AcquireNext(ISemaphore*,IFence*) = 0;
         virtual void Present(const FPresentDesc&) = 0;
+        // only records the new size, the swapchain is recreated by the next AcquireNext
+        virtual void Resize(uint32_t Width, uint32_t Height) = 0;
         virtual uint32_t GetTextureNum() = 0;
+        virtual ITextureRef GetTexture(uint32_t Index) = 0;
         virtual std::vector<ITextureRef> GetTextures() = 0;
         virtual void Reset() = 0;
     };
     typedef RefCountPtr<ISwapchain> ISwapchainRef;
 
+    struct FFrameSchedulerDesc
+    {
+        // more frames in flight trade latency for cpu/gpu overlap
+        NEKO_PARAM_WITH_DEFAULT(uint32_t, FramesInFlight, 2);
+        NEKO_PARAM_WITH_DEFAULT(IQueue*, Queue, nullptr);
+        // optional, frames acquire and present swapchain images when set
+        NEKO_PARAM_WITH_DEFAULT(ISwapchain*, Swapchain, nullptr);
+        // per frame, reset when the frame slot is reused
+        NEKO_PARAM_WITH_DEFAULT(uint64_t, UploadRingSize, 4 << 20);
+        // initial size of the per frame cpu arena, it grows to the peak use of a frame
+        NEKO_PARAM_WITH_DEFAULT(uint64_t, FrameArenaSize, 256 << 10);
+    };
+
+    struct FUploadAllocation
+    {
+        IBuffer* Buffer = nullptr;
+        uint64_t Offset = 0;
+        uint8_t* Data = nullptr;
+
+        bool IsValid() const { return Buffer != nullptr; }
+    };
+
+    class IFrameScheduler : public IResource
+    {
+    public:
+        // waits until the gpu is done with the frame that last used this slot, then recycles its resources.
+        // returns false when there is no swapchain image to render to, skip the frame in that case
+        virtual bool BeginFrame() = 0;
+        // submits the command lists and presents the acquired image
+        virtual void EndFrame(ICmdList** CmdLists, uint32_t CmdListNum) = 0;
+
+        // valid until the frame slot is reused
+        [[nodiscard]] virtual ICmdListRef CreateCmdList() = 0;
+        // host visible memory that can be copied from or bound as vertex and index data, invalid when the ring is full
+        [[nodiscard]] virtual FUploadAllocation AllocateUpload(uint64_t Size, uint64_t Alignment = 16) = 0;
+        // cpu memory that lives until the frame slot is reused, for data recorded work still reads after the call returns
+        virtual FLinearArena& GetFrameArena() = 0;
+
+        virtual uint32_t GetFramesInFlight() = 0;
+        virtual uint32_t GetFrameIndex() = 0;
+        virtual uint64_t GetFrameNumber() = 0;
+        virtual uint32_t GetSwapchainIndex() = 0;
+        virtual ITextureRef GetSwapchainTexture() = 0;
+
+        // waits for every submitted frame
+        virtual void WaitIdle() = 0;
+    };
+    typedef RefCountPtr<IFrameScheduler> IFrameSchedulerRef;
+
+    // requested features are required, devices that lack one are skipped
     struct FFeatures
     {
         NEKO_PARAM_WITH_DEFAULT(bool, Swapchain, false);
+        // compute pipelines, their storage buffers are bound with VK_KHR_push_descriptor
+        NEKO_PARAM_WITH_DEFAULT(bool, Compute, false);
+        NEKO_PARAM_WITH_DEFAULT(bool, DrawIndirectCount, false);
+    };
+
+    struct FQueueRequest
+    {
+        NEKO_PARAM_WITH_DEFAULT(ECmdQueueType, Type, ECmdQueueType::Graphic);
+        NEKO_PARAM_WITH_DEFAULT(float, Priority, 1.0f);
     };
 
     struct FDeviceDesc
     {
         NEKO_PARAM_WITH_DEFAULT(bool, Validation, false);
+        // only requested queues are created, compute and transfer requests prefer dedicated families.
+        // a single graphic queue is created when nothing is requested
+        NEKO_PARAM_DYNAMIC_ARRAY(FQueueRequest, QueueRequest);
         NEKO_PARAM_WITH_DEFAULT(FFeatures, Features, FFeatures());
+        // slots of the buffer handle pool, reserved up front, at most 1 << 24
+        NEKO_PARAM_WITH_DEFAULT(uint32_t, MaxBufferHandleNum, 65536);
 
         struct FVulkanDesc
         {
@@ -606,6 +962,48 @@ namespace Neko::RHI
     {
         const char* Name;
     };
+
+    struct FMemoryHeapStats
+    {
+        uint64_t Size = 0;
+        uint64_t Budget = 0;          // how much the os lets us use, heap size if the budget is unknown
+        uint64_t Usage = 0;           // what the whole process uses, including memory not allocated by us
+        uint64_t BlockBytes = 0;      // VkDeviceMemory allocated by us
+        uint64_t AllocationBytes = 0; // bytes handed out to resources
+        uint32_t BlockCount = 0;
+        uint32_t AllocationCount = 0;
+        float Fragmentation = 0.0f;   // 0 : all free memory is one range, -> 1 : free memory is scattered
+        bool bDeviceLocal = false;
+    };
+
+    struct FMemoryCategoryStats
+    {
+        uint64_t Bytes = 0;
+        uint32_t AllocationCount = 0;
+    };
+
+    struct FMemoryStats
+    {
+        static_vector<FMemoryHeapStats, MAX_MEMORY_HEAP_COUNT> Heaps;
+        std::array<FMemoryCategoryStats, (size_t)EResourceCategory::Count> Categories = {};
+        uint64_t BlockBytes = 0;
+        uint64_t AllocationBytes = 0;
+        uint32_t AllocationCount = 0;
+        float Fragmentation = 0.0f;
+        bool bBudgetSupported = false; // false if VK_EXT_memory_budget is missing, budget and usage are estimated
+    };
+
+    inline const char* GetResourceCategoryName(const EResourceCategory& Category)
+    {
+        switch (Category)
+        {
+        case EResourceCategory::Mesh:         return "Mesh";
+        case EResourceCategory::Texture:      return "Texture";
+        case EResourceCategory::RenderTarget: return "RenderTarget";
+        case EResourceCategory::Upload:       return "Upload";
+        default:                              return "Unknown";
+        }
+    }
     
     class IDevice : public IResource
     {
@@ -618,21 +1016,42 @@ namespace Neko::RHI
         [[nodiscard]] virtual IQueueRef CreateQueue(const ECmdQueueType& CmdQueueType = ECmdQueueType::Graphic) = 0;
         [[nodiscard]] virtual IShaderRef CreateShader(const FShaderDesc &) = 0;
         [[nodiscard]] virtual IGraphicPipelineRef CreateGraphicPipeline(const FGraphicPipelineDesc &) = 0;
+        // nullptr unless the device was created with the Compute feature
+        [[nodiscard]] virtual IComputePipelineRef CreateComputePipeline(const FComputePipelineDesc &) = 0;
         [[nodiscard]] virtual ISwapchainRef CreateSwapChain(const FSwapChainDesc&) = 0;
         [[nodiscard]] virtual ITexture2DViewRef CreateTexture2DView(const FTexture2DViewDesc&) = 0;
         [[nodiscard]] virtual ITexture2DViewRef CreateTexture2DView(ITexture*) = 0;
         [[nodiscard]] virtual IColorAttachmentRef CreateColorAttachment(const FColorAttachmentDesc&) = 0;
+        [[nodiscard]] virtual IDepthStencilAttachmentRef CreateDepthStencilAttachment(const FDepthStencilAttachmentDesc&) = 0;
+        [[nodiscard]] virtual ITextureRef CreateTexture(const FTextureDesc&) = 0;
         [[nodiscard]] virtual IBufferRef CreateBuffer(const FBufferDesc&) = 0;
 
-        [[nodiscard]] virtual uint8_t* MapBuffer(IBuffer*,uint32_t Offset, uint32_t Size) = 0;
+        [[nodiscard]] virtual uint8_t* MapBuffer(IBuffer*, uint64_t Offset, uint64_t Size) = 0;
         [[nodiscard]] virtual void UnmapBuffer(IBuffer*) = 0;
+
+        // lookups of live handles and IsBufferHandleValid take no lock, destruction is deferred like releasing the last IBufferRef.
+        // returns a null handle when the pool is full
+        [[nodiscard]] virtual FBufferHandle CreateBufferHandle(const FBufferDesc&) = 0;
+        virtual void DestroyBufferHandle(FBufferHandle) = 0;
+        virtual bool IsBufferHandleValid(FBufferHandle) = 0;
+        // HostAccess buffers stay mapped for their whole life, nullptr for the others and for a stale handle
+        virtual uint8_t* GetMappedData(FBufferHandle) = 0;
        
         [[nodiscard]] virtual IBindingLayoutRef CreateBindingLayout(const FBindingLayoutDesc &desc) = 0;
+        [[nodiscard]] virtual IFrameSchedulerRef CreateFrameScheduler(const FFrameSchedulerDesc&) = 0;
  
         virtual bool IsCmdQueueValid(const ECmdQueueType&) = 0;
 
+        // waits until all (or any) of the timeline semaphores reach their value, returns false on timeout
+        virtual bool WaitSemaphores(ISemaphore** Semaphores, const uint64_t* Values, uint32_t SemaphoreNum, bool bWaitAll = true, uint64_t Timeout = UINT64_MAX) = 0;
+
         virtual void WaitIdle() = 0;
         virtual FGPUInfo GetGPUInfo() = 0;
+        virtual FFeatures GetFeatures() = 0;
+
+        virtual FMemoryStats GetMemoryStats() = 0;
+        // json dump of every heap, memory type and allocation
+        virtual std::string BuildMemoryStatsString(bool bDetailed = true) = 0;
     };
 
     typedef RefCountPtr<IDevice> IDeviceRef;
@@ -1,6 +1,9 @@
 #pragma once
+#include <atomic>
 namespace Neko
 { 
+    // intrusive and non-virtual, the count lives in the base so RefCountPtr of any interface reaches it directly,
+    // the virtual destructor picks the right class and its operator delete
     class IResource
     {
     public:
@@ -12,7 +15,25 @@ namespace Neko
         IResource &operator=(const IResource &) = delete;
         IResource &operator=(const IResource &&) = delete;
 
-        virtual unsigned long AddRef() = 0;
-        virtual unsigned long Release() = 0;
+        // a new reference is always made from an existing one, nothing to order against
+        unsigned long AddRef()
+        {
+            return RefCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        // release publishes this thread's writes, the acquire fence makes all of them visible to the destructor
+        unsigned long Release()
+        {
+            auto Ret = RefCount.fetch_sub(1, std::memory_order_release) - 1;
+            if (Ret == 0)
+            {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                delete this;
+            }
+            return Ret;
+        }
+
+    private:
+        std::atomic<unsigned long> RefCount = 0;
     };
 }
\ No newline at end of file
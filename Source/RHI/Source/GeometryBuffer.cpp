@@ -0,0 +1,102 @@
+#include "RHI/GeometryBuffer.h"
+namespace Neko::RHI
+{
+    FGeometryBuffer::FGeometryBuffer(IDevice* Device, const FGeometryBufferDesc& InDesc)
+        : Desc(InDesc),
+        VertexAllocator(InDesc.MaxVertexNum, InDesc.MaxMeshNum),
+        IndexAllocator(InDesc.MaxIndexNum, InDesc.MaxMeshNum)
+    {
+        assert(Device != nullptr);
+        assert(Desc.VertexStride > 0);
+
+        auto VertexBufferDesc = FBufferDesc()
+            .SetSize((uint64_t)Desc.VertexStride * Desc.MaxVertexNum)
+            .SetBufferUsage(EBufferUsage::VertexBuffer | EBufferUsage::TransferDest)
+            .SetCategory(EResourceCategory::Mesh);
+        VertexBuffer = Device->CreateBuffer(VertexBufferDesc);
+
+        auto IndexBufferDesc = FBufferDesc()
+            .SetSize((uint64_t)GetIndexSize() * Desc.MaxIndexNum)
+            .SetBufferUsage(EBufferUsage::IndexBuffer | EBufferUsage::TransferDest)
+            .SetCategory(EResourceCategory::Mesh);
+        IndexBuffer = Device->CreateBuffer(IndexBufferDesc);
+    }
+
+    FGeometryAllocation FGeometryBuffer::Allocate(uint32_t VertexNum, uint32_t IndexNum)
+    {
+        FGeometryAllocation Allocation;
+        Allocation.Vertices = VertexAllocator.Allocate(VertexNum);
+        if (!Allocation.Vertices.IsValid())
+        {
+            return {};
+        }
+
+        if (IndexNum > 0)
+        {
+            Allocation.Indices = IndexAllocator.Allocate(IndexNum);
+            if (!Allocation.Indices.IsValid())
+            {
+                VertexAllocator.Free(Allocation.Vertices);
+                return {};
+            }
+        }
+
+        Allocation.VertexNum = VertexNum;
+        Allocation.IndexNum = IndexNum;
+        return Allocation;
+    }
+
+    void FGeometryBuffer::Free(const FGeometryAllocation& Allocation)
+    {
+        VertexAllocator.Free(Allocation.Vertices);
+        IndexAllocator.Free(Allocation.Indices);
+    }
+
+    uint64_t FGeometryBuffer::GetVertexByteOffset(const FGeometryAllocation& Allocation) const
+    {
+        return (uint64_t)Allocation.GetVertexOffset() * Desc.VertexStride;
+    }
+
+    uint64_t FGeometryBuffer::GetIndexByteOffset(const FGeometryAllocation& Allocation) const
+    {
+        return (uint64_t)Allocation.GetFirstIndex() * GetIndexSize();
+    }
+
+    void FGeometryBuffer::Upload(ICmdList* CmdList, IBuffer* SrcBuffer, uint64_t SrcVertexOffset, uint64_t SrcIndexOffset, const FGeometryAllocation& Allocation)
+    {
+        assert(Allocation.IsValid());
+
+        auto VertexCopyDesc = FCopyBufferDesc()
+            .SetSrcOffset(SrcVertexOffset)
+            .SetDestOffset(GetVertexByteOffset(Allocation))
+            .SetSize((uint64_t)Allocation.VertexNum * Desc.VertexStride);
+        CmdList->CopyBuffer(VertexBuffer, SrcBuffer, VertexCopyDesc);
+
+        if (Allocation.IndexNum > 0)
+        {
+            auto IndexCopyDesc = FCopyBufferDesc()
+                .SetSrcOffset(SrcIndexOffset)
+                .SetDestOffset(GetIndexByteOffset(Allocation))
+                .SetSize((uint64_t)Allocation.IndexNum * GetIndexSize());
+            CmdList->CopyBuffer(IndexBuffer, SrcBuffer, IndexCopyDesc);
+        }
+    }
+
+    void FGeometryBuffer::Bind(ICmdList* CmdList, uint32_t Binding)
+    {
+        CmdList->BindVertexBuffer(VertexBuffer, Binding, 0);
+        CmdList->BindIndexBuffer(IndexBuffer, 0, Desc.IndexType);
+    }
+
+    void FGeometryBuffer::Draw(ICmdList* CmdList, const FGeometryAllocation& Allocation)
+    {
+        if (Allocation.IndexNum > 0)
+        {
+            CmdList->DrawIndexed(Allocation.IndexNum, Allocation.GetFirstIndex(), Allocation.GetVertexOffset());
+        }
+        else
+        {
+            CmdList->Draw(Allocation.VertexNum, Allocation.GetVertexOffset());
+        }
+    }
+}
@@ -1,10 +1,12 @@
 #pragma once
 #include "RHI/RHI.h"
+#include "MiniCore/SlabPool.h"
 #include "volk.h"
 #include "OS/Window.h"
 #include <list>
 #include <iostream>
 #include <vector>
+#include <deque>
 #include <mutex>
 #define VULKAN_H_ // workaround for macro pollution
 #include "vk_mem_alloc.h"
@@ -52,6 +54,10 @@ namespace Neko::RHI::Vulkan
 		{
 			return VkShaderStageFlagBits::VK_SHADER_STAGE_FRAGMENT_BIT;
 		}
+		case EShaderStage::Compute:
+		{
+			return VkShaderStageFlagBits::VK_SHADER_STAGE_COMPUTE_BIT;
+		}
 		case EShaderStage::All:
 		{
 			return VkShaderStageFlagBits::VK_SHADER_STAGE_ALL;
@@ -100,6 +106,90 @@ namespace Neko::RHI::Vulkan
 		{
 			return VkFormat::VK_FORMAT_R32G32B32_SFLOAT;
 		}
+		case EFormat::R32_SFLOAT:
+		{
+			return VkFormat::VK_FORMAT_R32_SFLOAT;
+		}
+		case EFormat::R32G32B32A32_SFLOAT:
+		{
+			return VkFormat::VK_FORMAT_R32G32B32A32_SFLOAT;
+		}
+		case EFormat::R32_UINT:
+		{
+			return VkFormat::VK_FORMAT_R32_UINT;
+		}
+		case EFormat::R32G32_UINT:
+		{
+			return VkFormat::VK_FORMAT_R32G32_UINT;
+		}
+		case EFormat::R32G32B32_UINT:
+		{
+			return VkFormat::VK_FORMAT_R32G32B32_UINT;
+		}
+		case EFormat::R32G32B32A32_UINT:
+		{
+			return VkFormat::VK_FORMAT_R32G32B32A32_UINT;
+		}
+		case EFormat::R32_SINT:
+		{
+			return VkFormat::VK_FORMAT_R32_SINT;
+		}
+		case EFormat::R32G32_SINT:
+		{
+			return VkFormat::VK_FORMAT_R32G32_SINT;
+		}
+		case EFormat::R32G32B32_SINT:
+		{
+			return VkFormat::VK_FORMAT_R32G32B32_SINT;
+		}
+		case EFormat::R32G32B32A32_SINT:
+		{
+			return VkFormat::VK_FORMAT_R32G32B32A32_SINT;
+		}
+		case EFormat::R8G8B8A8_UNORM:
+		{
+			return VkFormat::VK_FORMAT_R8G8B8A8_UNORM;
+		}
+		case EFormat::R8G8B8A8_SNORM:
+		{
+			return VkFormat::VK_FORMAT_R8G8B8A8_SNORM;
+		}
+		case EFormat::R16G16_SFLOAT:
+		{
+			return VkFormat::VK_FORMAT_R16G16_SFLOAT;
+		}
+		case EFormat::R16G16_SNORM:
+		{
+			return VkFormat::VK_FORMAT_R16G16_SNORM;
+		}
+		case EFormat::R16G16B16A16_SFLOAT:
+		{
+			return VkFormat::VK_FORMAT_R16G16B16A16_SFLOAT;
+		}
+		case EFormat::R16G16B16A16_UNORM:
+		{
+			return VkFormat::VK_FORMAT_R16G16B16A16_UNORM;
+		}
+		case EFormat::D16_UNORM:
+		{
+			return VkFormat::VK_FORMAT_D16_UNORM;
+		}
+		case EFormat::D32_SFLOAT:
+		{
+			return VkFormat::VK_FORMAT_D32_SFLOAT;
+		}
+		case EFormat::D24_UNORM_S8_UINT:
+		{
+			return VkFormat::VK_FORMAT_D24_UNORM_S8_UINT;
+		}
+		case EFormat::D32_SFLOAT_S8_UINT:
+		{
+			return VkFormat::VK_FORMAT_D32_SFLOAT_S8_UINT;
+		}
+		case EFormat::Undefined:
+		{
+			return VkFormat::VK_FORMAT_UNDEFINED;
+		}
 		default:
 			CHECK(false);
 			return VkFormat::VK_FORMAT_UNDEFINED;
@@ -126,6 +216,86 @@ namespace Neko::RHI::Vulkan
 		{
 			return EFormat::R32G32B32_SFLOAT;
 		}
+		case VkFormat::VK_FORMAT_R32_SFLOAT:
+		{
+			return EFormat::R32_SFLOAT;
+		}
+		case VkFormat::VK_FORMAT_R32G32B32A32_SFLOAT:
+		{
+			return EFormat::R32G32B32A32_SFLOAT;
+		}
+		case VkFormat::VK_FORMAT_R32_UINT:
+		{
+			return EFormat::R32_UINT;
+		}
+		case VkFormat::VK_FORMAT_R32G32_UINT:
+		{
+			return EFormat::R32G32_UINT;
+		}
+		case VkFormat::VK_FORMAT_R32G32B32_UINT:
+		{
+			return EFormat::R32G32B32_UINT;
+		}
+		case VkFormat::VK_FORMAT_R32G32B32A32_UINT:
+		{
+			return EFormat::R32G32B32A32_UINT;
+		}
+		case VkFormat::VK_FORMAT_R32_SINT:
+		{
+			return EFormat::R32_SINT;
+		}
+		case VkFormat::VK_FORMAT_R32G32_SINT:
+		{
+			return EFormat::R32G32_SINT;
+		}
+		case VkFormat::VK_FORMAT_R32G32B32_SINT:
+		{
+			return EFormat::R32G32B32_SINT;
+		}
+		case VkFormat::VK_FORMAT_R32G32B32A32_SINT:
+		{
+			return EFormat::R32G32B32A32_SINT;
+		}
+		case VkFormat::VK_FORMAT_R8G8B8A8_UNORM:
+		{
+			return EFormat::R8G8B8A8_UNORM;
+		}
+		case VkFormat::VK_FORMAT_R8G8B8A8_SNORM:
+		{
+			return EFormat::R8G8B8A8_SNORM;
+		}
+		case VkFormat::VK_FORMAT_R16G16_SFLOAT:
+		{
+			return EFormat::R16G16_SFLOAT;
+		}
+		case VkFormat::VK_FORMAT_R16G16_SNORM:
+		{
+			return EFormat::R16G16_SNORM;
+		}
+		case VkFormat::VK_FORMAT_R16G16B16A16_SFLOAT:
+		{
+			return EFormat::R16G16B16A16_SFLOAT;
+		}
+		case VkFormat::VK_FORMAT_R16G16B16A16_UNORM:
+		{
+			return EFormat::R16G16B16A16_UNORM;
+		}
+		case VkFormat::VK_FORMAT_D16_UNORM:
+		{
+			return EFormat::D16_UNORM;
+		}
+		case VkFormat::VK_FORMAT_D32_SFLOAT:
+		{
+			return EFormat::D32_SFLOAT;
+		}
+		case VkFormat::VK_FORMAT_D24_UNORM_S8_UINT:
+		{
+			return EFormat::D24_UNORM_S8_UINT;
+		}
+		case VkFormat::VK_FORMAT_D32_SFLOAT_S8_UINT:
+		{
+			return EFormat::D32_SFLOAT_S8_UINT;
+		}
 		default:
 			CHECK(false);
 			return EFormat::Undefined;
@@ -335,6 +505,10 @@ namespace Neko::RHI::Vulkan
 		{
 			return VkDescriptorType::VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 		}
+		case EResourceType::StorageBuffer:
+		{
+			return VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
 		default:
 			CHECK(false);
 			return VkDescriptorType::VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -363,6 +537,14 @@ namespace Neko::RHI::Vulkan
 		{
 			return VkAttachmentLoadOp::VK_ATTACHMENT_LOAD_OP_LOAD;
 		}
+		case ELoadOp::Clear:
+		{
+			return VkAttachmentLoadOp::VK_ATTACHMENT_LOAD_OP_CLEAR;
+		}
+		case ELoadOp::DontCare:
+		{
+			return VkAttachmentLoadOp::VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		}
 		default:
 			CHECK(false);
 			return VkAttachmentLoadOp::VK_ATTACHMENT_LOAD_OP_LOAD;
@@ -377,12 +559,73 @@ namespace Neko::RHI::Vulkan
 		{
 			return VkAttachmentStoreOp::VK_ATTACHMENT_STORE_OP_STORE;
 		}
+		case EStoreOp::DontCare:
+		{
+			return VkAttachmentStoreOp::VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		}
 		default:
 			CHECK(false);
 			return VkAttachmentStoreOp::VK_ATTACHMENT_STORE_OP_STORE;
 		}
 	}
 
+	inline VkImageAspectFlags ConvertToVkImageAspectFlags(const EFormat& Format)
+	{
+		if (IsStencilFormat(Format))
+		{
+			return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		}
+		if (IsDepthFormat(Format))
+		{
+			return VK_IMAGE_ASPECT_DEPTH_BIT;
+		}
+		return VK_IMAGE_ASPECT_COLOR_BIT;
+	}
+
+	inline VkImageUsageFlags ConvertToVkImageUsageFlags(const ETextureUsage& Usage)
+	{
+		VkImageUsageFlags ret = 0;
+		if ((Usage & ETextureUsage::Texture) != 0)
+		{
+			ret |= VkImageUsageFlagBits::VK_IMAGE_USAGE_SAMPLED_BIT;
+		}
+		if ((Usage & ETextureUsage::StorageTexture) != 0)
+		{
+			ret |= VkImageUsageFlagBits::VK_IMAGE_USAGE_STORAGE_BIT;
+		}
+		if ((Usage & ETextureUsage::ColorAttachment) != 0)
+		{
+			ret |= VkImageUsageFlagBits::VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		}
+		if ((Usage & ETextureUsage::DepthStencilAttachment) != 0)
+		{
+			ret |= VkImageUsageFlagBits::VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		}
+		return ret;
+	}
+
+	inline VkImageType ConvertToVkImageType(const ETextureType& Type)
+	{
+		switch (Type)
+		{
+		case ETextureType::Texture1D:
+		{
+			return VkImageType::VK_IMAGE_TYPE_1D;
+		}
+		case ETextureType::Texture2D:
+		{
+			return VkImageType::VK_IMAGE_TYPE_2D;
+		}
+		case ETextureType::Texture3D:
+		{
+			return VkImageType::VK_IMAGE_TYPE_3D;
+		}
+		default:
+			CHECK(false);
+			return VkImageType::VK_IMAGE_TYPE_2D;
+		}
+	}
+
 	inline VkBufferUsageFlags ConvertToVkBufferUsageFlags(const EBufferUsage& Usage)
 	{
 		VkBufferUsageFlags ret = 0;
@@ -402,6 +645,14 @@ namespace Neko::RHI::Vulkan
 		{
 			ret |= VkBufferUsageFlagBits::VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 		}
+		if ((Usage & EBufferUsage::StorageBuffer) != 0)
+		{
+			ret |= VkBufferUsageFlagBits::VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		}
+		if ((Usage & EBufferUsage::IndirectBuffer) != 0)
+		{
+			ret |= VkBufferUsageFlagBits::VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+		}
 		return ret;
 	}
 
@@ -432,6 +683,42 @@ namespace Neko::RHI::Vulkan
 		{
 			return VkAccessFlagBits::VK_ACCESS_MEMORY_READ_BIT;
 		}
+		case EResourceState::DepthStencilAttachment:
+		{
+			return VkAccessFlagBits::VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VkAccessFlagBits::VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		}
+		case EResourceState::TransferDest:
+		{
+			return VkAccessFlagBits::VK_ACCESS_TRANSFER_WRITE_BIT;
+		}
+		case EResourceState::ShaderRead:
+		{
+			return VkAccessFlagBits::VK_ACCESS_SHADER_READ_BIT;
+		}
+		case EResourceState::ShaderWrite:
+		{
+			return VkAccessFlagBits::VK_ACCESS_SHADER_READ_BIT | VkAccessFlagBits::VK_ACCESS_SHADER_WRITE_BIT;
+		}
+		case EResourceState::IndirectArgument:
+		{
+			return VkAccessFlagBits::VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+		}
+		case EResourceState::IndexBuffer:
+		{
+			return VkAccessFlagBits::VK_ACCESS_INDEX_READ_BIT;
+		}
+		case EResourceState::VertexBuffer:
+		{
+			return VkAccessFlagBits::VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+		}
+		case EResourceState::TransferSrc:
+		{
+			return VkAccessFlagBits::VK_ACCESS_TRANSFER_READ_BIT;
+		}
+		case EResourceState::HostRead:
+		{
+			return VkAccessFlagBits::VK_ACCESS_HOST_READ_BIT;
+		}
 		default:
 			CHECK(false);
 			return VkAccessFlagBits::VK_ACCESS_NONE;
@@ -454,6 +741,10 @@ namespace Neko::RHI::Vulkan
 		{
 			return VkImageLayout::VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 		}
+		case EResourceState::DepthStencilAttachment:
+		{
+			return VkImageLayout::VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		}
 		default:
 			CHECK(false);
 			return VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED;
@@ -476,12 +767,96 @@ namespace Neko::RHI::Vulkan
 		{
 			return VkPipelineStageFlagBits::VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
 		}
+		case EResourceState::DepthStencilAttachment:
+		{
+			return VkPipelineStageFlagBits::VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VkPipelineStageFlagBits::VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		}
+		case EResourceState::TransferDest:
+		case EResourceState::TransferSrc:
+		{
+			return VkPipelineStageFlagBits::VK_PIPELINE_STAGE_TRANSFER_BIT;
+		}
+		case EResourceState::HostRead:
+		{
+			return VkPipelineStageFlagBits::VK_PIPELINE_STAGE_HOST_BIT;
+		}
+		case EResourceState::ShaderRead:
+		case EResourceState::ShaderWrite:
+		{
+			return VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		}
+		case EResourceState::IndirectArgument:
+		{
+			return VkPipelineStageFlagBits::VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+		}
+		case EResourceState::IndexBuffer:
+		case EResourceState::VertexBuffer:
+		{
+			return VkPipelineStageFlagBits::VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+		}
 		default:
 			CHECK(false);
 			return VkPipelineStageFlagBits::VK_PIPELINE_STAGE_NONE;
 		}
 	}
 
+	constexpr uint32_t MAX_TRACKED_QUEUE_COUNT = 16;
+
+	struct FContext;
+	class FQueue;
+
+	// vulkan objects are not destroyed when the last reference drops, instead they are queued
+	// together with the timeline value every queue has submitted so far, and destroyed once the
+	// gpu has passed all of these values, so nothing needs to wait for the device to go idle.
+	// objects must not be released between recording a command list that uses them and submitting it
+	class FDeferredReleaseQueue
+	{
+	private:
+		struct FPendingRelease
+		{
+			VkObjectType Type = VK_OBJECT_TYPE_UNKNOWN;
+			uint64_t Handle = 0;
+			VmaAllocation Allocation = nullptr;
+			std::array<uint64_t, MAX_TRACKED_QUEUE_COUNT> TimelineValues = {};
+		};
+
+		const FContext& Context;
+		std::mutex Mutex;
+		std::array<FQueue*, MAX_TRACKED_QUEUE_COUNT> Queues = {};
+		std::deque<FPendingRelease> PendingReleases;
+
+		void Destroy(const FPendingRelease& PendingRelease);
+	public:
+		FDeferredReleaseQueue(const FContext&);
+		~FDeferredReleaseQueue();
+
+		void RegisterQueue(FQueue*);
+		void UnregisterQueue(FQueue*);
+
+		void Release(VkObjectType Type, uint64_t Handle, VmaAllocation Allocation = nullptr);
+		// destroys everything the gpu is done with
+		void Collect();
+		// destroys everything, the device must be idle
+		void Flush();
+	};
+
+	struct FMemoryCategoryCounter
+	{
+		std::atomic<uint64_t> Bytes = 0;
+		std::atomic<uint32_t> AllocationCount = 0;
+	};
+
+	// columns of the buffer handle pool
+	enum EBufferPoolColumn : size_t
+	{
+		BUFFER_POOL_BUFFER,
+		BUFFER_POOL_ALLOCATION,
+		BUFFER_POOL_ALLOCATION_SIZE,
+		BUFFER_POOL_CATEGORY,
+		BUFFER_POOL_MAPPED_DATA,
+	};
+	typedef THandlePool<FBufferHandleTag, VkBuffer, VmaAllocation, uint64_t, EResourceCategory, uint8_t*> FBufferPool;
+
 	struct FContext final : public RefCounter<IResource>
 	{
 		VkInstance Instance = nullptr;
@@ -495,15 +870,37 @@ namespace Neko::RHI::Vulkan
 		VkDeviceCreateInfo DeviceInfo = {};
 
 		VmaAllocator Allocator;
+		bool bMemoryBudget = false;
+		FFeatures Features;
+
+		// families queues were created from, resources are shared between them when there is more than one
+		std::vector<uint32_t> QueueFamilyIndices;
+
+		std::unique_ptr<FDeferredReleaseQueue> ReleaseQueue;
+
+		// buffers behind FBufferHandle, the mutex only guards creation and destruction, validity checks need none
+		std::unique_ptr<FBufferPool> BufferPool;
+		std::mutex BufferPoolMutex;
+		// the buffer behind a handle, null for a stale one, also checked in release builds,
+		// recording a destroyed buffer would be undefined on the gpu
+		VkBuffer ResolveBuffer(FBufferHandle Handle) const;
+
+		mutable std::array<FMemoryCategoryCounter, (size_t)EResourceCategory::Count> MemoryCategoryCounters;
+
+		void TrackAllocation(const EResourceCategory& Category, uint64_t Bytes) const;
+		void UntrackAllocation(const EResourceCategory& Category, uint64_t Bytes) const;
 
 		~FContext();
 	};
 
-	class FSemaphore : public RefCounter<ISemaphore>
+	class FSemaphore final : public RefCounter<ISemaphore>
 	{
+	public:
+		NEKO_SLAB_POOLED(FSemaphore)
 	private:
 		const FContext& Context;
 		VkSemaphore Semaphore = nullptr;
+		ESemaphoreType Type;
 		uint64_t Counter = 0;
 	public:
 		FSemaphore(const FContext& ,const ESemaphoreType&);
@@ -511,10 +908,15 @@ namespace Neko::RHI::Vulkan
 		VkSemaphore GetSemaphore() const { return Semaphore; }
 		virtual void SetCounter(uint64_t Value) override { Counter = Value; };
 		virtual uint64_t GetCounter() override { return Counter; }
+		virtual bool Wait(uint64_t Value, uint64_t Timeout) override;
+		virtual void Signal(uint64_t Value) override;
+		virtual uint64_t GetCompletedValue() override;
 	};
 
-	class FFence : public RefCounter<IFence>
+	class FFence final : public RefCounter<IFence>
 	{
+	public:
+		NEKO_SLAB_POOLED(FFence)
 	private:
 		const FContext& Context;
 		VkFence Fence = nullptr;
@@ -552,18 +954,27 @@ namespace Neko::RHI::Vulkan
 		ECmdQueueType Type;
 
 		VkQueue Queue = nullptr;
+
+		// signaled with an increasing value by every submission
+		std::mutex SubmitMutex;
+		VkSemaphore TimelineSemaphore = nullptr;
+		std::atomic<uint64_t> SubmittedValue = 0;
 	public:
 		FQueue(const FContext&, uint32_t queueFamliyIndex,uint32_t QueueIndex, ECmdQueueType cmdType);
 		~FQueue();
-		ECmdQueueType GetCmdQueueType() const { return Type; }
 		uint32_t GetFamilyIndex() const { return FamilyIndex; }
-		bool IsMatch(ECmdQueueType InType) { return (uint8_t)(InType & Type) > 0; }
+		bool IsMatch(ECmdQueueType InType) { return (InType & Type) == InType; }
 		VkQueue GetQueue() { return Queue; }
 
-		
-		
-		virtual void ExcuteCmdLists(ICmdList** CmdLists, uint32_t CmdListNum, const FExcuteDesc& Desc) override;
-		virtual void ExcuteCmdList(ICmdList* CmdList, const FExcuteDesc& Desc) override;
+		VkSemaphore GetTimelineSemaphore() const { return TimelineSemaphore; }
+		uint64_t GetSubmittedValue() const { return SubmittedValue.load(std::memory_order_acquire); }
+
+		virtual uint64_t ExcuteCmdLists(ICmdList** CmdLists, uint32_t CmdListNum, const FExcuteDesc& Desc) override;
+		virtual uint64_t ExcuteCmdList(ICmdList* CmdList, const FExcuteDesc& Desc) override;
+
+		virtual ECmdQueueType GetCmdQueueType() override { return Type; }
+		virtual uint64_t GetCompletedValue() override;
+		virtual void Wait(uint64_t Value) override;
 
 		[[nodiscard]] virtual std::vector<ICmdPoolRef> CreateCmdPools(uint32_t) override;
 		[[nodiscard]] virtual ICmdPoolRef CreateCmdPool() override;
@@ -582,6 +993,28 @@ namespace Neko::RHI::Vulkan
 		~FGraphicPipeline();
 
 		VkPipeline GetPipeline() const { return Pipeline; }
+		VkPipelineLayout GetPipelineLayout() const { return PipelineLayout; }
+		const FGraphicPipelineDesc& GetDesc() const { return Desc; }
+
+		bool Initalize();
+	};
+
+	class FComputePipeline final : public RefCounter<IComputePipeline>
+	{
+	private:
+		const FContext& Context;
+		FComputePipelineDesc Desc;
+		VkDescriptorSetLayout DescriptorSetLayout = nullptr;
+		VkPipelineLayout PipelineLayout = nullptr;
+		VkPipeline Pipeline = nullptr;
+
+	public:
+		FComputePipeline(const FContext&, const FComputePipelineDesc&);
+		~FComputePipeline();
+
+		VkPipeline GetPipeline() const { return Pipeline; }
+		VkPipelineLayout GetPipelineLayout() const { return PipelineLayout; }
+		const FComputePipelineDesc& GetDesc() const { return Desc; }
 
 		bool Initalize();
 	};
@@ -608,10 +1041,20 @@ namespace Neko::RHI::Vulkan
 
 	class FCmdList final : public RefCounter<ICmdList>
 	{
+	public:
+		NEKO_SLAB_POOLED(FCmdList)
+	private:
 		const FContext& Context;
 		FCmdPool* CmdPool;
 		//class FDevice* Device;
 		VkCommandBuffer CmdBuffer = nullptr;
+		FComputePipeline* ComputePipeline = nullptr;
+		// layout of the pipeline bound last, PushConstants writes to it
+		VkPipelineLayout PushConstantLayout = nullptr;
+		VkShaderStageFlags PushConstantStages = 0;
+		uint32_t PushConstantSize = 0;
+
+		void PushStorageBuffer(uint32_t Binding, VkBuffer Buffer, uint64_t Offset, uint64_t Size);
 	public:
 		FCmdList(const FContext&, FCmdPool*);
 		~FCmdList();
@@ -630,14 +1073,27 @@ namespace Neko::RHI::Vulkan
 
 		virtual void Draw(uint32_t VertexNum, uint32_t VertexOffset) override;
 		virtual void DrawIndexed(uint32_t IndexCount, uint32_t FirstIndex, uint32_t VertexOffset) override;
+		virtual void DrawIndexedIndirectCount(IBuffer* ArgsBuffer, uint64_t ArgsOffset, IBuffer* CountBuffer, uint64_t CountOffset, uint32_t MaxDrawNum) override;
 
 		virtual void BindGraphicPipeline(IGraphicPipeline*) override;
+		virtual void BindComputePipeline(IComputePipeline*) override;
+		virtual void BindStorageBuffer(uint32_t Binding, IBuffer* InBuffer, uint64_t Offset, uint64_t Size) override;
+		virtual void BindStorageBuffer(uint32_t Binding, FBufferHandle InBuffer, uint64_t Offset, uint64_t Size) override;
+		virtual void PushConstants(const void* Data, uint32_t Size) override;
+		virtual void Dispatch(uint32_t GroupNumX, uint32_t GroupNumY, uint32_t GroupNumZ) override;
 		virtual void ResourceBarrier(const FTextureTransitionDesc&) override;
 		virtual void ResourceBarrier(IColorAttachment*, const EResourceState& Src, const EResourceState& Dest) override;
+		virtual void ResourceBarrier(IDepthStencilAttachment*, const EResourceState& Src, const EResourceState& Dest) override;
+		virtual void ResourceBarrier(const FBufferBarrierDesc&) override;
 
 		virtual void CopyBuffer(IBuffer*, IBuffer*, const FCopyBufferDesc&) override;
+		virtual void FillBuffer(IBuffer*, uint64_t Offset, uint64_t Size, uint32_t Value) override;
 		virtual void BindVertexBuffer(IBuffer* InBuffer, uint32_t Binding, uint64_t Offset) override;
 		virtual void BindIndexBuffer(IBuffer* InBuffer, uint64_t Offset, const EIndexBufferType& Type) override;
+
+		virtual void CopyBuffer(FBufferHandle, FBufferHandle, const FCopyBufferDesc&) override;
+		virtual void BindVertexBuffer(FBufferHandle InBuffer, uint32_t Binding, uint64_t Offset) override;
+		virtual void BindIndexBuffer(FBufferHandle InBuffer, uint64_t Offset, const EIndexBufferType& Type) override;
 	};
 
 	class FBindingLayout final : public RefCounter<IBindingLayout>
@@ -655,61 +1111,110 @@ namespace Neko::RHI::Vulkan
 	class FColorAttachment final : public RefCounter<IColorAttachment>
 	{
 	public:
+		NEKO_SLAB_POOLED(FColorAttachment)
 		const FContext& Context;
 		VkImageView ImageView = nullptr;
 		FColorAttachmentDesc Desc;
 	
-		FColorAttachment(const FContext&, const FColorAttachmentDesc&);
-		~FColorAttachment();
+		// the view is owned by the texture
+		FColorAttachment(const FContext&, const FColorAttachmentDesc&, VkImageView);
 		VkImageView GetImageView() const { return ImageView; }
 	public:
 		virtual const FColorAttachmentDesc& GetDesc() override { return Desc; };
 	};
 
-	class FTexture final : public RefCounter <ITexture>
+	class FDepthStencilAttachment final : public RefCounter<IDepthStencilAttachment>
 	{
-	private:
-		const FContext& Context;
-		VkImage Image = nullptr;
-		FTextureDesc Desc;
-		bool bAutoRelease = false;
 	public:
-		FTexture(const FContext&, VkImage, const FTextureDesc&,bool InbAutoRelease = false);
+		const FContext& Context;
+		VkImageView ImageView = nullptr;
+		FDepthStencilAttachmentDesc Desc;
 
-		VkImage GetImage() const { return Image; }
+		// the view is owned by the texture
+		FDepthStencilAttachment(const FContext&, const FDepthStencilAttachmentDesc&, VkImageView);
+		VkImageView GetImageView() const { return ImageView; }
 	public:
-		virtual const FTextureDesc& GetDesc() override { return Desc; };
+		virtual const FDepthStencilAttachmentDesc& GetDesc() override { return Desc; };
 	};
 
 	class FTexture2DView final : public RefCounter<ITexture2DView>
 	{
+	public:
+		NEKO_SLAB_POOLED(FTexture2DView)
 	private:
 		const FContext& Context;
 		VkImageView ImageView = nullptr;
 		FTexture2DViewDesc Desc;
 	public:
-		FTexture2DView(const FContext&, const FTexture2DViewDesc&);
-		~FTexture2DView();
+		// the view is owned by the texture
+		FTexture2DView(const FContext&, const FTexture2DViewDesc&, VkImageView);
 		VkImageView GetImageView() const { return ImageView; }
 	public:
 		virtual ITextureRef GetTexture() override;
 		virtual const FTexture2DViewDesc& GetDesc() override;
 	};
 
+	struct FImageViewKey
+	{
+		VkImageViewType Type = VK_IMAGE_VIEW_TYPE_2D;
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		uint16_t MipOffset = 0;
+		uint16_t MipNum = 1;
+		uint16_t ArrayOffset = 0;
+		uint16_t ArraySize = 1;
+
+		bool operator==(const FImageViewKey&) const = default;
+	};
+
+	class FTexture final : public RefCounter <ITexture>
+	{
+	private:
+		const FContext& Context;
+		VkImage Image = nullptr;
+		FTextureDesc Desc;
+		bool bAutoRelease = false;
+		VmaAllocation Allocation = nullptr;
+		uint64_t AllocationSize = 0;
+
+		// a texture only has a handful of views, so these are searched linearly and usually stay inline
+		std::mutex ViewMutex;
+		small_vector<std::pair<FImageViewKey, VkImageView>, 4> ImageViews;
+		std::vector<RefCountPtr<FColorAttachment>> ColorAttachments;
+		std::vector<RefCountPtr<FDepthStencilAttachment>> DepthStencilAttachments;
+		std::vector<RefCountPtr<FTexture2DView>> Texture2DViews;
+
+		VkImageView GetOrCreateImageView(const FImageViewKey&);
+	public:
+		FTexture(const FContext&, VkImage, const FTextureDesc&,bool InbAutoRelease = false);
+		// allocates and owns its image
+		FTexture(const FContext&, const FTextureDesc&);
+		~FTexture();
+
+		VkImage GetImage() const { return Image; }
+
+		IColorAttachmentRef GetColorAttachment(const FColorAttachmentDesc&);
+		IDepthStencilAttachmentRef GetDepthStencilAttachment(const FDepthStencilAttachmentDesc&);
+		ITexture2DViewRef GetTexture2DView(const FTexture2DViewDesc&);
+	public:
+		virtual const FTextureDesc& GetDesc() override { return Desc; };
+	};
+
 	class FBuffer final : public RefCounter<IBuffer>
 	{
 	private:
 		const FContext& Context;
 		VkBuffer Buffer = nullptr;
 		FBufferDesc Desc;
-		VmaAllocation Allocation;
+		VmaAllocation Allocation = nullptr;
+		uint64_t AllocationSize = 0;
 
 		bool bMapped = false;
 	public:
 		FBuffer(const FContext&, const FBufferDesc&);
 		~FBuffer();
 	
-		uint8_t* Map(uint32_t Offset, uint32_t Size);
+		uint8_t* Map(uint64_t Offset, uint64_t Size);
 		void  Unmap();
 		bool IsMapped() const { return bMapped; }
 		VkBuffer GetBuffer() const { return Buffer; }
@@ -727,7 +1232,15 @@ namespace Neko::RHI::Vulkan
 		uint32_t ImageCount = 0;
 		uint32_t ImageIndex = 0;
 		const FContext& Context;
+		FSwapChainDesc Desc;
 		std::vector<ITextureRef> Textures;
+
+		// resize requests are coalesced and handled once by the next acquire
+		bool bPendingRecreate = false;
+		uint32_t RequestedWidth = 0;
+		uint32_t RequestedHeight = 0;
+
+		bool Recreate();
 	public:
 		FSwapchain(const FContext&);
 		~FSwapchain();
@@ -736,11 +1249,58 @@ namespace Neko::RHI::Vulkan
 	public:
 		virtual uint32_t AcquireNext(ISemaphore*, IFence*) override;
 		virtual void Present(const FPresentDesc&) override;
+		virtual void Resize(uint32_t Width, uint32_t Height) override;
 		virtual uint32_t GetTextureNum() override;
+		virtual ITextureRef GetTexture(uint32_t Index) override;
 		virtual std::vector<ITextureRef> GetTextures() override;
 		virtual void Reset() override;
 	};
 
+	class FFrameScheduler final : public RefCounter<IFrameScheduler>
+	{
+	private:
+		struct FFrame
+		{
+			ICmdPoolRef CmdPool;
+			RefCountPtr<FBuffer> UploadBuffer;
+			uint8_t* UploadData = nullptr;
+			uint64_t UploadOffset = 0;
+			std::unique_ptr<FLinearArena> Arena;
+			RefCountPtr<FSemaphore> AcquireSemaphore;
+			// the frame timeline reaches this value once the gpu is done with the frame
+			uint64_t TimelineValue = 0;
+		};
+
+		const FContext& Context;
+		FFrameSchedulerDesc Desc;
+		RefCountPtr<FQueue> Queue;
+		ISwapchainRef Swapchain;
+		RefCountPtr<FSemaphore> Timeline;
+		std::vector<FFrame> Frames;
+		// indexed by swapchain image, an image is only presented again after it was acquired again
+		std::vector<RefCountPtr<FSemaphore>> PresentSemaphores;
+
+		uint64_t FrameNumber = 0;
+		uint32_t FrameIndex = 0;
+		uint32_t SwapchainIndex = SWAPCHAIN_INVALID_INDEX;
+
+	public:
+		FFrameScheduler(const FContext&, const FFrameSchedulerDesc&);
+		~FFrameScheduler();
+	public:
+		virtual bool BeginFrame() override;
+		virtual void EndFrame(ICmdList** CmdLists, uint32_t CmdListNum) override;
+		[[nodiscard]] virtual ICmdListRef CreateCmdList() override;
+		[[nodiscard]] virtual FUploadAllocation AllocateUpload(uint64_t Size, uint64_t Alignment) override;
+		virtual FLinearArena& GetFrameArena() override { return *Frames[FrameIndex].Arena; }
+		virtual uint32_t GetFramesInFlight() override { return (uint32_t)Frames.size(); }
+		virtual uint32_t GetFrameIndex() override { return FrameIndex; }
+		virtual uint64_t GetFrameNumber() override { return FrameNumber; }
+		virtual uint32_t GetSwapchainIndex() override { return SwapchainIndex; }
+		virtual ITextureRef GetSwapchainTexture() override;
+		virtual void WaitIdle() override;
+	};
+
 	class FDevice final : public RefCounter<IDevice>
 	{
 	private:
@@ -759,20 +1319,35 @@ namespace Neko::RHI::Vulkan
 		[[nodiscard]] virtual IQueueRef CreateQueue(const ECmdQueueType& CmdQueueType = ECmdQueueType::Graphic) override;
 		[[nodiscard]] virtual IShaderRef CreateShader(const FShaderDesc &) override;
 		[[nodiscard]] virtual IGraphicPipelineRef CreateGraphicPipeline(const FGraphicPipelineDesc &) override;
+		[[nodiscard]] virtual IComputePipelineRef CreateComputePipeline(const FComputePipelineDesc &) override;
 		[[nodiscard]] virtual IBindingLayoutRef CreateBindingLayout(const FBindingLayoutDesc &desc) override;
+		[[nodiscard]] virtual IFrameSchedulerRef CreateFrameScheduler(const FFrameSchedulerDesc&) override;
 		[[nodiscard]] virtual ISwapchainRef CreateSwapChain(const FSwapChainDesc &desc) override;
 		[[nodiscard]] virtual ITexture2DViewRef CreateTexture2DView(const FTexture2DViewDesc&) override;
 		[[nodiscard]] virtual ITexture2DViewRef CreateTexture2DView(ITexture*) override;
 		[[nodiscard]] virtual IColorAttachmentRef CreateColorAttachment(const FColorAttachmentDesc&) override;
+		[[nodiscard]] virtual IDepthStencilAttachmentRef CreateDepthStencilAttachment(const FDepthStencilAttachmentDesc&) override;
+		[[nodiscard]] virtual ITextureRef CreateTexture(const FTextureDesc&) override;
 		[[nodiscard]] virtual IBufferRef CreateBuffer(const FBufferDesc&) override;
 
-		[[nodiscard]] virtual uint8_t* MapBuffer(IBuffer*, uint32_t Offset, uint32_t Size) override;
+		[[nodiscard]] virtual uint8_t* MapBuffer(IBuffer*, uint64_t Offset, uint64_t Size) override;
 		[[nodiscard]] virtual void UnmapBuffer(IBuffer*) override;
+
+		[[nodiscard]] virtual FBufferHandle CreateBufferHandle(const FBufferDesc&) override;
+		virtual void DestroyBufferHandle(FBufferHandle) override;
+		virtual bool IsBufferHandleValid(FBufferHandle) override;
+		virtual uint8_t* GetMappedData(FBufferHandle) override;
 		
 		virtual bool IsCmdQueueValid(const ECmdQueueType&) override;
+		virtual bool WaitSemaphores(ISemaphore** Semaphores, const uint64_t* Values, uint32_t SemaphoreNum, bool bWaitAll, uint64_t Timeout) override;
 
 		virtual void WaitIdle() override;
 
 		virtual FGPUInfo GetGPUInfo() override;
+
+		virtual FFeatures GetFeatures() override;
+
+		virtual FMemoryStats GetMemoryStats() override;
+		virtual std::string BuildMemoryStatsString(bool bDetailed) override;
     };
 };
@@ -9,14 +9,15 @@ namespace Neko::RHI::Vulkan
     {
         if (DescriptorSetLayout)
         {
-            vkDestroyDescriptorSetLayout(Context.Device, DescriptorSetLayout, Context.AllocationCallbacks);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)DescriptorSetLayout);
             DescriptorSetLayout = nullptr;
         }
     }
 
     bool FBindingLayout::Initalize(const FBindingLayoutDesc &desc)
     {
-        std::vector<VkDescriptorSetLayoutBinding> LayoutBindings;
+        FScratchScope Scratch;
+        TArenaVector<VkDescriptorSetLayoutBinding> LayoutBindings(Scratch);
         LayoutBindings.reserve(desc.BindingArray.size());
 
         for (auto &binding : desc.BindingArray)
@@ -2,35 +2,57 @@
 #include "vk_mem_alloc.h"
 namespace Neko::RHI::Vulkan
 {
-    FBuffer::FBuffer(const FContext& Ctx, const FBufferDesc& InDesc):Context(Ctx),Desc(InDesc)
+    static VkBuffer CreateVkBuffer(const FContext& Context, const FBufferDesc& Desc, VmaAllocationCreateFlags Flags, VmaAllocation& Allocation, VmaAllocationInfo& AllocationInfo)
     {
         VkBufferCreateInfo BufferCreateInfo = {};
         BufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         BufferCreateInfo.size = Desc.Size;
         BufferCreateInfo.usage = ConvertToVkBufferUsageFlags(Desc.BufferUsage);
         BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        // shared between the families of the created queues so compute and transfer queues need no ownership transfers
+        if (Context.QueueFamilyIndices.size() > 1)
+        {
+            BufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            BufferCreateInfo.queueFamilyIndexCount = (uint32_t)Context.QueueFamilyIndices.size();
+            BufferCreateInfo.pQueueFamilyIndices = Context.QueueFamilyIndices.data();
+        }
 
         VmaAllocationCreateInfo AllocInfo = {};
         AllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
-        AllocInfo.flags = ConvertToVmaAllocationCreateFlags(Desc.BufferUsage);
+        AllocInfo.flags = ConvertToVmaAllocationCreateFlags(Desc.BufferUsage) | Flags;
+
+        VkBuffer Buffer = nullptr;
+        VK_CHECK_THROW(vmaCreateBuffer(Context.Allocator, &BufferCreateInfo, &AllocInfo, &Buffer, &Allocation, &AllocationInfo), "Failed to create buffer");
 
-        vmaCreateBuffer(Context.Allocator, &BufferCreateInfo, &AllocInfo, &Buffer, &Allocation, nullptr);
+        vmaSetAllocationName(Context.Allocator, Allocation, GetResourceCategoryName(Desc.Category));
+        Context.TrackAllocation(Desc.Category, AllocationInfo.size);
+        return Buffer;
+    }
+
+    FBuffer::FBuffer(const FContext& Ctx, const FBufferDesc& InDesc):Context(Ctx),Desc(InDesc)
+    {
+        VmaAllocationInfo AllocationInfo = {};
+        Buffer = CreateVkBuffer(Context, Desc, 0, Allocation, AllocationInfo);
+        AllocationSize = AllocationInfo.size;
     }
 
     FBuffer::~FBuffer()
     {
         if (Buffer)
         {
-            vmaDestroyBuffer(Context.Allocator, Buffer, Allocation);
+            Context.UntrackAllocation(Desc.Category, AllocationSize);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_BUFFER, (uint64_t)Buffer, Allocation);
             Buffer = nullptr;
         }
     }
 
-    uint8_t* FBuffer::Map(uint32_t Offset, uint32_t Size)
+    uint8_t* FBuffer::Map(uint64_t Offset, uint64_t Size)
     {
         bMapped = true;
         void* Data;
         vmaMapMemory(Context.Allocator, Allocation,  &Data);
+        // no-op on coherent memory, makes gpu writes visible otherwise
+        vmaInvalidateAllocation(Context.Allocator, Allocation, Offset, Size);
         return ((uint8_t*)Data + Offset);
     }
     void  FBuffer::Unmap()
@@ -44,7 +66,7 @@ namespace Neko::RHI::Vulkan
         return new FBuffer(Context, InDesc);
     }
 
-    uint8_t* FDevice::MapBuffer(IBuffer* InBuffer, uint32_t Offset, uint32_t Size)
+    uint8_t* FDevice::MapBuffer(IBuffer* InBuffer, uint64_t Offset, uint64_t Size)
     {
         auto Buffer = reinterpret_cast<FBuffer*>(InBuffer);
         if (Buffer->IsMapped())
@@ -63,6 +85,63 @@ namespace Neko::RHI::Vulkan
         Buffer->Unmap();
     }
 
+    FBufferHandle FDevice::CreateBufferHandle(const FBufferDesc& InDesc)
+    {
+        // host visible buffers are mapped once here, the handle has no map and unmap
+        VmaAllocationCreateFlags Flags = (InDesc.BufferUsage & EBufferUsage::HostAccess) != 0 ? VMA_ALLOCATION_CREATE_MAPPED_BIT : 0;
+        VmaAllocation Allocation = nullptr;
+        VmaAllocationInfo AllocationInfo = {};
+        VkBuffer Buffer = CreateVkBuffer(Context, InDesc, Flags, Allocation, AllocationInfo);
+
+        FBufferHandle Handle;
+        {
+            std::lock_guard Lock(Context.BufferPoolMutex);
+            Handle = Context.BufferPool->Allocate(Buffer, Allocation, AllocationInfo.size, InDesc.Category, (uint8_t*)AllocationInfo.pMappedData);
+        }
+        if (Handle.IsNull())
+        {
+            Context.UntrackAllocation(InDesc.Category, AllocationInfo.size);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_BUFFER, (uint64_t)Buffer, Allocation);
+        }
+        return Handle;
+    }
+
+    void FDevice::DestroyBufferHandle(FBufferHandle Handle)
+    {
+        std::lock_guard Lock(Context.BufferPoolMutex);
+        if (!Context.BufferPool->IsValid(Handle))
+        {
+            throw OS::FOSException("Buffer handle is not valid");
+        }
+        auto& Pool = *Context.BufferPool;
+        Context.UntrackAllocation(Pool.Get<BUFFER_POOL_CATEGORY>(Handle), Pool.Get<BUFFER_POOL_ALLOCATION_SIZE>(Handle));
+        Context.ReleaseQueue->Release(VK_OBJECT_TYPE_BUFFER, (uint64_t)Pool.Get<BUFFER_POOL_BUFFER>(Handle), Pool.Get<BUFFER_POOL_ALLOCATION>(Handle));
+        Pool.Free(Handle);
+    }
+
+    bool FDevice::IsBufferHandleValid(FBufferHandle Handle)
+    {
+        return Context.BufferPool->IsValid(Handle);
+    }
+
+    uint8_t* FDevice::GetMappedData(FBufferHandle Handle)
+    {
+        if (!Context.BufferPool->IsValid(Handle))
+        {
+            return nullptr;
+        }
+        return Context.BufferPool->Get<BUFFER_POOL_MAPPED_DATA>(Handle);
+    }
+
+    VkBuffer FContext::ResolveBuffer(FBufferHandle Handle) const
+    {
+        if (!BufferPool->IsValid(Handle))
+        {
+            return nullptr;
+        }
+        return BufferPool->Get<BUFFER_POOL_BUFFER>(Handle);
+    }
+
     void  FCmdList::CopyBuffer(IBuffer* InDestBuffer, IBuffer* InSrcBuffer, const FCopyBufferDesc& InDesc)
     {
         auto DestBuffer = reinterpret_cast<FBuffer*>(InDestBuffer);
@@ -75,6 +154,12 @@ namespace Neko::RHI::Vulkan
         vkCmdCopyBuffer(CmdBuffer, SrcBuffer->GetBuffer(), DestBuffer->GetBuffer(), 1, &CopyRegion);
     }
 
+    void FCmdList::FillBuffer(IBuffer* InBuffer, uint64_t Offset, uint64_t Size, uint32_t Value)
+    {
+        auto Buffer = reinterpret_cast<FBuffer*>(InBuffer);
+        vkCmdFillBuffer(CmdBuffer, Buffer->GetBuffer(), Offset, Size, Value);
+    }
+
     void FCmdList::BindVertexBuffer(IBuffer* InBuffer,uint32_t Binding, uint64_t Offset)
     {
         auto Buffer = reinterpret_cast<FBuffer*>(InBuffer);
@@ -89,4 +174,46 @@ namespace Neko::RHI::Vulkan
         auto Buffer = reinterpret_cast<FBuffer*>(InBuffer);
         vkCmdBindIndexBuffer(CmdBuffer, Buffer->GetBuffer(), Offset, Type == EIndexBufferType::BIT16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
     }
+
+    void FCmdList::CopyBuffer(FBufferHandle InDestBuffer, FBufferHandle InSrcBuffer, const FCopyBufferDesc& InDesc)
+    {
+        // a stale handle records nothing
+        VkBuffer DestBuffer = Context.ResolveBuffer(InDestBuffer);
+        VkBuffer SrcBuffer = Context.ResolveBuffer(InSrcBuffer);
+        assert(DestBuffer && SrcBuffer);
+        if (!DestBuffer || !SrcBuffer)
+        {
+            return;
+        }
+
+        VkBufferCopy CopyRegion = {};
+        CopyRegion.srcOffset = InDesc.SrcOffset;
+        CopyRegion.dstOffset = InDesc.DestOffset;
+        CopyRegion.size = InDesc.Size;
+        vkCmdCopyBuffer(CmdBuffer, SrcBuffer, DestBuffer, 1, &CopyRegion);
+    }
+
+    void FCmdList::BindVertexBuffer(FBufferHandle InBuffer, uint32_t Binding, uint64_t Offset)
+    {
+        VkBuffer Buffers[] = { Context.ResolveBuffer(InBuffer) };
+        VkDeviceSize Offsets[] = { Offset };
+        assert(Buffers[0]);
+        if (!Buffers[0])
+        {
+            return;
+        }
+
+        vkCmdBindVertexBuffers(CmdBuffer, Binding, 1, Buffers, Offsets);
+    }
+
+    void FCmdList::BindIndexBuffer(FBufferHandle InBuffer, uint64_t Offset, const EIndexBufferType& Type)
+    {
+        VkBuffer Buffer = Context.ResolveBuffer(InBuffer);
+        assert(Buffer);
+        if (!Buffer)
+        {
+            return;
+        }
+        vkCmdBindIndexBuffer(CmdBuffer, Buffer, Offset, Type == EIndexBufferType::BIT16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+    }
 }
\ No newline at end of file
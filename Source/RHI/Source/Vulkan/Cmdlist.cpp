@@ -1,4 +1,5 @@
 #include "Backend.h"
+#include <bit>
 #include <cassert>
 #include <map>
 #include <vector>
@@ -7,10 +8,45 @@ namespace Neko::RHI::Vulkan
     FQueue::FQueue(const FContext &Ctx, uint32_t InQueueFamliyIndex, uint32_t QueueIndex, ECmdQueueType InCmdType) : Context(Ctx),FamilyIndex(InQueueFamliyIndex), Type(InCmdType)
     { 
         vkGetDeviceQueue(Context.Device, InQueueFamliyIndex, QueueIndex, &Queue);
+
+        VkSemaphoreTypeCreateInfo SemaphoreTypeCreateInfo = {};
+        SemaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        SemaphoreTypeCreateInfo.initialValue = 0;
+        SemaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+
+        VkSemaphoreCreateInfo SemaphoreCreateInfo = {};
+        SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        SemaphoreCreateInfo.pNext = &SemaphoreTypeCreateInfo;
+
+        VK_CHECK_THROW(vkCreateSemaphore(Context.Device, &SemaphoreCreateInfo, Context.AllocationCallbacks, &TimelineSemaphore), "Failed to create queue timeline semaphore");
     }
 
     FQueue::~FQueue()
     {
+        if (TimelineSemaphore)
+        {
+            Wait(GetSubmittedValue());
+            Context.ReleaseQueue->UnregisterQueue(this);
+            vkDestroySemaphore(Context.Device, TimelineSemaphore, Context.AllocationCallbacks);
+            TimelineSemaphore = nullptr;
+        }
+    }
+
+    uint64_t FQueue::GetCompletedValue()
+    {
+        uint64_t Value = 0;
+        vkGetSemaphoreCounterValue(Context.Device, TimelineSemaphore, &Value);
+        return Value;
+    }
+
+    void FQueue::Wait(uint64_t Value)
+    {
+        VkSemaphoreWaitInfo WaitInfo = {};
+        WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        WaitInfo.semaphoreCount = 1;
+        WaitInfo.pSemaphores = &TimelineSemaphore;
+        WaitInfo.pValues = &Value;
+        vkWaitSemaphores(Context.Device, &WaitInfo, UINT64_MAX);
     }
 
     std::vector<ICmdPoolRef> FQueue::CreateCmdPools(uint32_t Num)
@@ -45,7 +81,7 @@ namespace Neko::RHI::Vulkan
     {
         if (CmdPool)
         {
-            vkDestroyCommandPool(Context.Device, CmdPool, Context.AllocationCallbacks);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_COMMAND_POOL, (uint64_t)CmdPool);
             CmdPool = nullptr;
         }
     }
@@ -107,30 +143,62 @@ namespace Neko::RHI::Vulkan
     
     void FCmdList::BeginRenderPass(const FRenderPassDesc& InDesc)
     {
-        assert(InDesc.ColorAttachmentArray.size() > 0);
-
-        auto RTDesc = InDesc.ColorAttachmentArray[0]->GetDesc();
+        auto& DepthStencil = InDesc.DepthStencilAttachment;
+        assert(InDesc.ColorAttachmentArray.size() > 0 || DepthStencil.Attachment);
 
         static_vector<VkRenderingAttachmentInfoKHR, MAX_COLOR_ATTACHMENT_COUNT> RenderingAttachmentInfos;
         for (uint32_t i = 0; i < InDesc.ColorAttachmentArray.size(); ++i)
         {
             auto& ColorAttachment = InDesc.ColorAttachmentArray[i];
 
-            auto ColorAttachmentVK = reinterpret_cast<FColorAttachment*>(ColorAttachment.GetPtr());
+            auto ColorAttachmentVK = reinterpret_cast<FColorAttachment*>(ColorAttachment.Attachment.GetPtr());
             VkRenderingAttachmentInfoKHR RenderingAttachmentInfo = {};
             RenderingAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
             RenderingAttachmentInfo.imageView = ColorAttachmentVK->GetImageView();
             RenderingAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL_KHR;
-            RenderingAttachmentInfo.loadOp = ConvertToVkAttachmentLoadOp(ColorAttachment->GetDesc().LoadAction);
-            RenderingAttachmentInfo.storeOp = ConvertToVkAttachmentStoreOp(ColorAttachment->GetDesc().StoreAction);
+            RenderingAttachmentInfo.loadOp = ConvertToVkAttachmentLoadOp(ColorAttachment.LoadAction);
+            RenderingAttachmentInfo.storeOp = ConvertToVkAttachmentStoreOp(ColorAttachment.StoreAction);
+            RenderingAttachmentInfo.clearValue.color.float32[0] = ColorAttachment.ClearColor.R;
+            RenderingAttachmentInfo.clearValue.color.float32[1] = ColorAttachment.ClearColor.G;
+            RenderingAttachmentInfo.clearValue.color.float32[2] = ColorAttachment.ClearColor.B;
+            RenderingAttachmentInfo.clearValue.color.float32[3] = ColorAttachment.ClearColor.A;
             RenderingAttachmentInfos.push_back(RenderingAttachmentInfo);
         }
 
+        VkRenderingAttachmentInfoKHR DepthAttachmentInfo = {};
+        VkRenderingAttachmentInfoKHR StencilAttachmentInfo = {};
+        bool bDepth = false;
+        bool bStencil = false;
+        if (DepthStencil.Attachment)
+        {
+            auto DepthStencilAttachmentVK = reinterpret_cast<FDepthStencilAttachment*>(DepthStencil.Attachment.GetPtr());
+            auto& DepthStencilDesc = DepthStencilAttachmentVK->GetDesc();
+
+            bDepth = true;
+            DepthAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+            DepthAttachmentInfo.imageView = DepthStencilAttachmentVK->GetImageView();
+            DepthAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            DepthAttachmentInfo.loadOp = ConvertToVkAttachmentLoadOp(DepthStencil.DepthLoadAction);
+            DepthAttachmentInfo.storeOp = ConvertToVkAttachmentStoreOp(DepthStencil.DepthStoreAction);
+            DepthAttachmentInfo.clearValue.depthStencil.depth = DepthStencil.ClearDepth;
+            DepthAttachmentInfo.clearValue.depthStencil.stencil = DepthStencil.ClearStencil;
+
+            if (IsStencilFormat(DepthStencilDesc.Format))
+            {
+                bStencil = true;
+                StencilAttachmentInfo = DepthAttachmentInfo;
+                StencilAttachmentInfo.loadOp = ConvertToVkAttachmentLoadOp(DepthStencil.StencilLoadAction);
+                StencilAttachmentInfo.storeOp = ConvertToVkAttachmentStoreOp(DepthStencil.StencilStoreAction);
+            }
+        }
+
+        auto RenderTexture = InDesc.ColorAttachmentArray.size() > 0 ? InDesc.ColorAttachmentArray[0].Attachment->GetDesc().Texture : DepthStencil.Attachment->GetDesc().Texture;
+
         VkRect2D RenderArea;
         RenderArea.offset.x = 0;
         RenderArea.offset.y = 0;
-        RenderArea.extent.width = RTDesc.Texture->GetDesc().Width;
-        RenderArea.extent.height = RTDesc.Texture->GetDesc().Height;
+        RenderArea.extent.width = RenderTexture->GetDesc().Width;
+        RenderArea.extent.height = RenderTexture->GetDesc().Height;
 
         VkRenderingInfoKHR RenderingInfo = {};
         RenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
@@ -138,6 +206,8 @@ namespace Neko::RHI::Vulkan
         RenderingInfo.layerCount = 1; // TODO
         RenderingInfo.colorAttachmentCount = (uint32_t)RenderingAttachmentInfos.size();
         RenderingInfo.pColorAttachments = RenderingAttachmentInfos.data();
+        RenderingInfo.pDepthAttachment = bDepth ? &DepthAttachmentInfo : nullptr;
+        RenderingInfo.pStencilAttachment = bStencil ? &StencilAttachmentInfo : nullptr;
 
         vkCmdBeginRenderingKHR(CmdBuffer, &RenderingInfo);
     }
@@ -151,6 +221,63 @@ namespace Neko::RHI::Vulkan
     {
        auto GraphicPipeline = reinterpret_cast<FGraphicPipeline*>(InGraphicPipeline);
        vkCmdBindPipeline(CmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, GraphicPipeline->GetPipeline());
+       PushConstantLayout = GraphicPipeline->GetPipelineLayout();
+       PushConstantStages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+       PushConstantSize = GraphicPipeline->GetDesc().PushConstantSize;
+    }
+
+    void FCmdList::BindComputePipeline(IComputePipeline* InComputePipeline)
+    {
+        ComputePipeline = reinterpret_cast<FComputePipeline*>(InComputePipeline);
+        vkCmdBindPipeline(CmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, ComputePipeline->GetPipeline());
+        PushConstantLayout = ComputePipeline->GetPipelineLayout();
+        PushConstantStages = VK_SHADER_STAGE_COMPUTE_BIT;
+        PushConstantSize = ComputePipeline->GetDesc().PushConstantSize;
+    }
+
+    void FCmdList::BindStorageBuffer(uint32_t Binding, IBuffer* InBuffer, uint64_t Offset, uint64_t Size)
+    {
+        PushStorageBuffer(Binding, reinterpret_cast<FBuffer*>(InBuffer)->GetBuffer(), Offset, Size);
+    }
+
+    void FCmdList::BindStorageBuffer(uint32_t Binding, FBufferHandle InBuffer, uint64_t Offset, uint64_t Size)
+    {
+        VkBuffer Buffer = Context.ResolveBuffer(InBuffer);
+        assert(Buffer);
+        if (!Buffer)
+        {
+            return;
+        }
+        PushStorageBuffer(Binding, Buffer, Offset, Size);
+    }
+
+    void FCmdList::PushStorageBuffer(uint32_t Binding, VkBuffer Buffer, uint64_t Offset, uint64_t Size)
+    {
+        assert(ComputePipeline != nullptr && Binding < ComputePipeline->GetDesc().StorageBufferNum);
+
+        VkDescriptorBufferInfo BufferInfo = {};
+        BufferInfo.buffer = Buffer;
+        BufferInfo.offset = Offset;
+        BufferInfo.range = Size == UINT64_MAX ? VK_WHOLE_SIZE : Size;
+
+        VkWriteDescriptorSet Write = {};
+        Write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        Write.dstBinding = Binding;
+        Write.descriptorCount = 1;
+        Write.descriptorType = ConvertToVkDescriptorType(EResourceType::StorageBuffer);
+        Write.pBufferInfo = &BufferInfo;
+        vkCmdPushDescriptorSetKHR(CmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, ComputePipeline->GetPipelineLayout(), 0, 1, &Write);
+    }
+
+    void FCmdList::PushConstants(const void* Data, uint32_t Size)
+    {
+        assert(PushConstantLayout != nullptr && Size <= PushConstantSize);
+        vkCmdPushConstants(CmdBuffer, PushConstantLayout, PushConstantStages, 0, Size, Data);
+    }
+
+    void FCmdList::Dispatch(uint32_t GroupNumX, uint32_t GroupNumY, uint32_t GroupNumZ)
+    {
+        vkCmdDispatch(CmdBuffer, GroupNumX, GroupNumY, GroupNumZ);
     }
 
     void FCmdList::SetViewport(const FViewport& InViewport)
@@ -160,7 +287,8 @@ namespace Neko::RHI::Vulkan
 
     void FCmdList::SetViewports(const FViewport* InViewports,uint32_t ViewportNum)
     {
-        std::vector<VkViewport> Viewports(ViewportNum);
+        FScratchScope Scratch;
+        auto Viewports = Scratch.AllocateArray<VkViewport>(ViewportNum);
         for (uint32_t i = 0; i < ViewportNum; ++i)
         {
             VkViewport& Viewport = Viewports[i];
@@ -172,7 +300,7 @@ namespace Neko::RHI::Vulkan
             Viewport.maxDepth = InViewports[i].MaxDepth;
         }
        
-        vkCmdSetViewport(CmdBuffer, 0, ViewportNum, Viewports.data());
+        vkCmdSetViewport(CmdBuffer, 0, ViewportNum, Viewports);
     }
 
     void FCmdList::SetScissor(const FScissor& InScissor)
@@ -182,7 +310,8 @@ namespace Neko::RHI::Vulkan
 
     void FCmdList::SetScissors(const FScissor* InScissors, uint32_t ScissorNum)
     {
-        std::vector<VkRect2D> Scissors(ScissorNum);
+        FScratchScope Scratch;
+        auto Scissors = Scratch.AllocateArray<VkRect2D>(ScissorNum);
         for (uint32_t i = 0; i < ScissorNum; ++i)
         {
             VkRect2D& Scissor = Scissors[i];
@@ -191,7 +320,7 @@ namespace Neko::RHI::Vulkan
             Scissor.extent.width = InScissors[i].Width;
             Scissor.extent.height = InScissors[i].Height;
         }
-        vkCmdSetScissor(CmdBuffer, 0, ScissorNum, Scissors.data());
+        vkCmdSetScissor(CmdBuffer, 0, ScissorNum, Scissors);
     }
   
     void FCmdList::Draw(uint32_t VertexNum, uint32_t VertexOffset)
@@ -204,6 +333,16 @@ namespace Neko::RHI::Vulkan
         vkCmdDrawIndexed(CmdBuffer, IndexCount, 1, FirstIndex, VertexOffset, 0);
     }
 
+    void FCmdList::DrawIndexedIndirectCount(IBuffer* ArgsBuffer, uint64_t ArgsOffset, IBuffer* CountBuffer, uint64_t CountOffset, uint32_t MaxDrawNum)
+    {
+        static_assert(sizeof(FDrawIndexedIndirectArgs) == sizeof(VkDrawIndexedIndirectCommand));
+        assert(Context.Features.DrawIndirectCount);
+        vkCmdDrawIndexedIndirectCount(CmdBuffer,
+            reinterpret_cast<FBuffer*>(ArgsBuffer)->GetBuffer(), ArgsOffset,
+            reinterpret_cast<FBuffer*>(CountBuffer)->GetBuffer(), CountOffset,
+            MaxDrawNum, sizeof(FDrawIndexedIndirectArgs));
+    }
+
     void FCmdList::ResourceBarrier(const FTextureTransitionDesc& Desc)
     {
 
@@ -217,7 +356,7 @@ namespace Neko::RHI::Vulkan
         ImageMemoryBarrier.image = Texture->GetImage();
         VkImageSubresourceRange Range;
         {
-            Range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            Range.aspectMask = ConvertToVkImageAspectFlags(Texture->GetDesc().Format);
             Range.baseArrayLayer = Desc.Range.ArrayOffset;
             Range.layerCount = Desc.Range.ArraySize;
             Range.baseMipLevel = Desc.Range.MipOffset;
@@ -257,35 +396,86 @@ namespace Neko::RHI::Vulkan
         ResourceBarrier(Desc);
     }
 
-    IQueueRef FDevice::CreateQueue(const ECmdQueueType& CmdQueueType)
+    void FCmdList::ResourceBarrier(IDepthStencilAttachment* InDepthStencilAttachment, const EResourceState& Src, const EResourceState& Dest)
+    {
+        auto& DepthStencilAttachmentDesc = InDepthStencilAttachment->GetDesc();
+        auto Range = FSubResourceRange()
+            .SetArrayOffset(DepthStencilAttachmentDesc.ArrayOffset)
+            .SetArraySize(DepthStencilAttachmentDesc.ArraySize)
+            .SetMipOffset(DepthStencilAttachmentDesc.MipOffset)
+            .SetMipNum(1);
+
+        auto Desc = FTextureTransitionDesc()
+            .SetTexture(DepthStencilAttachmentDesc.Texture)
+            .SetSrcState(Src)
+            .SetDestState(Dest)
+            .SetRange(Range);
+
+        ResourceBarrier(Desc);
+    }
+
+    void FCmdList::ResourceBarrier(const FBufferBarrierDesc& Desc)
     {
-        RefCountPtr<FQueue> Queue = nullptr;
+        VkBufferMemoryBarrier BufferMemoryBarrier = {};
+        BufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        BufferMemoryBarrier.srcAccessMask = ConvertToVkAccessFlags(Desc.SrcState);
+        BufferMemoryBarrier.dstAccessMask = ConvertToVkAccessFlags(Desc.DestState);
+        BufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        BufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        BufferMemoryBarrier.buffer = reinterpret_cast<FBuffer*>(Desc.Buffer)->GetBuffer();
+        BufferMemoryBarrier.offset = Desc.Offset;
+        BufferMemoryBarrier.size = Desc.Size == UINT64_MAX ? VK_WHOLE_SIZE : Desc.Size;
 
-        auto Queues = std::move(FreeQueues);
-        for (uint32_t i = 0; i < Queues.size(); ++i)
+        vkCmdPipelineBarrier(
+            CmdBuffer,
+            ConvertToVkPipelineStageFlags(Desc.SrcState),
+            ConvertToVkPipelineStageFlags(Desc.DestState),
+            0,
+            0,
+            nullptr,
+            1,
+            &BufferMemoryBarrier,
+            0,
+            nullptr
+        );
+    }
+
+    IQueueRef FDevice::CreateQueue(const ECmdQueueType& CmdQueueType)
+    {
+        // pick the most specialized free queue, so compute and transfer work lands on dedicated families
+        int32_t BestIndex = -1;
+        int32_t BestExtraCapabilities = INT32_MAX;
+        for (uint32_t i = 0; i < FreeQueues.size(); ++i)
         {
-            if (Queues[i]->IsMatch(CmdQueueType) && !Queue)
+            if (!FreeQueues[i]->IsMatch(CmdQueueType))
             {
-                Queue = Queues[i];
-                UsedQueues.push_back(Queues[i]);
+                continue;
             }
-            else
+            int32_t ExtraCapabilities = std::popcount((uint32_t)(FreeQueues[i]->GetCmdQueueType() & ~CmdQueueType));
+            if (ExtraCapabilities < BestExtraCapabilities)
             {
-                FreeQueues.push_back(Queues[i]);
+                BestIndex = (int32_t)i;
+                BestExtraCapabilities = ExtraCapabilities;
             }
         }
-        if (!Queue)
+        if (BestIndex < 0)
         {
             throw OS::FOSException("Failed to find queue");
         }
+
+        auto Queue = FreeQueues[BestIndex];
+        FreeQueues.erase(FreeQueues.begin() + BestIndex);
+        Context.ReleaseQueue->RegisterQueue(Queue.GetPtr());
+        UsedQueues.push_back(Queue);
         return Queue;
     }
     
-    void FQueue::ExcuteCmdLists(ICmdList** CmdLists, uint32_t CmdListNum, const FExcuteDesc& Desc)
+    uint64_t FQueue::ExcuteCmdLists(ICmdList** CmdLists, uint32_t CmdListNum, const FExcuteDesc& Desc)
     {
        assert(CmdListNum > 0);
 
-       std::vector<VkCommandBuffer> CmdBufs;
+       FScratchScope Scratch;
+       TArenaVector<VkCommandBuffer> CmdBufs(Scratch);
        CmdBufs.reserve(CmdListNum);
        for (uint32_t i = 0; i < CmdListNum; ++i)
        {
@@ -296,8 +486,11 @@ namespace Neko::RHI::Vulkan
            }
        }
 
-       std::vector<VkSemaphore> SignalSemaphores;
-       std::vector<uint64_t> SignalSemaphoreValues;
+       // sized up front, the timeline semaphore is appended last
+       TArenaVector<VkSemaphore> SignalSemaphores(Scratch);
+       TArenaVector<uint64_t> SignalSemaphoreValues(Scratch);
+       SignalSemaphores.reserve(Desc.SignalSemaphoreArray.size() + 1);
+       SignalSemaphoreValues.reserve(Desc.SignalSemaphoreArray.size() + 1);
 
        for (uint32_t i = 0; i < Desc.SignalSemaphoreArray.size(); ++i)
        {
@@ -306,8 +499,10 @@ namespace Neko::RHI::Vulkan
            SignalSemaphoreValues.push_back(Semaphore->GetCounter());
        }
 
-       std::vector<VkSemaphore> WaitSemaphores;
-       std::vector<uint64_t> WaitSemaphoreValues;
+       TArenaVector<VkSemaphore> WaitSemaphores(Scratch);
+       TArenaVector<uint64_t> WaitSemaphoreValues(Scratch);
+       WaitSemaphores.reserve(Desc.WaitSemaphoreArray.size() + Desc.QueueWaitArray.size());
+       WaitSemaphoreValues.reserve(Desc.WaitSemaphoreArray.size() + Desc.QueueWaitArray.size());
 
        for (uint32_t i = 0; i < Desc.WaitSemaphoreArray.size(); ++i)
        {
@@ -316,15 +511,32 @@ namespace Neko::RHI::Vulkan
            WaitSemaphoreValues.push_back(Semaphore->GetCounter());
        }
 
-       std::vector<VkPipelineStageFlags> WaitDstStageMasks;
-       WaitDstStageMasks.reserve(Desc.WaitSemaphoreArray.size());
+       TArenaVector<VkPipelineStageFlags> WaitDstStageMasks(Scratch);
+       WaitDstStageMasks.reserve(Desc.WaitSemaphoreArray.size() + Desc.QueueWaitArray.size());
        for (uint32_t i = 0; i < Desc.WaitSemaphoreArray.size(); ++i)
        {
            WaitDstStageMasks.push_back(VkPipelineStageFlagBits::VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
        }
 
+       for (uint32_t i = 0; i < Desc.QueueWaitArray.size(); ++i)
+       {
+           auto& QueueWait = Desc.QueueWaitArray[i];
+           auto WaitQueue = reinterpret_cast<FQueue*>(QueueWait.Queue);
+           assert(WaitQueue != nullptr && WaitQueue != this);
+           WaitSemaphores.push_back(WaitQueue->GetTimelineSemaphore());
+           WaitSemaphoreValues.push_back(QueueWait.Value);
+           WaitDstStageMasks.push_back(VkPipelineStageFlagBits::VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+       }
+
        auto Fence = reinterpret_cast<FFence*>(Desc.Fence);
 
+       std::lock_guard Guard(SubmitMutex);
+
+       // every submission advances the queue timeline, deferred releases are stamped with it
+       uint64_t TimelineValue = SubmittedValue.load(std::memory_order_relaxed) + 1;
+       SignalSemaphores.push_back(TimelineSemaphore);
+       SignalSemaphoreValues.push_back(TimelineValue);
+
        VkTimelineSemaphoreSubmitInfo TimelineSemaphoreSubmitInfo = {};
        TimelineSemaphoreSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
        TimelineSemaphoreSubmitInfo.signalSemaphoreValueCount = (uint32_t)SignalSemaphoreValues.size();
@@ -343,12 +555,16 @@ namespace Neko::RHI::Vulkan
        SubmitInfo.commandBufferCount = (uint32_t)CmdBufs.size();
        SubmitInfo.pCommandBuffers = CmdBufs.data();
 
-       vkQueueSubmit(Queue, 1, &SubmitInfo, Fence->GetFence());
+       VK_CHECK_THROW(vkQueueSubmit(Queue, 1, &SubmitInfo, Fence ? Fence->GetFence() : VK_NULL_HANDLE), "Failed to submit command lists");
+       SubmittedValue.store(TimelineValue, std::memory_order_release);
+
+       Context.ReleaseQueue->Collect();
+       return TimelineValue;
     }
 
-    void FQueue::ExcuteCmdList(ICmdList* CmdList, const FExcuteDesc& Desc)
+    uint64_t FQueue::ExcuteCmdList(ICmdList* CmdList, const FExcuteDesc& Desc)
     {
         ICmdList* CmdLists[1] = {CmdList};
-        ExcuteCmdLists(CmdLists, 1, Desc);
+        return ExcuteCmdLists(CmdLists, 1, Desc);
     }
 }
\ No newline at end of file
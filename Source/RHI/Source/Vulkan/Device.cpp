@@ -1,5 +1,7 @@
 #include "Backend.h"
+#include <bit>
 #include <cassert>
+#include <cstring>
 #include <map>
 #include <vector>
 #define VMA_IMPLEMENTATION
@@ -13,6 +15,22 @@ namespace Neko::RHI
     {
         FContext::~FContext()
         {
+            if (ReleaseQueue)
+            {
+                // buffer handles nobody destroyed
+                if (BufferPool)
+                {
+                    BufferPool->ForEach([this](FBufferHandle Handle)
+                    {
+                        UntrackAllocation(BufferPool->Get<BUFFER_POOL_CATEGORY>(Handle), BufferPool->Get<BUFFER_POOL_ALLOCATION_SIZE>(Handle));
+                        ReleaseQueue->Release(VK_OBJECT_TYPE_BUFFER, (uint64_t)BufferPool->Get<BUFFER_POOL_BUFFER>(Handle), BufferPool->Get<BUFFER_POOL_ALLOCATION>(Handle));
+                    });
+                    BufferPool = nullptr;
+                }
+                vkDeviceWaitIdle(Device);
+                ReleaseQueue->Flush();
+                ReleaseQueue = nullptr;
+            }
             if (Allocator)
             {
                 vmaDestroyAllocator(Allocator);
@@ -29,6 +47,43 @@ namespace Neko::RHI
             }
         }
 
+        // graphic and compute families always support transfer, even when they don't report it
+        static ECmdQueueType GetQueueFamilyType(VkQueueFlags QueueFlags)
+        {
+            ECmdQueueType QueueType = ECmdQueueType::Undefined;
+            if (QueueFlags & VkQueueFlagBits::VK_QUEUE_GRAPHICS_BIT)
+            {
+                QueueType = QueueType | ECmdQueueType::Graphic | ECmdQueueType::Transfer;
+            }
+            if (QueueFlags & VkQueueFlagBits::VK_QUEUE_COMPUTE_BIT)
+            {
+                QueueType = QueueType | ECmdQueueType::Compute | ECmdQueueType::Transfer;
+            }
+            if (QueueFlags & VkQueueFlagBits::VK_QUEUE_TRANSFER_BIT)
+            {
+                QueueType = QueueType | ECmdQueueType::Transfer;
+            }
+            return QueueType;
+        }
+
+        static bool HasExtension(VkPhysicalDevice PhysicalDevice, const char* ExtensionName)
+        {
+            uint32_t ExtensionPropertiesCount = 0;
+            std::vector<VkExtensionProperties> ExtensionProperties;
+            vkEnumerateDeviceExtensionProperties(PhysicalDevice, nullptr, &ExtensionPropertiesCount, nullptr);
+            ExtensionProperties.resize(ExtensionPropertiesCount);
+            vkEnumerateDeviceExtensionProperties(PhysicalDevice, nullptr, &ExtensionPropertiesCount, ExtensionProperties.data());
+
+            for (auto& ExtensionProperty : ExtensionProperties)
+            {
+                if (strcmp(ExtensionProperty.extensionName, ExtensionName) == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
         FDevice::FDevice()
         {
         }
@@ -101,11 +156,15 @@ namespace Neko::RHI
                 bFound = true;
                 bFound = bFound && Vulkan12Features.timelineSemaphore;
                 bFound = bFound && Vulkan13Features.dynamicRendering;
+                bFound = bFound && (!desc.Features.Swapchain || HasExtension(PhysicalDevice, VK_KHR_SWAPCHAIN_EXTENSION_NAME));
+                bFound = bFound && (!desc.Features.Compute || HasExtension(PhysicalDevice, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME));
+                bFound = bFound && (!desc.Features.DrawIndirectCount || Vulkan12Features.drawIndirectCount);
                 if (bFound)
                 {
                     Context.PhysicalDevice = PhysicalDevice;
                     Context.PhyDeviceProperties = PhyDeviceProperties;
                     Context.PhyDeviceMemoryProperties = PhyDeviceMemoryProperties;
+                    Context.Features = desc.Features;
                     break;
                 }
             }
@@ -126,28 +185,70 @@ namespace Neko::RHI
             }
             vkGetPhysicalDeviceQueueFamilyProperties2(Context.PhysicalDevice, &QueueFamilyCount, QueueFamilyProperties.data());
 
-            uint32_t QueueFamilyIndex = 0;
-            std::vector<VkDeviceQueueCreateInfo> QueueCreateInfos = {};
-            std::vector<std::vector<float>> PrioritiesArray = {};
+            std::vector<ECmdQueueType> QueueFamilyTypes;
             for (auto& QueueFamilyProperty : QueueFamilyProperties)
             {
-                auto QueueCount = QueueFamilyProperty.queueFamilyProperties.queueCount;
-                std::vector<float>& Priorities = PrioritiesArray.emplace_back();
-                Priorities.resize(QueueCount);
-                for (uint32_t i = 0; i < QueueCount; ++i)
+                QueueFamilyTypes.push_back(GetQueueFamilyType(QueueFamilyProperty.queueFamilyProperties.queueFlags));
+            }
+
+            auto QueueRequests = desc.QueueRequestArray;
+            if (QueueRequests.empty())
+            {
+                QueueRequests.push_back(FQueueRequest());
+            }
+
+            // assign every request to the family with the fewest capabilities beyond the requested ones
+            struct FQueueAssignment
+            {
+                uint32_t FamilyIndex;
+                uint32_t QueueIndex;
+            };
+            std::vector<FQueueAssignment> QueueAssignments;
+            std::vector<std::vector<float>> PrioritiesArray(QueueFamilyCount);
+            for (auto& QueueRequest : QueueRequests)
+            {
+                uint32_t BestFamilyIndex = UINT32_MAX;
+                int32_t BestExtraCapabilities = INT32_MAX;
+                for (uint32_t i = 0; i < QueueFamilyCount; ++i)
+                {
+                    bool bMatch = (QueueFamilyTypes[i] & QueueRequest.Type) == QueueRequest.Type;
+                    bool bFree = PrioritiesArray[i].size() < QueueFamilyProperties[i].queueFamilyProperties.queueCount;
+                    if (!bMatch || !bFree)
+                    {
+                        continue;
+                    }
+                    int32_t ExtraCapabilities = std::popcount((uint32_t)(QueueFamilyTypes[i] & ~QueueRequest.Type));
+                    if (ExtraCapabilities < BestExtraCapabilities)
+                    {
+                        BestFamilyIndex = i;
+                        BestExtraCapabilities = ExtraCapabilities;
+                    }
+                }
+                if (BestFamilyIndex == UINT32_MAX)
                 {
-                    Priorities[i] = 1.0f;
+                    throw OS::FOSException("Failed to find a queue family for the requested queue");
+                }
+
+                QueueAssignments.push_back({ BestFamilyIndex, (uint32_t)PrioritiesArray[BestFamilyIndex].size() });
+                PrioritiesArray[BestFamilyIndex].push_back(QueueRequest.Priority);
+            }
+
+            std::vector<VkDeviceQueueCreateInfo> QueueCreateInfos = {};
+            for (uint32_t i = 0; i < QueueFamilyCount; ++i)
+            {
+                if (PrioritiesArray[i].empty())
+                {
+                    continue;
                 }
-                    
                 VkDeviceQueueCreateInfo QueueCreateInfo = {};
                 QueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
                 QueueCreateInfo.pNext = nullptr;
                 QueueCreateInfo.flags = 0;
-                QueueCreateInfo.queueFamilyIndex = QueueFamilyIndex;
-                QueueCreateInfo.queueCount = QueueFamilyProperty.queueFamilyProperties.queueCount;
-                QueueCreateInfo.pQueuePriorities = Priorities.data();
+                QueueCreateInfo.queueFamilyIndex = i;
+                QueueCreateInfo.queueCount = (uint32_t)PrioritiesArray[i].size();
+                QueueCreateInfo.pQueuePriorities = PrioritiesArray[i].data();
                 QueueCreateInfos.push_back(QueueCreateInfo);
-                QueueFamilyIndex++;
+                Context.QueueFamilyIndices.push_back(i);
             }
             
             // gather extensions
@@ -161,6 +262,29 @@ namespace Neko::RHI
             {
                 Extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
             }
+            if (desc.Features.Compute)
+            {
+                // compute pipelines bind their buffers without descriptor pools
+                Extensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+            }
+            Vulkan12Features.drawIndirectCount = desc.Features.DrawIndirectCount;
+            // optional
+            {
+                uint32_t ExtensionPropertiesCount = 0;
+                std::vector<VkExtensionProperties> ExtensionProperties;
+                vkEnumerateDeviceExtensionProperties(Context.PhysicalDevice, nullptr, &ExtensionPropertiesCount, nullptr);
+                ExtensionProperties.resize(ExtensionPropertiesCount);
+                vkEnumerateDeviceExtensionProperties(Context.PhysicalDevice, nullptr, &ExtensionPropertiesCount, ExtensionProperties.data());
+
+                for (auto& ExtensionProperty : ExtensionProperties)
+                {
+                    if (strcmp(ExtensionProperty.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+                    {
+                        Context.bMemoryBudget = true;
+                        Extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+                    }
+                }
+            }
 
             Context.DeviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
             Context.DeviceInfo.pNext = &Vulkan12Features;
@@ -175,29 +299,12 @@ namespace Neko::RHI
 
             VK_CHECK_THROW(vkCreateDevice(Context.PhysicalDevice, &Context.DeviceInfo, nullptr, &Context.Device), "failed to create device");
 
-            QueueFamilyIndex = 0;
-            for (auto& QueueFamilyProperty : QueueFamilyProperties)
-            {
-                ECmdQueueType QueueType = ECmdQueueType::Undefined;
-                if (QueueFamilyProperty.queueFamilyProperties.queueFlags & VkQueueFlagBits::VK_QUEUE_GRAPHICS_BIT)
-                {
-                    QueueType = QueueType | ECmdQueueType::Graphic;
-                }
-                if (QueueFamilyProperty.queueFamilyProperties.queueFlags & VkQueueFlagBits::VK_QUEUE_COMPUTE_BIT)
-                {
-                    QueueType = QueueType | ECmdQueueType::Compute;
-                }
-                if (QueueFamilyProperty.queueFamilyProperties.queueFlags & VkQueueFlagBits::VK_QUEUE_TRANSFER_BIT)
-                {
-                    QueueType = QueueType | ECmdQueueType::Transfer;
-                }
-
-                for (uint32_t QueueIndex = 0; QueueIndex < (uint32_t)QueueFamilyProperty.queueFamilyProperties.queueCount; ++QueueIndex)
-                {
-                    FreeQueues.push_back(new FQueue(Context, QueueFamilyIndex, QueueIndex, QueueType));
-                }
+            Context.ReleaseQueue = std::make_unique<FDeferredReleaseQueue>(Context);
+            Context.BufferPool = std::make_unique<FBufferPool>(desc.MaxBufferHandleNum);
 
-                QueueFamilyIndex++;
+            for (auto& QueueAssignment : QueueAssignments)
+            {
+                FreeQueues.push_back(new FQueue(Context, QueueAssignment.FamilyIndex, QueueAssignment.QueueIndex, QueueFamilyTypes[QueueAssignment.FamilyIndex]));
             }
 
             VmaVulkanFunctions VulkanFunctions = {};
@@ -210,6 +317,7 @@ namespace Neko::RHI
             AllocatorCreateInfo.device = Context.Device;
             AllocatorCreateInfo.instance = Context.Instance;
             AllocatorCreateInfo.pVulkanFunctions = &VulkanFunctions;
+            AllocatorCreateInfo.flags = Context.bMemoryBudget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0;
 
            
             vmaCreateAllocator(&AllocatorCreateInfo, &Context.Allocator);
@@ -219,6 +327,13 @@ namespace Neko::RHI
 
         bool FDevice::IsCmdQueueValid(const ECmdQueueType& CmdQueueType)
         {
+            for (auto& Queue : FreeQueues)
+            {
+                if (Queue->IsMatch(CmdQueueType))
+                {
+                    return true;
+                }
+            }
             return false;
         }
 
@@ -232,6 +347,11 @@ namespace Neko::RHI
             FGPUInfo Ret = { Context.PhyDeviceProperties.properties.deviceName };
             return Ret;
         }
+
+        FFeatures FDevice::GetFeatures()
+        {
+            return Context.Features;
+        }
     }
 
     bool GRHIInitalize = false;
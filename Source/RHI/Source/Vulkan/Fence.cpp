@@ -14,7 +14,7 @@ namespace Neko::RHI::Vulkan
     {
         if (Fence)
         {
-            vkDestroyFence(Context.Device, Fence, Context.AllocationCallbacks);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_FENCE, (uint64_t)Fence);
             Fence = nullptr;
         }
     }
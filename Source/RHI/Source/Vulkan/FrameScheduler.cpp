@@ -0,0 +1,148 @@
+#include "Backend.h"
+#include <cassert>
+namespace Neko::RHI::Vulkan
+{
+    FFrameScheduler::FFrameScheduler(const FContext& Ctx, const FFrameSchedulerDesc& InDesc) : Context(Ctx), Desc(InDesc)
+    {
+        assert(Desc.Queue != nullptr);
+        assert(Desc.FramesInFlight > 0);
+
+        Queue = reinterpret_cast<FQueue*>(Desc.Queue);
+        Swapchain = Desc.Swapchain;
+        Timeline = new FSemaphore(Context, ESemaphoreType::Timeline);
+
+        auto UploadBufferDesc = FBufferDesc()
+            .SetSize(Desc.UploadRingSize)
+            .SetBufferUsage(EBufferUsage::HostAccess | EBufferUsage::TransferSrc | EBufferUsage::VertexBuffer | EBufferUsage::IndexBuffer)
+            .SetCategory(EResourceCategory::Upload);
+
+        Frames.resize(Desc.FramesInFlight);
+        for (auto& Frame : Frames)
+        {
+            Frame.CmdPool = Queue->CreateCmdPool();
+            Frame.Arena = std::make_unique<FLinearArena>(Desc.FrameArenaSize);
+            if (Desc.UploadRingSize > 0)
+            {
+                Frame.UploadBuffer = new FBuffer(Context, UploadBufferDesc);
+                // mapped for the lifetime of the scheduler
+                Frame.UploadData = Frame.UploadBuffer->Map(0, Desc.UploadRingSize);
+            }
+            if (Swapchain)
+            {
+                Frame.AcquireSemaphore = new FSemaphore(Context, ESemaphoreType::Binary);
+            }
+        }
+    }
+
+    FFrameScheduler::~FFrameScheduler()
+    {
+        for (auto& Frame : Frames)
+        {
+            if (Frame.UploadBuffer)
+            {
+                Frame.UploadBuffer->Unmap();
+            }
+        }
+    }
+
+    bool FFrameScheduler::BeginFrame()
+    {
+        FrameIndex = (uint32_t)(FrameNumber % Frames.size());
+        auto& Frame = Frames[FrameIndex];
+
+        Timeline->Wait(Frame.TimelineValue);
+
+        Frame.CmdPool->Free();
+        Frame.UploadOffset = 0;
+        Frame.Arena->Reset();
+
+        if (Swapchain)
+        {
+            SwapchainIndex = Swapchain->AcquireNext(Frame.AcquireSemaphore, nullptr);
+            if (SwapchainIndex == SWAPCHAIN_INVALID_INDEX)
+            {
+                return false;
+            }
+
+            if (PresentSemaphores.size() <= SwapchainIndex)
+            {
+                PresentSemaphores.resize(SwapchainIndex + 1);
+            }
+            if (!PresentSemaphores[SwapchainIndex])
+            {
+                PresentSemaphores[SwapchainIndex] = new FSemaphore(Context, ESemaphoreType::Binary);
+            }
+        }
+        return true;
+    }
+
+    void FFrameScheduler::EndFrame(ICmdList** CmdLists, uint32_t CmdListNum)
+    {
+        auto& Frame = Frames[FrameIndex];
+
+        Frame.TimelineValue = Timeline->GetCounter() + 1;
+        Timeline->SetCounter(Frame.TimelineValue);
+
+        auto ExcuteDesc = FExcuteDesc().AddSignalSemaphore(Timeline);
+        if (Swapchain)
+        {
+            ExcuteDesc.AddWaitSemaphore(Frame.AcquireSemaphore);
+            ExcuteDesc.AddSignalSemaphore(PresentSemaphores[SwapchainIndex]);
+        }
+        Queue->ExcuteCmdLists(CmdLists, CmdListNum, ExcuteDesc);
+
+        if (Swapchain)
+        {
+            auto PresentDesc = FPresentDesc()
+                .AddWaitSemaphore(PresentSemaphores[SwapchainIndex])
+                .SetQueue(Queue)
+                .SetPresentIndex(SwapchainIndex);
+            Swapchain->Present(PresentDesc);
+        }
+
+        FrameNumber++;
+    }
+
+    ICmdListRef FFrameScheduler::CreateCmdList()
+    {
+        return Frames[FrameIndex].CmdPool->CreateCmdList();
+    }
+
+    FUploadAllocation FFrameScheduler::AllocateUpload(uint64_t Size, uint64_t Alignment)
+    {
+        assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0);
+
+        auto& Frame = Frames[FrameIndex];
+        uint64_t Offset = (Frame.UploadOffset + Alignment - 1) & ~(Alignment - 1);
+        if (!Frame.UploadBuffer || Offset + Size > Desc.UploadRingSize)
+        {
+            return {};
+        }
+        Frame.UploadOffset = Offset + Size;
+
+        FUploadAllocation Allocation;
+        Allocation.Buffer = Frame.UploadBuffer;
+        Allocation.Offset = Offset;
+        Allocation.Data = Frame.UploadData + Offset;
+        return Allocation;
+    }
+
+    ITextureRef FFrameScheduler::GetSwapchainTexture()
+    {
+        if (!Swapchain || SwapchainIndex == SWAPCHAIN_INVALID_INDEX)
+        {
+            return nullptr;
+        }
+        return Swapchain->GetTexture(SwapchainIndex);
+    }
+
+    void FFrameScheduler::WaitIdle()
+    {
+        Timeline->Wait(Timeline->GetCounter());
+    }
+
+    IFrameSchedulerRef FDevice::CreateFrameScheduler(const FFrameSchedulerDesc& Desc)
+    {
+        return new FFrameScheduler(Context, Desc);
+    }
+}
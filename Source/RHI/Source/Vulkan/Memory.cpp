@@ -0,0 +1,83 @@
+#include "Backend.h"
+#include <algorithm>
+namespace Neko::RHI::Vulkan
+{
+    void FContext::TrackAllocation(const EResourceCategory& Category, uint64_t Bytes) const
+    {
+        auto& Counter = MemoryCategoryCounters[(size_t)Category];
+        Counter.Bytes.fetch_add(Bytes, std::memory_order_relaxed);
+        Counter.AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void FContext::UntrackAllocation(const EResourceCategory& Category, uint64_t Bytes) const
+    {
+        auto& Counter = MemoryCategoryCounters[(size_t)Category];
+        Counter.Bytes.fetch_sub(Bytes, std::memory_order_relaxed);
+        Counter.AllocationCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 1 - largest free range / all free bytes, a single free range means no fragmentation
+    static float CalculateFragmentation(const VmaDetailedStatistics& Stats)
+    {
+        uint64_t UnusedBytes = Stats.statistics.blockBytes - Stats.statistics.allocationBytes;
+        if (UnusedBytes == 0 || Stats.unusedRangeCount == 0)
+        {
+            return 0.0f;
+        }
+        return 1.0f - (float)((double)Stats.unusedRangeSizeMax / (double)UnusedBytes);
+    }
+
+    FMemoryStats FDevice::GetMemoryStats()
+    {
+        FMemoryStats Stats;
+        Stats.bBudgetSupported = Context.bMemoryBudget;
+
+        const VkPhysicalDeviceMemoryProperties* MemoryProperties = nullptr;
+        vmaGetMemoryProperties(Context.Allocator, &MemoryProperties);
+
+        VmaBudget Budgets[VK_MAX_MEMORY_HEAPS] = {};
+        vmaGetHeapBudgets(Context.Allocator, Budgets);
+
+        VmaTotalStatistics TotalStatistics = {};
+        vmaCalculateStatistics(Context.Allocator, &TotalStatistics);
+
+        uint32_t HeapCount = std::min(MemoryProperties->memoryHeapCount, MAX_MEMORY_HEAP_COUNT);
+        for (uint32_t i = 0; i < HeapCount; ++i)
+        {
+            const auto& HeapStatistics = TotalStatistics.memoryHeap[i];
+
+            FMemoryHeapStats HeapStats;
+            HeapStats.Size = MemoryProperties->memoryHeaps[i].size;
+            HeapStats.Budget = Budgets[i].budget;
+            HeapStats.Usage = Budgets[i].usage;
+            HeapStats.BlockBytes = HeapStatistics.statistics.blockBytes;
+            HeapStats.AllocationBytes = HeapStatistics.statistics.allocationBytes;
+            HeapStats.BlockCount = HeapStatistics.statistics.blockCount;
+            HeapStats.AllocationCount = HeapStatistics.statistics.allocationCount;
+            HeapStats.Fragmentation = CalculateFragmentation(HeapStatistics);
+            HeapStats.bDeviceLocal = (MemoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+            Stats.Heaps.push_back(HeapStats);
+        }
+
+        Stats.BlockBytes = TotalStatistics.total.statistics.blockBytes;
+        Stats.AllocationBytes = TotalStatistics.total.statistics.allocationBytes;
+        Stats.AllocationCount = TotalStatistics.total.statistics.allocationCount;
+        Stats.Fragmentation = CalculateFragmentation(TotalStatistics.total);
+
+        for (size_t i = 0; i < Stats.Categories.size(); ++i)
+        {
+            Stats.Categories[i].Bytes = Context.MemoryCategoryCounters[i].Bytes.load(std::memory_order_relaxed);
+            Stats.Categories[i].AllocationCount = Context.MemoryCategoryCounters[i].AllocationCount.load(std::memory_order_relaxed);
+        }
+        return Stats;
+    }
+
+    std::string FDevice::BuildMemoryStatsString(bool bDetailed)
+    {
+        char* StatsString = nullptr;
+        vmaBuildStatsString(Context.Allocator, &StatsString, bDetailed ? VK_TRUE : VK_FALSE);
+        std::string Ret = StatsString ? StatsString : "";
+        vmaFreeStatsString(Context.Allocator, StatsString);
+        return Ret;
+    }
+}
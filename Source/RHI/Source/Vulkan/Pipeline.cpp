@@ -10,19 +10,20 @@ namespace Neko::RHI::Vulkan
 	{
 		if (PipelineLayout)
 		{
-			vkDestroyPipelineLayout(Context.Device, PipelineLayout, Context.AllocationCallbacks);
+			Context.ReleaseQueue->Release(VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)PipelineLayout);
 			PipelineLayout = nullptr;
 		}
 
 		if (Pipeline)
 		{
-			vkDestroyPipeline(Context.Device, Pipeline, Context.AllocationCallbacks);
+			Context.ReleaseQueue->Release(VK_OBJECT_TYPE_PIPELINE, (uint64_t)Pipeline);
 			Pipeline = nullptr;
 		}
 	}
 
 	bool FGraphicPipeline::Initalize()
 	{
+		assert(Desc.PushConstantSize <= 128);
 
 		uint32_t ColorAttachmentDescCount = (uint32_t)Desc.ColorAttachmentDescArray.size();
 		static_vector<VkPipelineShaderStageCreateInfo, MAX_SHADER_STAGE_COUNT> ShaderStages;
@@ -135,7 +136,7 @@ namespace Neko::RHI::Vulkan
 		DepthStencilState.flags = 0;
 		DepthStencilState.depthBoundsTestEnable = VK_FALSE;
 		DepthStencilState.minDepthBounds = 0.0f;
-		DepthStencilState.minDepthBounds = 1.0f;
+		DepthStencilState.maxDepthBounds = 1.0f;
 		DepthStencilState.stencilTestEnable = Desc.DepthStencilState.StencilTest;
 		DepthStencilState.front = FrontStencilOpSate;
 		DepthStencilState.back = BackStencilOpSate;
@@ -176,12 +177,17 @@ namespace Neko::RHI::Vulkan
 			DescriptorSetLayouts.push_back(BindingLayout->GetDescriptorSetLayout());
 		}
 
+		VkPushConstantRange PushConstantRange = {};
+		PushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		PushConstantRange.offset = 0;
+		PushConstantRange.size = Desc.PushConstantSize;
+
 		VkPipelineLayoutCreateInfo PipelineLayoutInfo = {};
 		PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		PipelineLayoutInfo.setLayoutCount = (uint32_t)Desc.BindingLayoutArray.size();
 		PipelineLayoutInfo.pSetLayouts = Desc.BindingLayoutArray.size() > 0 ? DescriptorSetLayouts.data() : nullptr; // Optional
-		PipelineLayoutInfo.pushConstantRangeCount = 0;
-		PipelineLayoutInfo.pPushConstantRanges = nullptr;
+		PipelineLayoutInfo.pushConstantRangeCount = Desc.PushConstantSize > 0 ? 1 : 0;
+		PipelineLayoutInfo.pPushConstantRanges = Desc.PushConstantSize > 0 ? &PushConstantRange : nullptr;
 		
 		vkCreatePipelineLayout(Context.Device, &PipelineLayoutInfo, Context.AllocationCallbacks, &PipelineLayout);
 
@@ -207,6 +213,8 @@ namespace Neko::RHI::Vulkan
 		PipelineRenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
 		PipelineRenderingCreateInfo.colorAttachmentCount = ColorAttachmentDescCount;
 		PipelineRenderingCreateInfo.pColorAttachmentFormats = ColorAttachmentFormats.data();
+		PipelineRenderingCreateInfo.depthAttachmentFormat = IsDepthFormat(Desc.DepthStencilFormat) ? ConvertToVkFormat(Desc.DepthStencilFormat) : VK_FORMAT_UNDEFINED;
+		PipelineRenderingCreateInfo.stencilAttachmentFormat = IsStencilFormat(Desc.DepthStencilFormat) ? ConvertToVkFormat(Desc.DepthStencilFormat) : VK_FORMAT_UNDEFINED;
 		
 
 		VkGraphicsPipelineCreateInfo PipelineInfo = {};
@@ -242,4 +250,95 @@ namespace Neko::RHI::Vulkan
 		}
 		return Pipeline;
 	}
-}
+
+	FComputePipeline::FComputePipeline(const FContext &ctx, const FComputePipelineDesc &Desc) : Context(ctx), Desc(Desc)
+	{
+	}
+
+	FComputePipeline::~FComputePipeline()
+	{
+		if (Pipeline)
+		{
+			Context.ReleaseQueue->Release(VK_OBJECT_TYPE_PIPELINE, (uint64_t)Pipeline);
+			Pipeline = nullptr;
+		}
+
+		if (PipelineLayout)
+		{
+			Context.ReleaseQueue->Release(VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)PipelineLayout);
+			PipelineLayout = nullptr;
+		}
+
+		if (DescriptorSetLayout)
+		{
+			Context.ReleaseQueue->Release(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)DescriptorSetLayout);
+			DescriptorSetLayout = nullptr;
+		}
+	}
+
+	bool FComputePipeline::Initalize()
+	{
+		assert(Desc.ComputeShader.IsValid());
+		assert(Desc.PushConstantSize <= 128);
+
+		// a push descriptor set, buffers are written into the command buffer by BindStorageBuffer
+		FScratchScope Scratch;
+		TArenaVector<VkDescriptorSetLayoutBinding> LayoutBindings(Desc.StorageBufferNum, Scratch);
+		for (uint32_t i = 0; i < Desc.StorageBufferNum; ++i)
+		{
+			LayoutBindings[i].binding = i;
+			LayoutBindings[i].descriptorType = ConvertToVkDescriptorType(EResourceType::StorageBuffer);
+			LayoutBindings[i].descriptorCount = 1;
+			LayoutBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		VkDescriptorSetLayoutCreateInfo LayoutInfo = {};
+		LayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		LayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+		LayoutInfo.bindingCount = (uint32_t)LayoutBindings.size();
+		LayoutInfo.pBindings = LayoutBindings.data();
+		VK_CHECK_THROW(vkCreateDescriptorSetLayout(Context.Device, &LayoutInfo, Context.AllocationCallbacks, &DescriptorSetLayout), "failed to create compute descriptor set layout");
+
+		VkPushConstantRange PushConstantRange = {};
+		PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		PushConstantRange.offset = 0;
+		PushConstantRange.size = Desc.PushConstantSize;
+
+		VkPipelineLayoutCreateInfo PipelineLayoutInfo = {};
+		PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		PipelineLayoutInfo.setLayoutCount = 1;
+		PipelineLayoutInfo.pSetLayouts = &DescriptorSetLayout;
+		PipelineLayoutInfo.pushConstantRangeCount = Desc.PushConstantSize > 0 ? 1 : 0;
+		PipelineLayoutInfo.pPushConstantRanges = Desc.PushConstantSize > 0 ? &PushConstantRange : nullptr;
+		VK_CHECK_THROW(vkCreatePipelineLayout(Context.Device, &PipelineLayoutInfo, Context.AllocationCallbacks, &PipelineLayout), "failed to create compute pipeline layout");
+
+		auto& Shader = Desc.ComputeShader;
+		VkComputePipelineCreateInfo PipelineInfo = {};
+		PipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		PipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		PipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		PipelineInfo.stage.module = reinterpret_cast<FShader *>(Shader.GetPtr())->GetVkShaderModule();
+		PipelineInfo.stage.pName = Shader->GetDesc().EntryPoint;
+		PipelineInfo.layout = PipelineLayout;
+		PipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		PipelineInfo.basePipelineIndex = -1;
+
+		VK_CHECK_THROW(vkCreateComputePipelines(Context.Device, VK_NULL_HANDLE, 1, &PipelineInfo, Context.AllocationCallbacks, &Pipeline), "failed to create compute pipeline");
+
+		return true;
+	}
+
+	IComputePipelineRef FDevice::CreateComputePipeline(const FComputePipelineDesc &pipelineDesc)
+	{
+		if (!Context.Features.Compute)
+		{
+			return nullptr;
+		}
+		auto Pipeline = RefCountPtr<FComputePipeline>(new FComputePipeline(Context, pipelineDesc));
+		if (!Pipeline->Initalize())
+		{
+			Pipeline = nullptr;
+		}
+		return Pipeline;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "Backend.h"
+#include <cassert>
+namespace Neko::RHI::Vulkan
+{
+    FDeferredReleaseQueue::FDeferredReleaseQueue(const FContext& Ctx) : Context(Ctx)
+    {
+    }
+
+    FDeferredReleaseQueue::~FDeferredReleaseQueue()
+    {
+        assert(PendingReleases.empty());
+    }
+
+    void FDeferredReleaseQueue::RegisterQueue(FQueue* Queue)
+    {
+        std::lock_guard Guard(Mutex);
+        for (auto& Slot : Queues)
+        {
+            if (Slot == Queue)
+            {
+                return;
+            }
+        }
+        for (auto& Slot : Queues)
+        {
+            if (Slot == nullptr)
+            {
+                Slot = Queue;
+                return;
+            }
+        }
+        throw OS::FOSException("Too many queues in use");
+    }
+
+    void FDeferredReleaseQueue::UnregisterQueue(FQueue* Queue)
+    {
+        std::lock_guard Guard(Mutex);
+        for (uint32_t i = 0; i < MAX_TRACKED_QUEUE_COUNT; ++i)
+        {
+            if (Queues[i] == Queue)
+            {
+                // the queue is idle when it goes away, so nothing waits for it anymore
+                for (auto& PendingRelease : PendingReleases)
+                {
+                    PendingRelease.TimelineValues[i] = 0;
+                }
+                Queues[i] = nullptr;
+            }
+        }
+    }
+
+    void FDeferredReleaseQueue::Release(VkObjectType Type, uint64_t Handle, VmaAllocation Allocation)
+    {
+        if (Handle == 0)
+        {
+            return;
+        }
+
+        FPendingRelease PendingRelease;
+        PendingRelease.Type = Type;
+        PendingRelease.Handle = Handle;
+        PendingRelease.Allocation = Allocation;
+
+        std::lock_guard Guard(Mutex);
+        for (uint32_t i = 0; i < MAX_TRACKED_QUEUE_COUNT; ++i)
+        {
+            PendingRelease.TimelineValues[i] = Queues[i] ? Queues[i]->GetSubmittedValue() : 0;
+        }
+        PendingReleases.push_back(PendingRelease);
+    }
+
+    void FDeferredReleaseQueue::Collect()
+    {
+        std::lock_guard Guard(Mutex);
+        if (PendingReleases.empty())
+        {
+            return;
+        }
+
+        std::array<uint64_t, MAX_TRACKED_QUEUE_COUNT> CompletedValues = {};
+        for (uint32_t i = 0; i < MAX_TRACKED_QUEUE_COUNT; ++i)
+        {
+            CompletedValues[i] = Queues[i] ? Queues[i]->GetCompletedValue() : 0;
+        }
+
+        // submitted values only grow, so releases are ordered and we can stop at the first one still in flight
+        while (!PendingReleases.empty())
+        {
+            auto& PendingRelease = PendingReleases.front();
+            for (uint32_t i = 0; i < MAX_TRACKED_QUEUE_COUNT; ++i)
+            {
+                if (PendingRelease.TimelineValues[i] > CompletedValues[i])
+                {
+                    return;
+                }
+            }
+            Destroy(PendingRelease);
+            PendingReleases.pop_front();
+        }
+    }
+
+    void FDeferredReleaseQueue::Flush()
+    {
+        std::lock_guard Guard(Mutex);
+        for (auto& PendingRelease : PendingReleases)
+        {
+            Destroy(PendingRelease);
+        }
+        PendingReleases.clear();
+    }
+
+    void FDeferredReleaseQueue::Destroy(const FPendingRelease& PendingRelease)
+    {
+        auto Device = Context.Device;
+        auto Callbacks = Context.AllocationCallbacks;
+        switch (PendingRelease.Type)
+        {
+        case VK_OBJECT_TYPE_BUFFER:
+        {
+            vmaDestroyBuffer(Context.Allocator, (VkBuffer)PendingRelease.Handle, PendingRelease.Allocation);
+            break;
+        }
+        case VK_OBJECT_TYPE_IMAGE:
+        {
+            vmaDestroyImage(Context.Allocator, (VkImage)PendingRelease.Handle, PendingRelease.Allocation);
+            break;
+        }
+        case VK_OBJECT_TYPE_IMAGE_VIEW:
+        {
+            vkDestroyImageView(Device, (VkImageView)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        case VK_OBJECT_TYPE_PIPELINE:
+        {
+            vkDestroyPipeline(Device, (VkPipeline)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+        {
+            vkDestroyPipelineLayout(Device, (VkPipelineLayout)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+        {
+            vkDestroyDescriptorSetLayout(Device, (VkDescriptorSetLayout)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        case VK_OBJECT_TYPE_SHADER_MODULE:
+        {
+            vkDestroyShaderModule(Device, (VkShaderModule)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        case VK_OBJECT_TYPE_SEMAPHORE:
+        {
+            vkDestroySemaphore(Device, (VkSemaphore)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        case VK_OBJECT_TYPE_FENCE:
+        {
+            vkDestroyFence(Device, (VkFence)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        case VK_OBJECT_TYPE_COMMAND_POOL:
+        {
+            vkDestroyCommandPool(Device, (VkCommandPool)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+        {
+            vkDestroySwapchainKHR(Device, (VkSwapchainKHR)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        case VK_OBJECT_TYPE_SURFACE_KHR:
+        {
+            vkDestroySurfaceKHR(Context.Instance, (VkSurfaceKHR)PendingRelease.Handle, Callbacks);
+            break;
+        }
+        default:
+            CHECK(false);
+            break;
+        }
+    }
+}
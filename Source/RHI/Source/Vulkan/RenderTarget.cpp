@@ -1,42 +1,28 @@
 #include "Backend.h"
 namespace Neko::RHI::Vulkan
 { 
-    FColorAttachment::FColorAttachment(const FContext& Ctx, const FColorAttachmentDesc& InDesc)
-		:Context(Ctx),Desc(InDesc)
+    FColorAttachment::FColorAttachment(const FContext& Ctx, const FColorAttachmentDesc& InDesc, VkImageView InImageView)
+		:Context(Ctx),ImageView(InImageView),Desc(InDesc)
 	{
-        FTexture* Texture = reinterpret_cast<FTexture*>(Desc.Texture);
-        assert(Texture != nullptr);
-        VkImageViewCreateInfo ImageViewInfo = {};
-        ImageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        ImageViewInfo.format = ConvertToVkFormat(Desc.Format);
-        ImageViewInfo.image = Texture->GetImage();
-        ImageViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-
-        VkImageSubresourceRange SubresourceRange;
-        {
-            SubresourceRange.aspectMask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT;
-            SubresourceRange.baseMipLevel = Desc.MipOffset;
-            SubresourceRange.levelCount = Desc.MipNum;
-            SubresourceRange.baseArrayLayer = Desc.ArrayOffset;
-            SubresourceRange.layerCount = Desc.ArraySize;
-
-        }
-        ImageViewInfo.subresourceRange = SubresourceRange;
-
-        VK_CHECK_THROW(vkCreateImageView(Context.Device, &ImageViewInfo, Context.AllocationCallbacks, &ImageView), "Failed to create iamge view");
 	}
 
-    FColorAttachment::~FColorAttachment()
+    FDepthStencilAttachment::FDepthStencilAttachment(const FContext& Ctx, const FDepthStencilAttachmentDesc& InDesc, VkImageView InImageView)
+		:Context(Ctx),ImageView(InImageView),Desc(InDesc)
 	{
-        if (ImageView)
-        {
-            vkDestroyImageView(Context.Device, ImageView, Context.AllocationCallbacks);
-            ImageView = nullptr;
-        }
 	}
 
 	IColorAttachmentRef FDevice::CreateColorAttachment(const FColorAttachmentDesc& InDesc)
 	{
-		return new FColorAttachment(Context, InDesc);
+        FTexture* Texture = reinterpret_cast<FTexture*>(InDesc.Texture);
+        assert(Texture != nullptr);
+		return Texture->GetColorAttachment(InDesc);
+	}
+
+	IDepthStencilAttachmentRef FDevice::CreateDepthStencilAttachment(const FDepthStencilAttachmentDesc& InDesc)
+	{
+        FTexture* Texture = reinterpret_cast<FTexture*>(InDesc.Texture);
+        assert(Texture != nullptr);
+        assert(IsDepthFormat(InDesc.Format));
+		return Texture->GetDepthStencilAttachment(InDesc);
 	}
-}
\ No newline at end of file
+}
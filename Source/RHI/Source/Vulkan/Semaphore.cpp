@@ -2,7 +2,7 @@
 #include <cassert>
 namespace Neko::RHI::Vulkan
 {
-    FSemaphore::FSemaphore(const FContext& Ctx, const ESemaphoreType& Type) :Context(Ctx)
+    FSemaphore::FSemaphore(const FContext& Ctx, const ESemaphoreType& InType) :Context(Ctx), Type(InType)
     {
         VkSemaphoreTypeCreateInfo SemaphoreTypeCreateInfo = {};
         SemaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
@@ -13,17 +13,86 @@ namespace Neko::RHI::Vulkan
         SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
         SemaphoreCreateInfo.pNext = &SemaphoreTypeCreateInfo;
 
-        vkCreateSemaphore(Context.Device, &SemaphoreCreateInfo, Context.AllocationCallbacks, &Semaphore);
+        VK_CHECK_THROW(vkCreateSemaphore(Context.Device, &SemaphoreCreateInfo, Context.AllocationCallbacks, &Semaphore), "Failed to create semaphore");
     }
 
     FSemaphore::~FSemaphore()
     {
         if (Semaphore)
         {
-            vkDestroySemaphore(Context.Device, Semaphore, Context.AllocationCallbacks);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)Semaphore);
         }
     }
 
+    bool FSemaphore::Wait(uint64_t Value, uint64_t Timeout)
+    {
+        assert(Type == ESemaphoreType::Timeline);
+
+        VkSemaphoreWaitInfo WaitInfo = {};
+        WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        WaitInfo.semaphoreCount = 1;
+        WaitInfo.pSemaphores = &Semaphore;
+        WaitInfo.pValues = &Value;
+
+        auto Result = vkWaitSemaphores(Context.Device, &WaitInfo, Timeout);
+        if (Result == VK_TIMEOUT)
+        {
+            return false;
+        }
+        VK_CHECK_THROW(Result, "Failed to wait for semaphore");
+        return true;
+    }
+
+    void FSemaphore::Signal(uint64_t Value)
+    {
+        assert(Type == ESemaphoreType::Timeline);
+
+        VkSemaphoreSignalInfo SignalInfo = {};
+        SignalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+        SignalInfo.semaphore = Semaphore;
+        SignalInfo.value = Value;
+        VK_CHECK_THROW(vkSignalSemaphore(Context.Device, &SignalInfo), "Failed to signal semaphore");
+    }
+
+    uint64_t FSemaphore::GetCompletedValue()
+    {
+        assert(Type == ESemaphoreType::Timeline);
+
+        uint64_t Value = 0;
+        VK_CHECK_THROW(vkGetSemaphoreCounterValue(Context.Device, Semaphore, &Value), "Failed to query semaphore");
+        return Value;
+    }
+
+    bool FDevice::WaitSemaphores(ISemaphore** InSemaphores, const uint64_t* Values, uint32_t SemaphoreNum, bool bWaitAll, uint64_t Timeout)
+    {
+        if (SemaphoreNum == 0)
+        {
+            return true;
+        }
+
+        std::vector<VkSemaphore> Semaphores;
+        Semaphores.reserve(SemaphoreNum);
+        for (uint32_t i = 0; i < SemaphoreNum; ++i)
+        {
+            Semaphores.push_back(reinterpret_cast<FSemaphore*>(InSemaphores[i])->GetSemaphore());
+        }
+
+        VkSemaphoreWaitInfo WaitInfo = {};
+        WaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        WaitInfo.flags = bWaitAll ? 0 : VK_SEMAPHORE_WAIT_ANY_BIT;
+        WaitInfo.semaphoreCount = SemaphoreNum;
+        WaitInfo.pSemaphores = Semaphores.data();
+        WaitInfo.pValues = Values;
+
+        auto Result = vkWaitSemaphores(Context.Device, &WaitInfo, Timeout);
+        if (Result == VK_TIMEOUT)
+        {
+            return false;
+        }
+        VK_CHECK_THROW(Result, "Failed to wait for semaphores");
+        return true;
+    }
+
     ISemaphoreRef FDevice::CreateSemaphore(const ESemaphoreType& Type)
     {
         return new FSemaphore(Context, Type);
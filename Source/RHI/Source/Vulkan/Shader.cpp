@@ -9,7 +9,7 @@ namespace Neko::RHI::Vulkan
     {
         if (ShaderModule)
         {
-            vkDestroyShaderModule(Context.Device, ShaderModule, Context.AllocationCallbacks);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)ShaderModule);
             ShaderModule = nullptr;
         }
     }
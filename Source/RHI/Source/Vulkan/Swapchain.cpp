@@ -1,6 +1,7 @@
 #include "Backend.h"
 #include <cassert>
 #include <map>
+#include <algorithm>
 #include <vector>
 namespace Neko::RHI::Vulkan
 { 
@@ -12,102 +13,175 @@ namespace Neko::RHI::Vulkan
     {
         Reset();
     }
-    bool FSwapchain::Initalize(const FSwapChainDesc &Desc)
+
+    static VkPresentModeKHR ChoosePresentMode(EPresentLatency Latency, const std::vector<VkPresentModeKHR>& SupportedModes)
+    {
+        std::vector<VkPresentModeKHR> PreferredModes;
+        switch (Latency)
+        {
+        case EPresentLatency::LowLatency:
+            PreferredModes = { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+            break;
+        case EPresentLatency::Immediate:
+            PreferredModes = { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR };
+            break;
+        default:
+            break;
+        }
+
+        for (auto PreferredMode : PreferredModes)
+        {
+            for (auto SupportedMode : SupportedModes)
+            {
+                if (SupportedMode == PreferredMode)
+                {
+                    return PreferredMode;
+                }
+            }
+        }
+        return VK_PRESENT_MODE_FIFO_KHR;
+    }
+
+    bool FSwapchain::Initalize(const FSwapChainDesc &InDesc)
     {
-        if (Desc.WindowRawPtr)
+        if (InDesc.WindowRawPtr)
         {
+            Desc = InDesc;
             Surface = static_cast<VkSurfaceKHR>(Desc.WindowRawPtr->CreateVulkanSurface(Context.Instance).pointer);
+            Recreate();
+            return true;
+        }
+        return false;
+    }
 
-            VkSurfaceCapabilitiesKHR SurfaceCapabilities;
-            vkGetPhysicalDeviceSurfaceCapabilitiesKHR(Context.PhysicalDevice, Surface, &SurfaceCapabilities);
+    bool FSwapchain::Recreate()
+    {
+        bPendingRecreate = false;
 
-            VkExtent2D Size;
-            VkFormat Format;
+        VkSurfaceCapabilitiesKHR SurfaceCapabilities;
+        VK_CHECK_THROW(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(Context.PhysicalDevice, Surface, &SurfaceCapabilities), "Failed to query surface capabilities");
 
-            Size.width = SurfaceCapabilities.currentExtent.width;
-            Size.height = SurfaceCapabilities.currentExtent.height;
+        VkExtent2D Size;
+        if (SurfaceCapabilities.currentExtent.width != UINT32_MAX)
+        {
+            Size = SurfaceCapabilities.currentExtent;
+        }
+        else
+        {
+            Size.width = std::clamp(RequestedWidth, SurfaceCapabilities.minImageExtent.width, SurfaceCapabilities.maxImageExtent.width);
+            Size.height = std::clamp(RequestedHeight, SurfaceCapabilities.minImageExtent.height, SurfaceCapabilities.maxImageExtent.height);
+        }
+
+        // minimized, keep the current swapchain until the window comes back
+        if (Size.width == 0 || Size.height == 0)
+        {
+            bPendingRecreate = true;
+            return false;
+        }
 
-            Format = ConvertToVkFormat(Desc.Format);
-            auto ColorSpace = ConvertToVkColorSpaceKHR(Desc.Format);
-            VkFormat FallbackFormat = VkFormat::VK_FORMAT_UNDEFINED;
+        VkFormat Format = ConvertToVkFormat(Desc.Format);
+        auto ColorSpace = ConvertToVkColorSpaceKHR(Desc.Format);
+        VkFormat FallbackFormat = VkFormat::VK_FORMAT_UNDEFINED;
+        {
+            uint32_t SupportedFormatsCount;
+            std::vector<VkSurfaceFormatKHR> SurfaceFormats;
+            vkGetPhysicalDeviceSurfaceFormatsKHR(Context.PhysicalDevice, Surface, &SupportedFormatsCount, nullptr);
+            SurfaceFormats.resize(SupportedFormatsCount);
+            vkGetPhysicalDeviceSurfaceFormatsKHR(Context.PhysicalDevice, Surface, &SupportedFormatsCount, SurfaceFormats.data());
+
+            bool bColorSpaceFound = false;
+            for (uint32_t i = 0; i < SupportedFormatsCount; ++i)
             {
-                uint32_t SupportedFormatsCount;
-                std::vector<VkSurfaceFormatKHR> SurfaceFormats;
-                vkGetPhysicalDeviceSurfaceFormatsKHR(Context.PhysicalDevice, Surface, &SupportedFormatsCount, nullptr);
-                SurfaceFormats.resize(SupportedFormatsCount);
-                vkGetPhysicalDeviceSurfaceFormatsKHR(Context.PhysicalDevice, Surface, &SupportedFormatsCount, SurfaceFormats.data());
-
-                bool bColorSpaceFound = false;
-                for (uint32_t i = 0; i < SupportedFormatsCount; ++i)
+                if (SurfaceFormats[i].colorSpace == ColorSpace)
                 {
-                    if (SurfaceFormats[i].colorSpace == ColorSpace)
-                    {
-                        bColorSpaceFound = true;
-                    }
+                    bColorSpaceFound = true;
                 }
+            }
 
-                if (!bColorSpaceFound)
-                {
-                    ColorSpace = SurfaceFormats[0].colorSpace;
-                    FallbackFormat = SurfaceFormats[0].format;
-                }
+            if (!bColorSpaceFound)
+            {
+                ColorSpace = SurfaceFormats[0].colorSpace;
+                FallbackFormat = SurfaceFormats[0].format;
+            }
 
-                bool bColorFormatFound = false;
-                for (uint32_t i = 0; i < SupportedFormatsCount; ++i)
+            bool bColorFormatFound = false;
+            for (uint32_t i = 0; i < SupportedFormatsCount; ++i)
+            {
+                if (SurfaceFormats[i].colorSpace == ColorSpace)
                 {
-                    if (SurfaceFormats[i].colorSpace == ColorSpace)
+                    if (SurfaceFormats[i].format == Format)
                     {
-                        if (SurfaceFormats[i].format == Format)
-                        {
-                            bColorFormatFound = true;
-                        }
+                        bColorFormatFound = true;
                     }
                 }
-
-                if (!bColorFormatFound)
-                {
-                    Format = FallbackFormat;
-                }
             }
 
-            VkSwapchainCreateInfoKHR SwapchainInfo = {};
-            SwapchainInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-            SwapchainInfo.surface = Surface;
-            SwapchainInfo.minImageCount = Desc.ImageCount;
-            SwapchainInfo.imageFormat = Format;
-            SwapchainInfo.imageExtent = Size;
-            SwapchainInfo.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
-            SwapchainInfo.compositeAlpha = VkCompositeAlphaFlagBitsKHR::VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-            SwapchainInfo.imageArrayLayers = 1;
-            SwapchainInfo.presentMode = Desc.VSync ? VkPresentModeKHR::VK_PRESENT_MODE_FIFO_KHR : VkPresentModeKHR::VK_PRESENT_MODE_FIFO_RELAXED_KHR;
-            SwapchainInfo.clipped = VK_FALSE;
-            SwapchainInfo.imageColorSpace = ColorSpace;
-            SwapchainInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-
-            VK_CHECK_THROW(vkCreateSwapchainKHR(Context.Device, &SwapchainInfo, Context.AllocationCallbacks, &Swapchain), "Failed to create swapchain");
-
-            std::vector<VkImage> Images;
-
-            vkGetSwapchainImagesKHR(Context.Device, Swapchain, &ImageCount, nullptr);
-            Images.resize(ImageCount);
-            vkGetSwapchainImagesKHR(Context.Device, Swapchain, &ImageCount, Images.data());
-            for (uint32_t i = 0; i < ImageCount; ++i)
+            if (!bColorFormatFound)
             {
-                FTextureDesc Desc;
-                Desc.Width = Size.width;
-                Desc.Height = Size.height;
-                Desc.Depth = 1;
-                Desc.ArraySize = 1;
-                Desc.Depth = 1;
-                Desc.Format = ConvertFromVkFormat(Format);
-                Desc.MipNum = 1;
-                auto Texture = RefCountPtr<FTexture>(new FTexture(Context, Images[i],Desc));
-                Textures.push_back(Texture);
+                Format = FallbackFormat;
             }
-            
-            return true;
         }
-        return false;
+
+        std::vector<VkPresentModeKHR> PresentModes;
+        {
+            uint32_t PresentModeCount;
+            vkGetPhysicalDeviceSurfacePresentModesKHR(Context.PhysicalDevice, Surface, &PresentModeCount, nullptr);
+            PresentModes.resize(PresentModeCount);
+            vkGetPhysicalDeviceSurfacePresentModesKHR(Context.PhysicalDevice, Surface, &PresentModeCount, PresentModes.data());
+        }
+
+        uint32_t MinImageCount = std::max(Desc.ImageCount, SurfaceCapabilities.minImageCount);
+        if (SurfaceCapabilities.maxImageCount > 0)
+        {
+            MinImageCount = std::min(MinImageCount, SurfaceCapabilities.maxImageCount);
+        }
+
+        auto OldSwapchain = Swapchain;
+
+        VkSwapchainCreateInfoKHR SwapchainInfo = {};
+        SwapchainInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+        SwapchainInfo.surface = Surface;
+        SwapchainInfo.minImageCount = MinImageCount;
+        SwapchainInfo.imageFormat = Format;
+        SwapchainInfo.imageExtent = Size;
+        SwapchainInfo.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+        SwapchainInfo.compositeAlpha = VkCompositeAlphaFlagBitsKHR::VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+        SwapchainInfo.imageArrayLayers = 1;
+        SwapchainInfo.presentMode = ChoosePresentMode(Desc.PresentLatency, PresentModes);
+        SwapchainInfo.clipped = VK_FALSE;
+        SwapchainInfo.imageColorSpace = ColorSpace;
+        SwapchainInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        SwapchainInfo.oldSwapchain = OldSwapchain;
+
+        VK_CHECK_THROW(vkCreateSwapchainKHR(Context.Device, &SwapchainInfo, Context.AllocationCallbacks, &Swapchain), "Failed to create swapchain");
+
+        // the retired swapchain may still be read by frames in flight, it goes away once they are done
+        if (OldSwapchain)
+        {
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_SWAPCHAIN_KHR, (uint64_t)OldSwapchain);
+        }
+
+        std::vector<VkImage> Images;
+
+        vkGetSwapchainImagesKHR(Context.Device, Swapchain, &ImageCount, nullptr);
+        Images.resize(ImageCount);
+        vkGetSwapchainImagesKHR(Context.Device, Swapchain, &ImageCount, Images.data());
+
+        Textures.clear();
+        for (uint32_t i = 0; i < ImageCount; ++i)
+        {
+            FTextureDesc TextureDesc;
+            TextureDesc.Width = Size.width;
+            TextureDesc.Height = Size.height;
+            TextureDesc.Depth = 1;
+            TextureDesc.ArraySize = 1;
+            TextureDesc.Format = ConvertFromVkFormat(Format);
+            TextureDesc.MipNum = 1;
+            auto Texture = RefCountPtr<FTexture>(new FTexture(Context, Images[i], TextureDesc));
+            Textures.push_back(Texture);
+        }
+
+        return true;
     }
 
     ISwapchainRef FDevice::CreateSwapChain(const FSwapChainDesc &Desc)
@@ -125,8 +199,32 @@ namespace Neko::RHI::Vulkan
         auto Semaphore = reinterpret_cast<FSemaphore*>(InSemaphore);
         auto Fence = reinterpret_cast<FFence*>(InFence);
 
-        VK_CHECK_THROW(vkAcquireNextImageKHR(Context.Device, Swapchain, UINT64_MAX, Semaphore ? Semaphore->GetSemaphore() : nullptr, Fence ? Fence->GetFence() : nullptr, &ImageIndex), "Failed to acquire next image");
-        return ImageIndex;
+        if (bPendingRecreate && !Recreate())
+        {
+            return SWAPCHAIN_INVALID_INDEX;
+        }
+
+        for (uint32_t Attempt = 0; Attempt < 2; ++Attempt)
+        {
+            auto Result = vkAcquireNextImageKHR(Context.Device, Swapchain, UINT64_MAX, Semaphore ? Semaphore->GetSemaphore() : nullptr, Fence ? Fence->GetFence() : nullptr, &ImageIndex);
+            if (Result == VK_SUBOPTIMAL_KHR)
+            {
+                // the image is acquired and the semaphore will be signaled, so use it and recreate next frame
+                bPendingRecreate = true;
+                return ImageIndex;
+            }
+            if (Result == VK_ERROR_OUT_OF_DATE_KHR)
+            {
+                if (!Recreate())
+                {
+                    return SWAPCHAIN_INVALID_INDEX;
+                }
+                continue;
+            }
+            VK_CHECK_THROW(Result, "Failed to acquire next image");
+            return ImageIndex;
+        }
+        return SWAPCHAIN_INVALID_INDEX;
     }
 
     void FSwapchain::Present(const FPresentDesc& Desc)
@@ -135,7 +233,9 @@ namespace Neko::RHI::Vulkan
 
         auto Queue = reinterpret_cast<FQueue*>(Desc.Queue);
 
-        std::vector<VkSemaphore> WaitSemaphores;
+        FScratchScope Scratch;
+        TArenaVector<VkSemaphore> WaitSemaphores(Scratch);
+        WaitSemaphores.reserve(Desc.WaitSemaphoreArray.size());
         for (uint32_t i = 0; i < Desc.WaitSemaphoreArray.size(); ++i)
         {
             WaitSemaphores.push_back(reinterpret_cast<FSemaphore*>(Desc.WaitSemaphoreArray[i])->GetSemaphore());
@@ -150,7 +250,21 @@ namespace Neko::RHI::Vulkan
         PresentInfo.swapchainCount = 1;
         PresentInfo.pSwapchains = SwapChains;
         PresentInfo.pImageIndices = ImageIndices;
-        VK_CHECK_THROW(auto result = vkQueuePresentKHR(Queue->GetQueue(), &PresentInfo), "Failed to present");
+
+        auto Result = vkQueuePresentKHR(Queue->GetQueue(), &PresentInfo);
+        if (Result == VK_SUBOPTIMAL_KHR || Result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            bPendingRecreate = true;
+            return;
+        }
+        VK_CHECK_THROW(Result, "Failed to present");
+    }
+
+    void FSwapchain::Resize(uint32_t Width, uint32_t Height)
+    {
+        RequestedWidth = Width;
+        RequestedHeight = Height;
+        bPendingRecreate = true;
     }
 
     uint32_t FSwapchain::GetTextureNum()
@@ -158,6 +272,12 @@ namespace Neko::RHI::Vulkan
         return ImageCount;
     }
 
+    ITextureRef FSwapchain::GetTexture(uint32_t Index)
+    {
+        assert(Index < Textures.size());
+        return Textures[Index];
+    }
+
     std::vector<ITextureRef>  FSwapchain::GetTextures()
     {
         return Textures;
@@ -165,16 +285,17 @@ namespace Neko::RHI::Vulkan
 
     void FSwapchain::Reset()
     {
+        Textures.clear();
         if (Swapchain)
         {
             ImageCount = 0;
-            vkDestroySwapchainKHR(Context.Device, Swapchain, Context.AllocationCallbacks);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_SWAPCHAIN_KHR, (uint64_t)Swapchain);
             Swapchain = nullptr;
         }
 
         if (Surface)
         {
-            vkDestroySurfaceKHR(Context.Instance, Surface, Context.AllocationCallbacks);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_SURFACE_KHR, (uint64_t)Surface);
             Surface = nullptr;
         }
     }
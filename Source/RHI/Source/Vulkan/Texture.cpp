@@ -10,39 +10,192 @@ namespace Neko::RHI::Vulkan
 
 	}
 
-	FTexture2DView::FTexture2DView(const FContext& Ctx, const FTexture2DViewDesc& InDesc):Context(Ctx),Desc(InDesc)
-	{
-        FTexture* Texture = reinterpret_cast<FTexture*>(Desc.Texture);
-        assert(Texture != nullptr);
+    FTexture::FTexture(const FContext& Ctx, const FTextureDesc& InDesc)
+        : Context(Ctx), Desc(InDesc), bAutoRelease(true)
+    {
+        VkImageCreateInfo ImageCreateInfo = {};
+        ImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        ImageCreateInfo.imageType = ConvertToVkImageType(Desc.TextureType);
+        ImageCreateInfo.format = ConvertToVkFormat(Desc.Format);
+        ImageCreateInfo.extent.width = Desc.Width;
+        ImageCreateInfo.extent.height = Desc.Height;
+        ImageCreateInfo.extent.depth = Desc.Depth;
+        ImageCreateInfo.mipLevels = Desc.MipNum;
+        ImageCreateInfo.arrayLayers = Desc.ArraySize;
+        ImageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        ImageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ImageCreateInfo.usage = ConvertToVkImageUsageFlags(Desc.TextureUsage);
+        ImageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        // shared between the families of the created queues so compute and transfer queues need no ownership transfers
+        if (Context.QueueFamilyIndices.size() > 1)
+        {
+            ImageCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            ImageCreateInfo.queueFamilyIndexCount = (uint32_t)Context.QueueFamilyIndices.size();
+            ImageCreateInfo.pQueueFamilyIndices = Context.QueueFamilyIndices.data();
+        }
+        ImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VmaAllocationCreateInfo AllocInfo = {};
+        AllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+        // attachments are reallocated on resize, keeping them out of shared blocks avoids fragmentation
+        if ((Desc.TextureUsage & (ETextureUsage::ColorAttachment | ETextureUsage::DepthStencilAttachment)) != 0)
+        {
+            AllocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        }
+
+        VmaAllocationInfo AllocationInfo = {};
+        VK_CHECK_THROW(vmaCreateImage(Context.Allocator, &ImageCreateInfo, &AllocInfo, &Image, &Allocation, &AllocationInfo), "Failed to create image");
+
+        AllocationSize = AllocationInfo.size;
+        vmaSetAllocationName(Context.Allocator, Allocation, GetResourceCategoryName(Desc.Category));
+        Context.TrackAllocation(Desc.Category, AllocationSize);
+    }
+
+    FTexture::~FTexture()
+    {
+        ColorAttachments.clear();
+        DepthStencilAttachments.clear();
+        Texture2DViews.clear();
+        for (auto& [Key, ImageView] : ImageViews)
+        {
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)ImageView);
+        }
+        ImageViews.clear();
+
+        if (Allocation)
+        {
+            Context.UntrackAllocation(Desc.Category, AllocationSize);
+            Context.ReleaseQueue->Release(VK_OBJECT_TYPE_IMAGE, (uint64_t)Image, Allocation);
+            Image = nullptr;
+            Allocation = nullptr;
+        }
+    }
+
+    ITextureRef FDevice::CreateTexture(const FTextureDesc& Desc)
+    {
+        return new FTexture(Context, Desc);
+    }
+
+    VkImageView FTexture::GetOrCreateImageView(const FImageViewKey& Key)
+    {
+        for (auto& [CachedKey, ImageView] : ImageViews)
+        {
+            if (CachedKey == Key)
+            {
+                return ImageView;
+            }
+        }
+
         VkImageViewCreateInfo ImageViewInfo = {};
         ImageViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        ImageViewInfo.format = ConvertToVkFormat(Desc.Format);
-        ImageViewInfo.image = Texture->GetImage();
-        ImageViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        ImageViewInfo.format = Key.Format;
+        ImageViewInfo.image = Image;
+        ImageViewInfo.viewType = Key.Type;
 
         VkImageSubresourceRange SubresourceRange;
         {
-            SubresourceRange.aspectMask = VkImageAspectFlagBits::VK_IMAGE_ASPECT_COLOR_BIT;
-            SubresourceRange.baseMipLevel = Desc.MipOffset;
-            SubresourceRange.levelCount = Desc.MipNum;
-            SubresourceRange.baseArrayLayer = Desc.ArrayOffset;
-            SubresourceRange.layerCount = Desc.ArraySize;
-            
+            SubresourceRange.aspectMask = Key.Aspect;
+            SubresourceRange.baseMipLevel = Key.MipOffset;
+            SubresourceRange.levelCount = Key.MipNum;
+            SubresourceRange.baseArrayLayer = Key.ArrayOffset;
+            SubresourceRange.layerCount = Key.ArraySize;
         }
         ImageViewInfo.subresourceRange = SubresourceRange;
 
+        VkImageView ImageView = nullptr;
         VK_CHECK_THROW(vkCreateImageView(Context.Device, &ImageViewInfo, Context.AllocationCallbacks, &ImageView), "Failed to create iamge view");
-	}
+        ImageViews.emplace_back(Key, ImageView);
+        return ImageView;
+    }
+
+    IColorAttachmentRef FTexture::GetColorAttachment(const FColorAttachmentDesc& InDesc)
+    {
+        std::lock_guard Guard(ViewMutex);
+        // the blend state is left out of the key, the attachment keeps a default one
+        auto ViewDesc = InDesc;
+        ViewDesc.BlendState = FColorAttachmentBlendSate();
+        for (auto& ColorAttachment : ColorAttachments)
+        {
+            if (ColorAttachment->GetDesc() == ViewDesc)
+            {
+                return ColorAttachment;
+            }
+        }
 
-   FTexture2DView:: ~FTexture2DView()
+        FImageViewKey Key;
+        Key.Type = VK_IMAGE_VIEW_TYPE_2D;
+        Key.Format = ConvertToVkFormat(InDesc.Format);
+        Key.Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        Key.MipOffset = InDesc.MipOffset;
+        Key.MipNum = InDesc.MipNum;
+        Key.ArrayOffset = InDesc.ArrayOffset;
+        Key.ArraySize = InDesc.ArraySize;
+
+        auto ColorAttachment = RefCountPtr<FColorAttachment>(new FColorAttachment(Context, ViewDesc, GetOrCreateImageView(Key)));
+        ColorAttachments.push_back(ColorAttachment);
+        return ColorAttachment;
+    }
+
+    IDepthStencilAttachmentRef FTexture::GetDepthStencilAttachment(const FDepthStencilAttachmentDesc& InDesc)
     {
-        if (ImageView)
+        std::lock_guard Guard(ViewMutex);
+        for (auto& DepthStencilAttachment : DepthStencilAttachments)
         {
-            vkDestroyImageView(Context.Device, ImageView, Context.AllocationCallbacks);
-            ImageView = nullptr;
+            if (DepthStencilAttachment->GetDesc() == InDesc)
+            {
+                return DepthStencilAttachment;
+            }
         }
+
+        FImageViewKey Key;
+        Key.Type = VK_IMAGE_VIEW_TYPE_2D;
+        Key.Format = ConvertToVkFormat(InDesc.Format);
+        Key.Aspect = ConvertToVkImageAspectFlags(InDesc.Format);
+        Key.MipOffset = InDesc.MipOffset;
+        Key.MipNum = 1;
+        Key.ArrayOffset = InDesc.ArrayOffset;
+        Key.ArraySize = InDesc.ArraySize;
+
+        auto DepthStencilAttachment = RefCountPtr<FDepthStencilAttachment>(new FDepthStencilAttachment(Context, InDesc, GetOrCreateImageView(Key)));
+        DepthStencilAttachments.push_back(DepthStencilAttachment);
+        return DepthStencilAttachment;
     }
 
+    ITexture2DViewRef FTexture::GetTexture2DView(const FTexture2DViewDesc& InDesc)
+    {
+        std::lock_guard Guard(ViewMutex);
+        for (auto& Texture2DView : Texture2DViews)
+        {
+            if (Texture2DView->GetDesc() == InDesc)
+            {
+                return Texture2DView;
+            }
+        }
+
+        FImageViewKey Key;
+        Key.Type = VK_IMAGE_VIEW_TYPE_2D;
+        Key.Format = ConvertToVkFormat(InDesc.Format);
+        Key.Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        Key.MipOffset = InDesc.MipOffset;
+        Key.MipNum = InDesc.MipNum;
+        Key.ArrayOffset = InDesc.ArrayOffset;
+        Key.ArraySize = InDesc.ArraySize;
+
+        if (IsDepthFormat(InDesc.Format))
+        {
+            Key.Aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+        }
+
+        auto Texture2DView = RefCountPtr<FTexture2DView>(new FTexture2DView(Context, InDesc, GetOrCreateImageView(Key)));
+        Texture2DViews.push_back(Texture2DView);
+        return Texture2DView;
+    }
+
+	FTexture2DView::FTexture2DView(const FContext& Ctx, const FTexture2DViewDesc& InDesc, VkImageView InImageView)
+        : Context(Ctx), ImageView(InImageView), Desc(InDesc)
+	{
+	}
+
     ITextureRef FTexture2DView::GetTexture()
     {
         return Desc.Texture;
@@ -55,7 +208,9 @@ namespace Neko::RHI::Vulkan
 
     ITexture2DViewRef FDevice::CreateTexture2DView(const FTexture2DViewDesc& Desc)
     {
-        return  new FTexture2DView(Context, Desc);
+        FTexture* Texture = reinterpret_cast<FTexture*>(Desc.Texture);
+        assert(Texture != nullptr);
+        return Texture->GetTexture2DView(Desc);
     }
 
     ITexture2DViewRef FDevice::CreateTexture2DView(ITexture* InTexture)
@@ -71,4 +226,4 @@ namespace Neko::RHI::Vulkan
             .SetMipOffset(0);
         return CreateTexture2DView(Desc);
     }
-}
\ No newline at end of file
+}
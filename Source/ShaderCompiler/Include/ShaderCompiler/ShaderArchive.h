@@ -0,0 +1,73 @@
+#pragma once
+#include "ShaderCompiler/ShaderPermutation.h"
+#include "OS/MappedFile.h"
+#include <string_view>
+namespace Neko::ShaderCompiler
+{
+    // a single file holding every compiled shader of a build, laid out to be used in place:
+    //   header | blobs and serialized reflection, 16 byte aligned | open addressing directory
+    // the directory is a power of two table of entries probed linearly from Key, Key 0 marks a free slot
+    constexpr uint32_t SHADER_ARCHIVE_MAGIC = 0x4148534E; // "NSHA"
+    constexpr uint32_t SHADER_ARCHIVE_VERSION = 1;
+
+    struct FShaderArchiveHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t EntryNum;
+        uint32_t BucketNum;
+        uint64_t DirectoryOffset;
+        uint64_t FileSize;
+    };
+
+    struct FShaderArchiveEntry
+    {
+        uint64_t Key;
+        uint64_t BlobOffset;
+        uint64_t ReflectionOffset;
+        uint32_t BlobSize;
+        uint32_t ReflectionSize;
+    };
+
+    // names a shader inside an archive, Keywords must hold every axis of a permuted shader
+    uint64_t GetShaderKey(std::string_view Name, std::string_view EntryPoint, const FPermutationKeywords& Keywords = {});
+
+    // points into the mapping, valid while the archive is open
+    struct FShaderArchiveView
+    {
+        const uint8_t* Blob = nullptr;
+        uint32_t BlobSize = 0;
+        const uint8_t* Reflection = nullptr;
+        uint32_t ReflectionSize = 0;
+
+        bool IsValid() const { return Blob != nullptr; }
+        std::shared_ptr<IShaderReflection> GetReflection() const;
+    };
+
+    class FShaderArchive : public FUncopyable
+    {
+    public:
+        // maps the file and validates the header and directory, blobs are paged in on first use
+        bool Open(const std::string& Path);
+        void Close();
+
+        FShaderArchiveView Find(uint64_t Key) const;
+        uint32_t GetShaderNum() const;
+
+    private:
+        OS::FMappedFile File;
+        const FShaderArchiveHeader* Header = nullptr;
+        const FShaderArchiveEntry* Directory = nullptr;
+    };
+
+    class FShaderArchiveWriter
+    {
+    public:
+        // returns false if a different shader was already added with Key
+        bool Add(uint64_t Key, const FCompiledShader& Shader);
+        bool Write(const std::string& Path) const;
+
+    private:
+        std::map<uint64_t, FCompiledShader> Shaders;
+    };
+}
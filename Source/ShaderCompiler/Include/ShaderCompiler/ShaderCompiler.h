@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "HLSLCompiler/Compiler.h"
+#include "ShaderReflection/ShaderReflection.h"
+#include "MiniCore/JobSystem.h"
+#include "MiniCore/Uncopyable.h"
+namespace Neko::ShaderCompiler
+{
+    struct FShaderCompileDesc
+    {
+        std::string Path;
+        std::string EntryPoint;
+        EShaderType Type = EShaderType::kVertex;
+        EShaderFeatureLevel FeatureLevel = EShaderFeatureLevel::k6_5;
+        std::map<std::string, std::string> Defines;
+    };
+
+    struct FCompiledShader
+    {
+        uint64_t Hash = 0;
+        std::vector<uint8_t> Blob;
+        // serialized reflection of Blob, see ShaderReflectionSerializer.h
+        std::vector<uint8_t> Reflection;
+        bool bFromCache = false;
+
+        bool IsValid() const { return !Blob.empty(); }
+        std::shared_ptr<IShaderReflection> GetReflection() const;
+    };
+
+    struct FShaderCacheStats
+    {
+        uint32_t Hits = 0;
+        uint32_t Misses = 0;
+    };
+
+    // compiles hlsl through HLSLCompiler behind an on-disk cache,
+    // entries are keyed by the source and every resolved #include, the entry point, stage,
+    // feature level, defines and compiler version, so a warm start never reaches dxc
+    class FShaderCompiler : public FUncopyable
+    {
+    public:
+        // batches run on JobSystem, without one the compiler starts its own on the first batch
+        FShaderCompiler(const std::string& CacheDir, EShaderBlobType BlobType = EShaderBlobType::kSPIRV, FJobSystem* JobSystem = nullptr);
+
+        FCompiledShader Compile(const FShaderCompileDesc& Desc);
+
+        // lookups and cache misses run on all cores, descs with the same hash are compiled once,
+        // results keep the order of Descs
+        std::vector<FCompiledShader> Compile(const std::vector<FShaderCompileDesc>& Descs);
+
+        // returns false if an include can't be found where dxc looks for it, Hash is still
+        // filled then but must not key a cache, such shaders are always compiled
+        bool ComputeHash(const FShaderCompileDesc& Desc, uint64_t& Hash) const;
+
+        FShaderCacheStats GetStats() const;
+
+    private:
+        bool LoadEntry(uint64_t Hash, FCompiledShader& Shader) const;
+        void StoreEntry(const FCompiledShader& Shader) const;
+        FCompiledShader CompileMiss(const FShaderCompileDesc& Desc, uint64_t Hash, bool bStore) const;
+        std::string GetEntryPath(uint64_t Hash) const;
+        // calls Function for every index in [0, Num) on the job system and rethrows the first exception
+        void ParallelFor(uint32_t Num, const std::function<void(uint32_t)>& Function);
+
+        std::string CacheDir;
+        EShaderBlobType BlobType;
+        FJobSystem* JobSystem;
+        std::unique_ptr<FJobSystem> OwnedJobSystem;
+        std::once_flag OwnedJobSystemFlag;
+        std::atomic<uint32_t> HitCount = 0;
+        std::atomic<uint32_t> MissCount = 0;
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "ShaderCompiler/ShaderCompiler.h"
+namespace Neko::ShaderCompiler
+{
+    typedef std::map<std::string, std::string> FPermutationKeywords;
+
+    // one keyword of a shader and the values it is compiled with, the first value is the default
+    struct FPermutationAxis
+    {
+        std::string Name;
+        std::vector<std::string> Values = { "0", "1" };
+    };
+
+    // a shader compiled once per combination of its keyword axes,
+    // a permutation index is the mixed radix number of the axis value indices, first axis lowest
+    //
+    // axes can also be declared in the shader source:
+    //   //! permutation USE_SKINNING
+    //   //! permutation LIGHT_COUNT 1 2 4
+    //   //! invalid USE_SKINNING=1 ALPHA_TEST=1
+    class FShaderPermutationDesc
+    {
+    public:
+        FShaderCompileDesc Base;
+        std::vector<FPermutationAxis> Axes;
+        // a combination is invalid if it matches every keyword of any of these
+        std::vector<FPermutationKeywords> InvalidCombinations;
+
+        FShaderPermutationDesc() = default;
+        FShaderPermutationDesc(const FShaderCompileDesc& InBase) : Base(InBase) {}
+
+        FShaderPermutationDesc& AddAxis(const std::string& Name, const std::vector<std::string>& Values = { "0", "1" });
+        FShaderPermutationDesc& AddInvalidCombination(const FPermutationKeywords& Keywords);
+
+        // appends the axes and invalid combinations declared in Base.Path, returns false if it can't be read
+        bool LoadDeclarations();
+
+        // 0 if an axis has no values or the combinations don't fit in 32 bits
+        uint32_t GetPermutationCount() const;
+        bool IsValid(uint32_t PermutationIndex) const;
+        FPermutationKeywords GetKeywords(uint32_t PermutationIndex) const;
+        // keywords missing from Keywords take their default, returns UINT32_MAX for unknown values
+        uint32_t GetPermutationIndex(const FPermutationKeywords& Keywords) const;
+    };
+
+    struct FShaderPermutations
+    {
+        // indexed by permutation index, invalid permutations stay empty
+        std::vector<FCompiledShader> Shaders;
+
+        const FCompiledShader* Find(uint32_t PermutationIndex) const
+        {
+            if (PermutationIndex >= Shaders.size() || !Shaders[PermutationIndex].IsValid())
+            {
+                return nullptr;
+            }
+            return &Shaders[PermutationIndex];
+        }
+    };
+
+    // expands every desc and compiles all valid permutations of all of them as one batch,
+    // so the work spreads across cores even when single shaders have few permutations,
+    // throws std::length_error if the permutations of a desc can't be counted
+    std::vector<FShaderPermutations> CompilePermutations(FShaderCompiler& Compiler, const std::vector<FShaderPermutationDesc>& Descs);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "RHI/RHI.h"
+#include "ShaderReflection/ShaderReflection.h"
+#include <string>
+#include <vector>
+namespace Neko::ShaderCompiler
+{
+    enum class EVertexStreamPolicy : uint8_t
+    {
+        // every attribute in one binding
+        Interleaved,
+        // positions in binding 0 and everything else interleaved in binding 1,
+        // depth only and shadow passes then fetch nothing but positions
+        PositionSplit,
+        // one binding per attribute
+        Split,
+    };
+
+    struct FVertexStreamAttribute
+    {
+        uint32_t Element; // index of the mesh element passed to AddElement
+        uint32_t Offset;
+    };
+
+    // how the mesh data has to be laid out for one binding of the generated input layout
+    struct FVertexStream
+    {
+        uint32_t Stride = 0;
+        std::vector<FVertexStreamAttribute> Attributes;
+    };
+
+    struct FVertexLayout
+    {
+        RHI::FVertexInputLayout InputLayout;
+        std::vector<FVertexStream> Streams;
+    };
+
+    // derives the vertex input layout from the inputs a vertex shader actually reads,
+    // mesh elements the shader doesn't read are left out of every stream, so they cost no bandwidth
+    class FVertexLayoutBuilder
+    {
+    public:
+        FVertexLayoutBuilder& SetPolicy(EVertexStreamPolicy InPolicy);
+
+        // Semantic as written in hlsl, a missing index means 0, so TEXCOORD matches TEXCOORD0
+        FVertexLayoutBuilder& AddElement(const std::string& Semantic, RHI::EFormat Format);
+
+        // fails with Error set if the shader reads an input the mesh lacks, or reads it as another type,
+        // attribute names in the result point into the builder, keep it alive while the layout is used
+        bool Build(const IShaderReflection& VertexShader, FVertexLayout& Layout);
+
+        const std::string& GetError() const { return Error; }
+
+    private:
+        struct FElement
+        {
+            std::string Semantic;
+            RHI::EFormat Format;
+        };
+
+        EVertexStreamPolicy Policy = EVertexStreamPolicy::Interleaved;
+        std::vector<FElement> Elements;
+        std::string Error;
+    };
+}
@@ -0,0 +1,183 @@
+#include "ShaderCompiler/ShaderArchive.h"
+#include "ShaderReflection/ShaderReflectionSerializer.h"
+#include "MiniCore/Hash.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+namespace Neko::ShaderCompiler
+{
+    static constexpr uint64_t ARCHIVE_ALIGNMENT = 16;
+
+    static uint64_t AlignUp(uint64_t Value, uint64_t Alignment)
+    {
+        return (Value + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    uint64_t GetShaderKey(std::string_view Name, std::string_view EntryPoint, const FPermutationKeywords& Keywords)
+    {
+        uint64_t Key = HashString(Name);
+        Key = HashString(EntryPoint, Key);
+        for (auto& [Keyword, Value] : Keywords)
+        {
+            Key = HashString(Keyword, Key);
+            Key = HashString(Value, Key);
+        }
+        // 0 marks a free directory slot
+        return Key ? Key : 1;
+    }
+
+    std::shared_ptr<IShaderReflection> FShaderArchiveView::GetReflection() const
+    {
+        if (!Reflection)
+        {
+            return nullptr;
+        }
+        return DeserializeShaderReflection(Reflection, ReflectionSize);
+    }
+
+    bool FShaderArchive::Open(const std::string& Path)
+    {
+        Close();
+        if (!File.Open(Path) || File.GetSize() < sizeof(FShaderArchiveHeader))
+        {
+            Close();
+            return false;
+        }
+
+        auto Data = File.GetData();
+        auto Size = File.GetSize();
+        auto ArchiveHeader = reinterpret_cast<const FShaderArchiveHeader*>(Data);
+        bool bValidHeader = ArchiveHeader->Magic == SHADER_ARCHIVE_MAGIC &&
+            ArchiveHeader->Version == SHADER_ARCHIVE_VERSION &&
+            ArchiveHeader->FileSize == Size &&
+            std::has_single_bit(ArchiveHeader->BucketNum) &&
+            ArchiveHeader->DirectoryOffset % alignof(FShaderArchiveEntry) == 0 &&
+            ArchiveHeader->DirectoryOffset <= Size &&
+            (Size - ArchiveHeader->DirectoryOffset) / sizeof(FShaderArchiveEntry) >= ArchiveHeader->BucketNum;
+        if (!bValidHeader)
+        {
+            Close();
+            return false;
+        }
+
+        // only the directory is touched here, a truncated or hostile file can't make Find read out of bounds
+        auto ArchiveDirectory = reinterpret_cast<const FShaderArchiveEntry*>(Data + ArchiveHeader->DirectoryOffset);
+        for (uint32_t i = 0; i < ArchiveHeader->BucketNum; ++i)
+        {
+            auto& Entry = ArchiveDirectory[i];
+            if (Entry.Key == 0)
+            {
+                continue;
+            }
+            bool bValidEntry = Entry.BlobOffset <= Size && Entry.BlobSize <= Size - Entry.BlobOffset &&
+                Entry.ReflectionOffset <= Size && Entry.ReflectionSize <= Size - Entry.ReflectionOffset;
+            if (!bValidEntry)
+            {
+                Close();
+                return false;
+            }
+        }
+
+        Header = ArchiveHeader;
+        Directory = ArchiveDirectory;
+        return true;
+    }
+
+    void FShaderArchive::Close()
+    {
+        File.Close();
+        Header = nullptr;
+        Directory = nullptr;
+    }
+
+    FShaderArchiveView FShaderArchive::Find(uint64_t Key) const
+    {
+        if (!Header || Key == 0)
+        {
+            return {};
+        }
+
+        uint32_t Mask = Header->BucketNum - 1;
+        for (uint32_t i = 0; i < Header->BucketNum; ++i)
+        {
+            auto& Entry = Directory[(Key + i) & Mask];
+            if (Entry.Key == 0)
+            {
+                break;
+            }
+            if (Entry.Key == Key)
+            {
+                FShaderArchiveView View;
+                View.Blob = File.GetData() + Entry.BlobOffset;
+                View.BlobSize = Entry.BlobSize;
+                if (Entry.ReflectionSize > 0)
+                {
+                    View.Reflection = File.GetData() + Entry.ReflectionOffset;
+                    View.ReflectionSize = Entry.ReflectionSize;
+                }
+                return View;
+            }
+        }
+        return {};
+    }
+
+    uint32_t FShaderArchive::GetShaderNum() const
+    {
+        return Header ? Header->EntryNum : 0;
+    }
+
+    bool FShaderArchiveWriter::Add(uint64_t Key, const FCompiledShader& Shader)
+    {
+        auto [Iter, bInserted] = Shaders.emplace(Key, Shader);
+        return bInserted || Iter->second.Blob == Shader.Blob;
+    }
+
+    bool FShaderArchiveWriter::Write(const std::string& Path) const
+    {
+        std::vector<uint8_t> Data(sizeof(FShaderArchiveHeader));
+        auto Append = [&Data](const std::vector<uint8_t>& Bytes)
+        {
+            Data.resize(AlignUp(Data.size(), ARCHIVE_ALIGNMENT));
+            uint64_t Offset = Data.size();
+            Data.insert(Data.end(), Bytes.begin(), Bytes.end());
+            return Offset;
+        };
+
+        // at most half full, so probe sequences stay short
+        uint32_t BucketNum = std::bit_ceil(std::max<uint32_t>(2 * (uint32_t)Shaders.size(), 1));
+        std::vector<FShaderArchiveEntry> Buckets(BucketNum);
+        for (auto& [Key, Shader] : Shaders)
+        {
+            FShaderArchiveEntry Entry = {};
+            Entry.Key = Key;
+            Entry.BlobOffset = Append(Shader.Blob);
+            Entry.BlobSize = (uint32_t)Shader.Blob.size();
+            Entry.ReflectionOffset = Append(Shader.Reflection);
+            Entry.ReflectionSize = (uint32_t)Shader.Reflection.size();
+
+            uint32_t Bucket = (uint32_t)(Key & (BucketNum - 1));
+            while (Buckets[Bucket].Key != 0)
+            {
+                Bucket = (Bucket + 1) & (BucketNum - 1);
+            }
+            Buckets[Bucket] = Entry;
+        }
+
+        Data.resize(AlignUp(Data.size(), ARCHIVE_ALIGNMENT));
+        FShaderArchiveHeader Header = {};
+        Header.Magic = SHADER_ARCHIVE_MAGIC;
+        Header.Version = SHADER_ARCHIVE_VERSION;
+        Header.EntryNum = (uint32_t)Shaders.size();
+        Header.BucketNum = BucketNum;
+        Header.DirectoryOffset = Data.size();
+        Header.FileSize = Data.size() + Buckets.size() * sizeof(FShaderArchiveEntry);
+        std::memcpy(Data.data(), &Header, sizeof(Header));
+
+        std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+        File.write((const char*)Data.data(), Data.size());
+        File.write((const char*)Buckets.data(), Buckets.size() * sizeof(FShaderArchiveEntry));
+        return (bool)File;
+    }
+}
@@ -0,0 +1,428 @@
+#include "ShaderCompiler/ShaderCompiler.h"
+#include "ShaderReflection/ShaderReflectionSerializer.h"
+#include "MiniCore/Hash.h"
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+// set by cmake to the HLSLCompiler revision, which pins the dxc build
+#ifndef NEKO_SHADER_COMPILER_VERSION
+#define NEKO_SHADER_COMPILER_VERSION "unknown"
+#endif
+
+namespace Neko::ShaderCompiler
+{
+    namespace fs = std::filesystem;
+
+    static constexpr uint32_t CACHE_MAGIC = 0x4348534E; // "NSHC"
+    static constexpr uint32_t CACHE_VERSION = 1;
+
+    struct FCacheEntryHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t Hash;
+        uint64_t BlobSize;
+        uint64_t ReflectionSize;
+    };
+
+    static bool ReadFile(const fs::path& Path, std::string& Content)
+    {
+        std::ifstream File(Path, std::ios::binary);
+        if (!File)
+        {
+            return false;
+        }
+        std::ostringstream Stream;
+        Stream << File.rdbuf();
+        Content = Stream.str();
+        return true;
+    }
+
+    // keeps scratch files of concurrent compiles apart
+    static std::string GetThreadSuffix()
+    {
+        return std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    }
+
+    // returns the target of an #include line, or an empty view, bQuoted tells "" from <>
+    static std::string_view ParseInclude(std::string_view Line, bool& bQuoted)
+    {
+        auto Begin = Line.find_first_not_of(" \t");
+        if (Begin == std::string_view::npos || Line[Begin] != '#')
+        {
+            return {};
+        }
+        Line = Line.substr(Begin + 1);
+        Begin = Line.find_first_not_of(" \t");
+        if (Begin == std::string_view::npos || Line.substr(Begin, 7) != "include")
+        {
+            return {};
+        }
+        Line = Line.substr(Begin + 7);
+        Begin = Line.find_first_of("\"<");
+        if (Begin == std::string_view::npos)
+        {
+            return {};
+        }
+        bQuoted = Line[Begin] == '"';
+        auto End = Line.find(bQuoted ? '"' : '>', Begin + 1);
+        if (End == std::string_view::npos)
+        {
+            return {};
+        }
+        return Line.substr(Begin + 1, End - Begin - 1);
+    }
+
+    // looks an include up where dxc finds it as HLSLCompiler runs it, which passes no -I:
+    // a quoted include next to the including file first, then, like an angle include, in the working directory
+    static bool ResolveInclude(const fs::path& IncluderDir, std::string_view Include, bool bQuoted, fs::path& Resolved)
+    {
+        std::error_code Error;
+        if (bQuoted && fs::is_regular_file(IncluderDir / Include, Error))
+        {
+            Resolved = IncluderDir / Include;
+            return true;
+        }
+        if (fs::is_regular_file(fs::path(Include), Error))
+        {
+            Resolved = fs::path(Include);
+            return true;
+        }
+        return false;
+    }
+
+    // hashes a file and everything it includes, includes are followed regardless of the
+    // surrounding #if blocks, which can only cause a spurious miss. returns false if a file
+    // can't be found, the hash then doesn't cover what dxc would read and must not key the cache
+    static bool HashSourceTree(const fs::path& Path, uint64_t& Hash, std::set<fs::path>& Visited)
+    {
+        std::error_code Error;
+        auto CanonicalPath = fs::weakly_canonical(Path, Error);
+        if (Error)
+        {
+            CanonicalPath = Path;
+        }
+        if (!Visited.insert(CanonicalPath).second)
+        {
+            return true;
+        }
+
+        std::string Source;
+        if (!ReadFile(CanonicalPath, Source))
+        {
+            return false;
+        }
+        Hash = HashString(Source, Hash);
+
+        bool bResolved = true;
+        std::string_view View = Source;
+        size_t LineBegin = 0;
+        while (LineBegin < View.size())
+        {
+            auto LineEnd = View.find('\n', LineBegin);
+            if (LineEnd == std::string_view::npos)
+            {
+                LineEnd = View.size();
+            }
+            bool bQuoted = false;
+            auto Include = ParseInclude(View.substr(LineBegin, LineEnd - LineBegin), bQuoted);
+            if (!Include.empty())
+            {
+                fs::path IncludePath;
+                if (ResolveInclude(CanonicalPath.parent_path(), Include, bQuoted, IncludePath))
+                {
+                    bResolved &= HashSourceTree(IncludePath, Hash, Visited);
+                }
+                else
+                {
+                    // still hashed by name so the key stays distinct, but the caller skips the cache
+                    Hash = HashString(Include, Hash);
+                    bResolved = false;
+                }
+            }
+            LineBegin = LineEnd + 1;
+        }
+        return bResolved;
+    }
+
+    std::shared_ptr<IShaderReflection> FCompiledShader::GetReflection() const
+    {
+        if (Reflection.empty())
+        {
+            return nullptr;
+        }
+        return DeserializeShaderReflection(Reflection.data(), Reflection.size());
+    }
+
+    FShaderCompiler::FShaderCompiler(const std::string& InCacheDir, EShaderBlobType InBlobType, FJobSystem* InJobSystem)
+        : CacheDir(InCacheDir), BlobType(InBlobType), JobSystem(InJobSystem)
+    {
+        std::error_code Error;
+        fs::create_directories(CacheDir, Error);
+    }
+
+    bool FShaderCompiler::ComputeHash(const FShaderCompileDesc& Desc, uint64_t& Hash) const
+    {
+        Hash = HashValue(CACHE_VERSION);
+        Hash = HashString(NEKO_SHADER_COMPILER_VERSION, Hash);
+        Hash = HashValue((uint32_t)BlobType, Hash);
+
+        std::set<fs::path> Visited;
+        bool bResolved = HashSourceTree(Desc.Path, Hash, Visited);
+
+        Hash = HashString(Desc.EntryPoint, Hash);
+        Hash = HashValue((uint32_t)Desc.Type, Hash);
+        Hash = HashValue((uint32_t)Desc.FeatureLevel, Hash);
+        for (auto& [Name, Value] : Desc.Defines)
+        {
+            Hash = HashString(Name, Hash);
+            Hash = HashString(Value, Hash);
+        }
+        return bResolved;
+    }
+
+    std::string FShaderCompiler::GetEntryPath(uint64_t Hash) const
+    {
+        char Name[17];
+        snprintf(Name, sizeof(Name), "%016llx", (unsigned long long)Hash);
+        return (fs::path(CacheDir) / Name).string();
+    }
+
+    bool FShaderCompiler::LoadEntry(uint64_t Hash, FCompiledShader& Shader) const
+    {
+        std::ifstream File(GetEntryPath(Hash) + ".nsc", std::ios::binary);
+        if (!File)
+        {
+            return false;
+        }
+
+        FCacheEntryHeader Header = {};
+        if (!File.read((char*)&Header, sizeof(Header)) ||
+            Header.Magic != CACHE_MAGIC || Header.Version != CACHE_VERSION || Header.Hash != Hash)
+        {
+            return false;
+        }
+
+        Shader.Blob.resize(Header.BlobSize);
+        Shader.Reflection.resize(Header.ReflectionSize);
+        if (!File.read((char*)Shader.Blob.data(), Header.BlobSize) ||
+            !File.read((char*)Shader.Reflection.data(), Header.ReflectionSize))
+        {
+            Shader.Blob.clear();
+            Shader.Reflection.clear();
+            return false;
+        }
+        // a reflection that doesn't read back is a miss, the shader gets compiled again
+        if (!Shader.Reflection.empty() && !DeserializeShaderReflection(Shader.Reflection.data(), Shader.Reflection.size()))
+        {
+            Shader.Blob.clear();
+            Shader.Reflection.clear();
+            return false;
+        }
+        Shader.Hash = Hash;
+        Shader.bFromCache = true;
+        return true;
+    }
+
+    void FShaderCompiler::StoreEntry(const FCompiledShader& Shader) const
+    {
+        FCacheEntryHeader Header = {};
+        Header.Magic = CACHE_MAGIC;
+        Header.Version = CACHE_VERSION;
+        Header.Hash = Shader.Hash;
+        Header.BlobSize = Shader.Blob.size();
+        Header.ReflectionSize = Shader.Reflection.size();
+
+        // written aside and renamed so concurrent processes never read a partial entry
+        auto EntryPath = GetEntryPath(Shader.Hash) + ".nsc";
+        auto TempPath = EntryPath + "." + GetThreadSuffix() + ".tmp";
+        {
+            std::ofstream File(TempPath, std::ios::binary | std::ios::trunc);
+            File.write((const char*)&Header, sizeof(Header));
+            File.write((const char*)Shader.Blob.data(), Shader.Blob.size());
+            File.write((const char*)Shader.Reflection.data(), Shader.Reflection.size());
+            if (!File)
+            {
+                File.close();
+                std::error_code Error;
+                fs::remove(TempPath, Error);
+                return;
+            }
+        }
+
+        std::error_code Error;
+        fs::rename(TempPath, EntryPath, Error);
+        if (Error)
+        {
+            fs::remove(TempPath, Error);
+        }
+    }
+
+    FCompiledShader FShaderCompiler::CompileMiss(const FShaderCompileDesc& Desc, uint64_t Hash, bool bStore) const
+    {
+        std::string SourcePath = Desc.Path;
+        std::string WrapperPath;
+        if (!Desc.Defines.empty())
+        {
+            // defines are prepended through a generated wrapper that includes the real source
+            WrapperPath = GetEntryPath(Hash) + "." + GetThreadSuffix() + ".hlsl";
+            std::ofstream Wrapper(WrapperPath, std::ios::trunc);
+            for (auto& [Name, Value] : Desc.Defines)
+            {
+                Wrapper << "#define " << Name << " " << Value << "\n";
+            }
+            Wrapper << "#include \"" << fs::absolute(Desc.Path).generic_string() << "\"\n";
+            SourcePath = WrapperPath;
+        }
+
+        ShaderDesc CompileDesc = {
+            SourcePath,
+            Desc.EntryPoint,
+            Desc.Type,
+            Desc.FeatureLevel };
+        auto Blob = ::Compile(CompileDesc, BlobType);
+
+        if (!WrapperPath.empty())
+        {
+            std::error_code Error;
+            fs::remove(WrapperPath, Error);
+        }
+
+        FCompiledShader Shader;
+        Shader.Hash = Hash;
+        Shader.Blob.assign(Blob.begin(), Blob.end());
+        if (Shader.Blob.empty())
+        {
+            return Shader;
+        }
+
+        if (BlobType == EShaderBlobType::kSPIRV)
+        {
+            auto Reflection = CreateShaderReflection(EShaBlobType::kSPIRV, Shader.Blob.data(), Shader.Blob.size());
+            if (Reflection)
+            {
+                Shader.Reflection = Reflection->Serialize();
+            }
+        }
+        if (bStore)
+        {
+            StoreEntry(Shader);
+        }
+        return Shader;
+    }
+
+    FCompiledShader FShaderCompiler::Compile(const FShaderCompileDesc& Desc)
+    {
+        return std::move(Compile(std::vector<FShaderCompileDesc>{ Desc }).front());
+    }
+
+    void FShaderCompiler::ParallelFor(uint32_t Num, const std::function<void(uint32_t)>& Function)
+    {
+        // single shaders never start the job system
+        if (Num <= 1)
+        {
+            if (Num == 1)
+            {
+                Function(0);
+            }
+            return;
+        }
+
+        std::call_once(OwnedJobSystemFlag, [this]()
+        {
+            if (!JobSystem)
+            {
+                OwnedJobSystem = std::make_unique<FJobSystem>();
+                JobSystem = OwnedJobSystem.get();
+            }
+        });
+
+        // jobs must not throw, so exceptions are carried out of them
+        std::vector<std::exception_ptr> Exceptions(Num);
+        JobSystem->ParallelFor(Num, 1, [&](uint32_t Begin, uint32_t End)
+        {
+            for (uint32_t i = Begin; i < End; ++i)
+            {
+                try
+                {
+                    Function(i);
+                }
+                catch (...)
+                {
+                    Exceptions[i] = std::current_exception();
+                }
+            }
+        });
+
+        for (auto& Exception : Exceptions)
+        {
+            if (Exception)
+            {
+                std::rethrow_exception(Exception);
+            }
+        }
+    }
+
+    std::vector<FCompiledShader> FShaderCompiler::Compile(const std::vector<FShaderCompileDesc>& Descs)
+    {
+        // hashing reads every include, so it runs on the workers too and large permutation
+        // batches don't serialize on file io before dxc even starts
+        uint32_t DescNum = (uint32_t)Descs.size();
+        std::vector<uint64_t> Hashes(DescNum);
+        std::vector<uint8_t> Cacheable(DescNum);
+        ParallelFor(DescNum, [&](uint32_t i)
+        {
+            Cacheable[i] = ComputeHash(Descs[i], Hashes[i]);
+        });
+
+        // permutation sets often expand to the same source and defines more than once
+        std::vector<uint32_t> Sources(DescNum);
+        std::vector<uint32_t> Unique;
+        std::unordered_map<uint64_t, uint32_t> FirstByHash;
+        for (uint32_t i = 0; i < DescNum; ++i)
+        {
+            auto [Iter, bInserted] = FirstByHash.try_emplace(Hashes[i], i);
+            Sources[i] = Iter->second;
+            if (bInserted)
+            {
+                Unique.push_back(i);
+            }
+        }
+
+        std::vector<FCompiledShader> Shaders(DescNum);
+        ParallelFor((uint32_t)Unique.size(), [&](uint32_t UniqueIndex)
+        {
+            uint32_t i = Unique[UniqueIndex];
+            if (Cacheable[i] && LoadEntry(Hashes[i], Shaders[i]))
+            {
+                HitCount++;
+                return;
+            }
+            MissCount++;
+            Shaders[i] = CompileMiss(Descs[i], Hashes[i], Cacheable[i]);
+        });
+
+        for (uint32_t i = 0; i < DescNum; ++i)
+        {
+            if (Sources[i] != i)
+            {
+                Shaders[i] = Shaders[Sources[i]];
+            }
+        }
+        return Shaders;
+    }
+
+    FShaderCacheStats FShaderCompiler::GetStats() const
+    {
+        FShaderCacheStats Stats;
+        Stats.Hits = HitCount;
+        Stats.Misses = MissCount;
+        return Stats;
+    }
+}
@@ -0,0 +1,203 @@
+#include "ShaderCompiler/ShaderPermutation.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Neko::ShaderCompiler
+{
+    FShaderPermutationDesc& FShaderPermutationDesc::AddAxis(const std::string& Name, const std::vector<std::string>& Values)
+    {
+        Axes.push_back({ Name, Values });
+        return *this;
+    }
+
+    FShaderPermutationDesc& FShaderPermutationDesc::AddInvalidCombination(const FPermutationKeywords& Keywords)
+    {
+        InvalidCombinations.push_back(Keywords);
+        return *this;
+    }
+
+    bool FShaderPermutationDesc::LoadDeclarations()
+    {
+        std::ifstream File(Base.Path);
+        if (!File)
+        {
+            return false;
+        }
+
+        std::string Line;
+        while (std::getline(File, Line))
+        {
+            std::istringstream Tokens(Line);
+            std::string Marker, Directive;
+            if (!(Tokens >> Marker >> Directive) || Marker != "//!")
+            {
+                continue;
+            }
+
+            if (Directive == "permutation")
+            {
+                FPermutationAxis Axis;
+                if (!(Tokens >> Axis.Name))
+                {
+                    continue;
+                }
+                std::vector<std::string> Values;
+                for (std::string Value; Tokens >> Value;)
+                {
+                    Values.push_back(Value);
+                }
+                if (!Values.empty())
+                {
+                    Axis.Values = Values;
+                }
+                Axes.push_back(Axis);
+            }
+            else if (Directive == "invalid")
+            {
+                FPermutationKeywords Keywords;
+                for (std::string Assignment; Tokens >> Assignment;)
+                {
+                    auto Split = Assignment.find('=');
+                    if (Split == std::string::npos)
+                    {
+                        continue;
+                    }
+                    Keywords[Assignment.substr(0, Split)] = Assignment.substr(Split + 1);
+                }
+                if (!Keywords.empty())
+                {
+                    InvalidCombinations.push_back(Keywords);
+                }
+            }
+        }
+        return true;
+    }
+
+    uint32_t FShaderPermutationDesc::GetPermutationCount() const
+    {
+        uint32_t Count = 1;
+        for (auto& Axis : Axes)
+        {
+            uint64_t Product = (uint64_t)Count * Axis.Values.size();
+            if (Product > UINT32_MAX)
+            {
+                return 0;
+            }
+            Count = (uint32_t)Product;
+        }
+        return Count;
+    }
+
+    FPermutationKeywords FShaderPermutationDesc::GetKeywords(uint32_t PermutationIndex) const
+    {
+        FPermutationKeywords Keywords;
+        for (auto& Axis : Axes)
+        {
+            uint32_t ValueNum = (uint32_t)Axis.Values.size();
+            Keywords[Axis.Name] = Axis.Values[PermutationIndex % ValueNum];
+            PermutationIndex /= ValueNum;
+        }
+        return Keywords;
+    }
+
+    bool FShaderPermutationDesc::IsValid(uint32_t PermutationIndex) const
+    {
+        if (PermutationIndex >= GetPermutationCount())
+        {
+            return false;
+        }
+
+        auto Keywords = GetKeywords(PermutationIndex);
+        for (auto& Invalid : InvalidCombinations)
+        {
+            bool bMatch = true;
+            for (auto& [Name, Value] : Invalid)
+            {
+                auto Iter = Keywords.find(Name);
+                if (Iter == Keywords.end() || Iter->second != Value)
+                {
+                    bMatch = false;
+                    break;
+                }
+            }
+            if (bMatch)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t FShaderPermutationDesc::GetPermutationIndex(const FPermutationKeywords& Keywords) const
+    {
+        uint32_t Index = 0;
+        uint32_t Stride = 1;
+        for (auto& Axis : Axes)
+        {
+            uint32_t ValueIndex = 0;
+            auto Iter = Keywords.find(Axis.Name);
+            if (Iter != Keywords.end())
+            {
+                auto Value = std::find(Axis.Values.begin(), Axis.Values.end(), Iter->second);
+                if (Value == Axis.Values.end())
+                {
+                    return UINT32_MAX;
+                }
+                ValueIndex = (uint32_t)(Value - Axis.Values.begin());
+            }
+            Index += ValueIndex * Stride;
+            Stride *= (uint32_t)Axis.Values.size();
+        }
+        return Index;
+    }
+
+    std::vector<FShaderPermutations> CompilePermutations(FShaderCompiler& Compiler, const std::vector<FShaderPermutationDesc>& Descs)
+    {
+        struct FBatchSlot
+        {
+            size_t Desc;
+            uint32_t Permutation;
+        };
+
+        std::vector<FShaderCompileDesc> CompileDescs;
+        std::vector<FBatchSlot> Slots;
+        for (size_t i = 0; i < Descs.size(); ++i)
+        {
+            auto& Desc = Descs[i];
+            uint32_t Count = Desc.GetPermutationCount();
+            if (Count == 0)
+            {
+                throw std::length_error("too many permutations in " + Desc.Base.Path);
+            }
+            for (uint32_t Permutation = 0; Permutation < Count; ++Permutation)
+            {
+                if (!Desc.IsValid(Permutation))
+                {
+                    continue;
+                }
+                auto CompileDesc = Desc.Base;
+                for (auto& [Name, Value] : Desc.GetKeywords(Permutation))
+                {
+                    CompileDesc.Defines[Name] = Value;
+                }
+                CompileDescs.push_back(std::move(CompileDesc));
+                Slots.push_back({ i, Permutation });
+            }
+        }
+
+        auto Shaders = Compiler.Compile(CompileDescs);
+
+        std::vector<FShaderPermutations> Permutations(Descs.size());
+        for (size_t i = 0; i < Descs.size(); ++i)
+        {
+            Permutations[i].Shaders.resize(Descs[i].GetPermutationCount());
+        }
+        for (size_t i = 0; i < Slots.size(); ++i)
+        {
+            Permutations[Slots[i].Desc].Shaders[Slots[i].Permutation] = std::move(Shaders[i]);
+        }
+        return Permutations;
+    }
+}
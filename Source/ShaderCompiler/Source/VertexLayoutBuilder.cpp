@@ -0,0 +1,212 @@
+#include "ShaderCompiler/VertexLayoutBuilder.h"
+#include <algorithm>
+#include <cctype>
+
+namespace Neko::ShaderCompiler
+{
+    enum class EComponentType : uint8_t
+    {
+        Float,
+        UInt,
+        SInt,
+        Unknown,
+    };
+
+    static EComponentType GetComponentType(RHI::EFormat Format)
+    {
+        switch (Format)
+        {
+        case RHI::EFormat::R32_SFLOAT:
+        case RHI::EFormat::R32G32_SFLOAT:
+        case RHI::EFormat::R32G32B32_SFLOAT:
+        case RHI::EFormat::R32G32B32A32_SFLOAT:
+        case RHI::EFormat::B8G8R8A8_SNORM:
+        case RHI::EFormat::B8G8R8A8_UNORM:
+        case RHI::EFormat::R8G8B8A8_UNORM:
+        case RHI::EFormat::R8G8B8A8_SNORM:
+        case RHI::EFormat::R16G16_SFLOAT:
+        case RHI::EFormat::R16G16_SNORM:
+        case RHI::EFormat::R16G16B16A16_SFLOAT:
+        case RHI::EFormat::R16G16B16A16_UNORM:
+            return EComponentType::Float;
+        case RHI::EFormat::R32_UINT:
+        case RHI::EFormat::R32G32_UINT:
+        case RHI::EFormat::R32G32B32_UINT:
+        case RHI::EFormat::R32G32B32A32_UINT:
+            return EComponentType::UInt;
+        case RHI::EFormat::R32_SINT:
+        case RHI::EFormat::R32G32_SINT:
+        case RHI::EFormat::R32G32B32_SINT:
+        case RHI::EFormat::R32G32B32A32_SINT:
+            return EComponentType::SInt;
+        default:
+            return EComponentType::Unknown;
+        }
+    }
+
+    // the reflection reports inputs with the 32-bit formats of their hlsl type
+    static EComponentType GetComponentType(::EFormat Format)
+    {
+        switch (Format)
+        {
+        case ::EFormat::FORMAT_R32_SFLOAT_PACK32:
+        case ::EFormat::FORMAT_RG32_SFLOAT_PACK32:
+        case ::EFormat::FORMAT_RGB32_SFLOAT_PACK32:
+        case ::EFormat::FORMAT_RGBA32_SFLOAT_PACK32:
+            return EComponentType::Float;
+        case ::EFormat::FORMAT_R32_UINT_PACK32:
+        case ::EFormat::FORMAT_RG32_UINT_PACK32:
+        case ::EFormat::FORMAT_RGB32_UINT_PACK32:
+        case ::EFormat::FORMAT_RGBA32_UINT_PACK32:
+            return EComponentType::UInt;
+        case ::EFormat::FORMAT_R32_SINT_PACK32:
+        case ::EFormat::FORMAT_RG32_SINT_PACK32:
+        case ::EFormat::FORMAT_RGB32_SINT_PACK32:
+        case ::EFormat::FORMAT_RGBA32_SINT_PACK32:
+            return EComponentType::SInt;
+        default:
+            return EComponentType::Unknown;
+        }
+    }
+
+    // a semantic split into its name and index, TEXCOORD and TEXCOORD0 name the same input but TEXCOORD10 doesn't
+    struct FSemantic
+    {
+        std::string Name;
+        uint32_t Index = 0;
+
+        bool operator==(const FSemantic&) const = default;
+    };
+
+    static FSemantic ParseSemantic(const std::string& Semantic)
+    {
+        size_t IndexBegin = Semantic.size();
+        while (IndexBegin > 0 && std::isdigit((unsigned char)Semantic[IndexBegin - 1]))
+        {
+            --IndexBegin;
+        }
+
+        FSemantic Result;
+        Result.Name = Semantic.substr(0, IndexBegin);
+        std::transform(Result.Name.begin(), Result.Name.end(), Result.Name.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+        for (size_t i = IndexBegin; i < Semantic.size(); ++i)
+        {
+            Result.Index = Result.Index * 10 + (Semantic[i] - '0');
+        }
+        return Result;
+    }
+
+    FVertexLayoutBuilder& FVertexLayoutBuilder::SetPolicy(EVertexStreamPolicy InPolicy)
+    {
+        Policy = InPolicy;
+        return *this;
+    }
+
+    FVertexLayoutBuilder& FVertexLayoutBuilder::AddElement(const std::string& Semantic, RHI::EFormat Format)
+    {
+        Elements.push_back({ Semantic, Format });
+        return *this;
+    }
+
+    bool FVertexLayoutBuilder::Build(const IShaderReflection& VertexShader, FVertexLayout& Layout)
+    {
+        Error.clear();
+        Layout = {};
+
+        // shader location of every mesh element the shader reads
+        std::vector<uint32_t> Locations(Elements.size(), UINT32_MAX);
+        for (auto& Input : VertexShader.GetInputParameters())
+        {
+            auto Semantic = ParseSemantic(Input.semantic_name);
+            auto Element = std::find_if(Elements.begin(), Elements.end(), [&](const FElement& Element)
+            {
+                return ParseSemantic(Element.Semantic) == Semantic;
+            });
+            if (Element == Elements.end())
+            {
+                Error = "vertex shader reads " + Input.semantic_name + " which the mesh doesn't provide";
+                return false;
+            }
+            if (GetComponentType(Element->Format) != GetComponentType(Input.format))
+            {
+                Error = "mesh element " + Element->Semantic + " doesn't match the type the vertex shader reads";
+                return false;
+            }
+            Locations[Element - Elements.begin()] = Input.location;
+        }
+
+        // elements keep their declaration order inside a stream, so a matching c++ struct stays easy to write
+        std::vector<std::vector<uint32_t>> StreamElements;
+        for (uint32_t i = 0; i < Elements.size(); ++i)
+        {
+            if (Locations[i] == UINT32_MAX)
+            {
+                continue;
+            }
+
+            size_t Stream = 0;
+            switch (Policy)
+            {
+            case EVertexStreamPolicy::Interleaved:
+                Stream = 0;
+                break;
+            case EVertexStreamPolicy::PositionSplit:
+                Stream = ParseSemantic(Elements[i].Semantic) == FSemantic{ "POSITION", 0 } ? 0 : 1;
+                break;
+            case EVertexStreamPolicy::Split:
+                Stream = StreamElements.size();
+                break;
+            }
+            if (StreamElements.size() <= Stream)
+            {
+                StreamElements.resize(Stream + 1);
+            }
+            StreamElements[Stream].push_back(i);
+        }
+        // PositionSplit without a position leaves the first stream empty
+        std::erase_if(StreamElements, [](const std::vector<uint32_t>& Stream) { return Stream.empty(); });
+
+        for (uint32_t Binding = 0; Binding < StreamElements.size(); ++Binding)
+        {
+            FVertexStream Stream;
+            uint32_t Offset = 0;
+            for (auto Element : StreamElements[Binding])
+            {
+                uint32_t Size = RHI::GetFormatSize(Elements[Element].Format);
+                uint32_t Alignment = std::min(Size, 4u);
+                Offset = (Offset + Alignment - 1) / Alignment * Alignment;
+                Stream.Attributes.push_back({ Element, Offset });
+                Offset += Size;
+            }
+            Stream.Stride = (Offset + 3) / 4 * 4;
+
+            if (Stream.Stride > UINT8_MAX)
+            {
+                Error = "vertex stride exceeds what FVertexBinding can describe";
+                return false;
+            }
+            if (Layout.InputLayout.AttributeArray.size() + Stream.Attributes.size() > RHI::MAX_VERTEX_ATTRIBUTE_COUNT ||
+                Layout.InputLayout.BindingArray.size() + 1 > RHI::MAX_VERTEX_BINDING_COUNT)
+            {
+                Error = "vertex layout exceeds the attribute or binding limit";
+                return false;
+            }
+
+            Layout.InputLayout.AddBinding(RHI::FVertexBinding()
+                .SetBinding((uint8_t)Binding)
+                .SetStride((uint8_t)Stream.Stride)
+                .SetVertexRate(RHI::EVertexRate::Vertex));
+            for (auto& Attribute : Stream.Attributes)
+            {
+                Layout.InputLayout.AddAttribute(RHI::FVertexAttribute()
+                    .SetName(Elements[Attribute.Element].Semantic.c_str())
+                    .SetFormat(Elements[Attribute.Element].Format)
+                    .SetBinding((uint8_t)Binding)
+                    .SetLocation((uint8_t)Locations[Attribute.Element])
+                    .SetOffset((uint8_t)Attribute.Offset));
+            }
+            Layout.Streams.push_back(std::move(Stream));
+        }
+        return true;
+    }
+}
@@ -0,0 +1,511 @@
+#include "MeshCook.h"
+#include "MiniCore/Hash.h"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <meshoptimizer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace Neko::MeshCook
+{
+    using namespace Mesh;
+
+    static uint64_t AlignUp(uint64_t Value, uint64_t Alignment)
+    {
+        return (Value + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    static void AddAttribute(FCookedMesh& Mesh, EMeshAttribute Attribute, EMeshVertexFormat Format)
+    {
+        Mesh.Attributes.push_back({ Attribute, Format, (uint16_t)Mesh.VertexStride });
+        Mesh.VertexStride += GetMeshVertexFormatSize(Format);
+    }
+
+    static bool ImportMesh(const aiMesh& Source, const FMeshCookOptions& Options, FCookedMesh& Mesh)
+    {
+        Mesh.Name = Source.mName.C_Str();
+
+        // meshoptimizer expects the position in the first 12 bytes of every vertex
+        AddAttribute(Mesh, EMeshAttribute::Position, EMeshVertexFormat::Float3);
+        bool bNormals = Options.bNormals && Source.HasNormals();
+        bool bTangents = Options.bTangents && Source.HasTangentsAndBitangents() && Source.HasNormals();
+        bool bTexCoords = Options.bTexCoords && Source.HasTextureCoords(0);
+        bool bColors = Options.bColors && Source.HasVertexColors(0);
+        if (bNormals)
+        {
+            AddAttribute(Mesh, EMeshAttribute::Normal, EMeshVertexFormat::Float3);
+        }
+        if (bTangents)
+        {
+            AddAttribute(Mesh, EMeshAttribute::Tangent, EMeshVertexFormat::Float4);
+        }
+        if (bTexCoords)
+        {
+            AddAttribute(Mesh, EMeshAttribute::TexCoord0, EMeshVertexFormat::Float2);
+        }
+        if (bColors)
+        {
+            AddAttribute(Mesh, EMeshAttribute::Color, EMeshVertexFormat::Float4);
+        }
+
+        std::vector<float> Vertices;
+        Vertices.reserve(Source.mNumVertices * Mesh.VertexStride / sizeof(float));
+        for (uint32_t i = 0; i < Source.mNumVertices; ++i)
+        {
+            auto& Position = Source.mVertices[i];
+            Vertices.insert(Vertices.end(), { Position.x, Position.y, Position.z });
+            if (bNormals)
+            {
+                auto& Normal = Source.mNormals[i];
+                Vertices.insert(Vertices.end(), { Normal.x, Normal.y, Normal.z });
+            }
+            if (bTangents)
+            {
+                // w carries the bitangent sign so shaders can rebuild it from normal and tangent
+                auto& Normal = Source.mNormals[i];
+                auto& Tangent = Source.mTangents[i];
+                auto& Bitangent = Source.mBitangents[i];
+                float Handedness = ((Normal ^ Tangent) * Bitangent) < 0.0f ? -1.0f : 1.0f;
+                Vertices.insert(Vertices.end(), { Tangent.x, Tangent.y, Tangent.z, Handedness });
+            }
+            if (bTexCoords)
+            {
+                auto& TexCoord = Source.mTextureCoords[0][i];
+                Vertices.insert(Vertices.end(), { TexCoord.x, TexCoord.y });
+            }
+            if (bColors)
+            {
+                auto& Color = Source.mColors[0][i];
+                Vertices.insert(Vertices.end(), { Color.r, Color.g, Color.b, Color.a });
+            }
+        }
+
+        std::vector<uint32_t> Indices;
+        Indices.reserve(Source.mNumFaces * 3);
+        for (uint32_t i = 0; i < Source.mNumFaces; ++i)
+        {
+            auto& Face = Source.mFaces[i];
+            if (Face.mNumIndices == 3)
+            {
+                Indices.insert(Indices.end(), { Face.mIndices[0], Face.mIndices[1], Face.mIndices[2] });
+            }
+        }
+        if (Indices.empty())
+        {
+            return false;
+        }
+
+        // importers split vertices per face corner, merge the bitwise identical ones
+        std::vector<uint32_t> Remap(Source.mNumVertices);
+        size_t VertexNum = meshopt_generateVertexRemap(Remap.data(), Indices.data(), Indices.size(), Vertices.data(), Source.mNumVertices, Mesh.VertexStride);
+
+        Mesh.VertexNum = (uint32_t)VertexNum;
+        Mesh.Vertices.resize(VertexNum * Mesh.VertexStride);
+        Mesh.Indices.resize(Indices.size());
+        meshopt_remapVertexBuffer(Mesh.Vertices.data(), Vertices.data(), Source.mNumVertices, Mesh.VertexStride, Remap.data());
+        meshopt_remapIndexBuffer(Mesh.Indices.data(), Indices.data(), Indices.size(), Remap.data());
+        return true;
+    }
+
+    bool ImportMeshes(const std::string& Path, const FMeshCookOptions& Options, std::vector<FCookedMesh>& Meshes, std::string& Error)
+    {
+        uint32_t Flags = aiProcess_Triangulate | aiProcess_PreTransformVertices | aiProcess_SortByPType;
+        if (Options.bNormals || Options.bTangents)
+        {
+            Flags |= aiProcess_GenSmoothNormals;
+        }
+        if (Options.bTangents)
+        {
+            Flags |= aiProcess_CalcTangentSpace;
+        }
+
+        Assimp::Importer Importer;
+        auto Scene = Importer.ReadFile(Path, Flags);
+        if (!Scene || (Scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE))
+        {
+            Error = Importer.GetErrorString();
+            return false;
+        }
+
+        for (uint32_t i = 0; i < Scene->mNumMeshes; ++i)
+        {
+            auto& Source = *Scene->mMeshes[i];
+            if (!(Source.mPrimitiveTypes & aiPrimitiveType_TRIANGLE))
+            {
+                continue;
+            }
+            FCookedMesh Mesh;
+            if (ImportMesh(Source, Options, Mesh))
+            {
+                if (Mesh.Name.empty())
+                {
+                    Mesh.Name = "Mesh" + std::to_string(i);
+                }
+                Meshes.push_back(std::move(Mesh));
+            }
+        }
+        return true;
+    }
+
+    static void ComputeBounds(FCookedMesh& Mesh)
+    {
+        auto& Bounds = Mesh.Bounds;
+        for (int Axis = 0; Axis < 3; ++Axis)
+        {
+            Bounds.Min[Axis] = INFINITY;
+            Bounds.Max[Axis] = -INFINITY;
+        }
+        for (uint32_t i = 0; i < Mesh.VertexNum; ++i)
+        {
+            float Position[3];
+            std::memcpy(Position, Mesh.Vertices.data() + i * Mesh.VertexStride, sizeof(Position));
+            for (int Axis = 0; Axis < 3; ++Axis)
+            {
+                Bounds.Min[Axis] = std::min(Bounds.Min[Axis], Position[Axis]);
+                Bounds.Max[Axis] = std::max(Bounds.Max[Axis], Position[Axis]);
+            }
+        }
+
+        // sphere around the box center, loose but stable and cheap to test
+        float RadiusSquared = 0.0f;
+        for (int Axis = 0; Axis < 3; ++Axis)
+        {
+            Bounds.Center[Axis] = (Bounds.Min[Axis] + Bounds.Max[Axis]) * 0.5f;
+        }
+        for (uint32_t i = 0; i < Mesh.VertexNum; ++i)
+        {
+            float Position[3];
+            std::memcpy(Position, Mesh.Vertices.data() + i * Mesh.VertexStride, sizeof(Position));
+            float DistanceSquared = 0.0f;
+            for (int Axis = 0; Axis < 3; ++Axis)
+            {
+                float Delta = Position[Axis] - Bounds.Center[Axis];
+                DistanceSquared += Delta * Delta;
+            }
+            RadiusSquared = std::max(RadiusSquared, DistanceSquared);
+        }
+        Bounds.Radius = std::sqrt(RadiusSquared);
+    }
+
+    // simplified index buffers of every level after the first, with their absolute error
+    static void BuildLodChain(const FCookedMesh& Mesh, const FMeshCookOptions& Options, std::vector<std::vector<uint32_t>>& LodIndices, std::vector<float>& LodErrors)
+    {
+        auto Positions = reinterpret_cast<const float*>(Mesh.Vertices.data());
+        float Scale = meshopt_simplifyScale(Positions, Mesh.VertexNum, Mesh.VertexStride);
+        uint32_t MaxLodNum = std::min(Options.MaxLodNum, MAX_MESH_LOD_COUNT);
+
+        // every level is simplified from the full mesh, so its error is measured against it
+        // and doesn't have to be summed over the levels in between, copied as the chain grows
+        auto Source = LodIndices.front();
+        while (LodIndices.size() < MaxLodNum)
+        {
+            size_t PreviousIndexNum = LodIndices.back().size();
+            size_t TargetIndexNum = (size_t)(PreviousIndexNum / 3 * Options.LodReduction) * 3;
+            if (TargetIndexNum < 3)
+            {
+                break;
+            }
+
+            // simplify keeps the topology, so it stalls on meshes made of many small parts,
+            // sloppy simplification welds them together when that happens
+            std::vector<uint32_t> Indices(Source.size());
+            float Error = 0.0f;
+            Indices.resize(meshopt_simplify(Indices.data(), Source.data(), Source.size(), Positions, Mesh.VertexNum, Mesh.VertexStride, TargetIndexNum, Options.LodMaxError, &Error));
+            if (Indices.size() > (PreviousIndexNum + TargetIndexNum) / 2)
+            {
+                Indices.resize(Source.size());
+                Indices.resize(meshopt_simplifySloppy(Indices.data(), Source.data(), Source.size(), Positions, Mesh.VertexNum, Mesh.VertexStride, TargetIndexNum, Options.LodMaxError, &Error));
+            }
+            if (Indices.empty() || Indices.size() >= PreviousIndexNum)
+            {
+                break;
+            }
+
+            meshopt_optimizeVertexCache(Indices.data(), Indices.data(), Indices.size(), Mesh.VertexNum);
+            LodErrors.push_back(std::max(LodErrors.back(), Error * Scale));
+            LodIndices.push_back(std::move(Indices));
+        }
+    }
+
+    // appends the clusters of one level and rewrites its index range in cluster order
+    static void BuildMeshlets(FCookedMesh& Mesh, FMeshLod& Lod, const FMeshCookOptions& Options)
+    {
+        auto Positions = reinterpret_cast<const float*>(Mesh.Vertices.data());
+        auto LodIndices = Mesh.Indices.data() + Lod.FirstIndex;
+        size_t MaxMeshletNum = meshopt_buildMeshletsBound(Lod.IndexNum, MAX_MESHLET_VERTEX_COUNT, MAX_MESHLET_TRIANGLE_COUNT);
+        std::vector<meshopt_Meshlet> Meshlets(MaxMeshletNum);
+        std::vector<uint32_t> MeshletVertices(MaxMeshletNum * MAX_MESHLET_VERTEX_COUNT);
+        std::vector<uint8_t> MeshletTriangles(MaxMeshletNum * MAX_MESHLET_TRIANGLE_COUNT * 3);
+        size_t MeshletNum = meshopt_buildMeshlets(Meshlets.data(), MeshletVertices.data(), MeshletTriangles.data(),
+            LodIndices, Lod.IndexNum, Positions, Mesh.VertexNum, Mesh.VertexStride,
+            MAX_MESHLET_VERTEX_COUNT, MAX_MESHLET_TRIANGLE_COUNT, Options.MeshletConeWeight);
+
+        // every meshlet becomes a contiguous index range, so it can be drawn on its own with a plain indexed draw
+        std::vector<uint32_t> Indices;
+        Indices.reserve(Lod.IndexNum);
+        Lod.FirstMeshlet = (uint32_t)Mesh.Meshlets.size();
+        Lod.MeshletNum = (uint32_t)MeshletNum;
+        Mesh.Meshlets.resize(Lod.FirstMeshlet + MeshletNum);
+        for (size_t i = 0; i < MeshletNum; ++i)
+        {
+            auto& Source = Meshlets[i];
+            auto Vertices = MeshletVertices.data() + Source.vertex_offset;
+            auto Triangles = MeshletTriangles.data() + Source.triangle_offset;
+            auto Bounds = meshopt_computeMeshletBounds(Vertices, Triangles, Source.triangle_count, Positions, Mesh.VertexNum, Mesh.VertexStride);
+
+            auto& Meshlet = Mesh.Meshlets[Lod.FirstMeshlet + i];
+            Meshlet = {};
+            std::copy(Bounds.center, Bounds.center + 3, Meshlet.Center);
+            Meshlet.Radius = Bounds.radius;
+            std::copy(Bounds.cone_apex, Bounds.cone_apex + 3, Meshlet.ConeApex);
+            std::copy(Bounds.cone_axis, Bounds.cone_axis + 3, Meshlet.ConeAxis);
+            Meshlet.ConeCutoff = Bounds.cone_cutoff;
+            Meshlet.FirstIndex = Lod.FirstIndex + (uint32_t)Indices.size();
+            Meshlet.IndexNum = Source.triangle_count * 3;
+            for (uint32_t Index = 0; Index < Source.triangle_count * 3; ++Index)
+            {
+                Indices.push_back(Vertices[Triangles[Index]]);
+            }
+        }
+        std::copy(Indices.begin(), Indices.end(), LodIndices);
+    }
+
+    void OptimizeMesh(FCookedMesh& Mesh, const FMeshCookOptions& Options)
+    {
+        auto Positions = reinterpret_cast<const float*>(Mesh.Vertices.data());
+        meshopt_optimizeVertexCache(Mesh.Indices.data(), Mesh.Indices.data(), Mesh.Indices.size(), Mesh.VertexNum);
+        meshopt_optimizeOverdraw(Mesh.Indices.data(), Mesh.Indices.data(), Mesh.Indices.size(), Positions, Mesh.VertexNum, Mesh.VertexStride, Options.OverdrawThreshold);
+
+        std::vector<std::vector<uint32_t>> LodIndices = { std::move(Mesh.Indices) };
+        std::vector<float> LodErrors = { 0.0f };
+        BuildLodChain(Mesh, Options, LodIndices, LodErrors);
+
+        Mesh.Indices.clear();
+        Mesh.Lods.clear();
+        for (size_t i = 0; i < LodIndices.size(); ++i)
+        {
+            FMeshLod Lod = {};
+            Lod.FirstIndex = (uint32_t)Mesh.Indices.size();
+            Lod.IndexNum = (uint32_t)LodIndices[i].size();
+            Lod.Error = LodErrors[i];
+            Mesh.Lods.push_back(Lod);
+            Mesh.Indices.insert(Mesh.Indices.end(), LodIndices[i].begin(), LodIndices[i].end());
+        }
+
+        // over the indices of all levels, vertices only the full mesh uses end up last
+        // also drops vertices no triangle references
+        Mesh.VertexNum = (uint32_t)meshopt_optimizeVertexFetch(Mesh.Vertices.data(), Mesh.Indices.data(), Mesh.Indices.size(), Mesh.Vertices.data(), Mesh.VertexNum, Mesh.VertexStride);
+        Mesh.Vertices.resize((size_t)Mesh.VertexNum * Mesh.VertexStride);
+
+        ComputeBounds(Mesh);
+        Mesh.Meshlets.clear();
+        if (Options.bMeshlets)
+        {
+            for (auto& Lod : Mesh.Lods)
+            {
+                BuildMeshlets(Mesh, Lod, Options);
+            }
+        }
+    }
+
+    // maps the unit vector onto an octahedron unfolded into [-1, 1]^2, two snorm16 keep it within a few hundredths of a degree
+    static void EncodeOctahedral(const float* Vector, int16_t* Encoded)
+    {
+        float Length = std::fabs(Vector[0]) + std::fabs(Vector[1]) + std::fabs(Vector[2]);
+        float X = Length > 0.0f ? Vector[0] / Length : 0.0f;
+        float Y = Length > 0.0f ? Vector[1] / Length : 0.0f;
+        if (Vector[2] < 0.0f)
+        {
+            float FoldedX = (1.0f - std::fabs(Y)) * (X >= 0.0f ? 1.0f : -1.0f);
+            float FoldedY = (1.0f - std::fabs(X)) * (Y >= 0.0f ? 1.0f : -1.0f);
+            X = FoldedX;
+            Y = FoldedY;
+        }
+        Encoded[0] = (int16_t)meshopt_quantizeSnorm(X, 16);
+        Encoded[1] = (int16_t)meshopt_quantizeSnorm(Y, 16);
+    }
+
+    static EMeshVertexFormat GetQuantizedFormat(EMeshAttribute Attribute)
+    {
+        switch (Attribute)
+        {
+        case EMeshAttribute::Position: return EMeshVertexFormat::Unorm16x4;
+        case EMeshAttribute::Normal: return EMeshVertexFormat::Snorm16x2;
+        case EMeshAttribute::Tangent: return EMeshVertexFormat::Snorm8x4;
+        case EMeshAttribute::TexCoord0: return EMeshVertexFormat::Half2;
+        default: return EMeshVertexFormat::Unorm8x4;
+        }
+    }
+
+    void QuantizeMesh(FCookedMesh& Mesh)
+    {
+        // positions are stored as fractions of the bounds, so the precision follows the mesh size rather than
+        // its distance from the origin, half texcoords rather than unorm16 keep tiling coordinates outside [0, 1] working
+        float InvExtent[3];
+        for (int Axis = 0; Axis < 3; ++Axis)
+        {
+            float Extent = Mesh.Bounds.Max[Axis] - Mesh.Bounds.Min[Axis];
+            Mesh.PositionOffset[Axis] = Mesh.Bounds.Min[Axis];
+            Mesh.PositionScale[Axis] = Extent;
+            InvExtent[Axis] = Extent > 0.0f ? 1.0f / Extent : 0.0f;
+        }
+
+        FCookedMesh Quantized;
+        for (auto& Attribute : Mesh.Attributes)
+        {
+            AddAttribute(Quantized, Attribute.Attribute, GetQuantizedFormat(Attribute.Attribute));
+        }
+
+        std::vector<uint8_t> Vertices((size_t)Mesh.VertexNum * Quantized.VertexStride);
+        for (uint32_t i = 0; i < Mesh.VertexNum; ++i)
+        {
+            for (size_t Element = 0; Element < Mesh.Attributes.size(); ++Element)
+            {
+                auto& Source = Mesh.Attributes[Element];
+                auto& Dest = Quantized.Attributes[Element];
+                float Value[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                std::memcpy(Value, Mesh.Vertices.data() + (size_t)i * Mesh.VertexStride + Source.Offset, GetMeshVertexFormatSize(Source.Format));
+                auto Data = Vertices.data() + (size_t)i * Quantized.VertexStride + Dest.Offset;
+
+                switch (Dest.Format)
+                {
+                case EMeshVertexFormat::Half2:
+                case EMeshVertexFormat::Half4:
+                {
+                    uint16_t Half[4];
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        Half[c] = meshopt_quantizeHalf(Value[c]);
+                    }
+                    std::memcpy(Data, Half, GetMeshVertexFormatSize(Dest.Format));
+                    break;
+                }
+                case EMeshVertexFormat::Unorm16x4:
+                {
+                    uint16_t Unorm[4] = { 0, 0, 0, 65535 };
+                    for (int Axis = 0; Axis < 3; ++Axis)
+                    {
+                        float Fraction = (Value[Axis] - Mesh.PositionOffset[Axis]) * InvExtent[Axis];
+                        Unorm[Axis] = (uint16_t)meshopt_quantizeUnorm(std::clamp(Fraction, 0.0f, 1.0f), 16);
+                    }
+                    std::memcpy(Data, Unorm, sizeof(Unorm));
+                    break;
+                }
+                case EMeshVertexFormat::Snorm16x2:
+                {
+                    int16_t Encoded[2];
+                    EncodeOctahedral(Value, Encoded);
+                    std::memcpy(Data, Encoded, sizeof(Encoded));
+                    break;
+                }
+                case EMeshVertexFormat::Snorm8x4:
+                {
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        Data[c] = (uint8_t)(int8_t)meshopt_quantizeSnorm(Value[c], 8);
+                    }
+                    break;
+                }
+                default:
+                {
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        Data[c] = (uint8_t)meshopt_quantizeUnorm(std::clamp(Value[c], 0.0f, 1.0f), 8);
+                    }
+                    break;
+                }
+                }
+            }
+        }
+
+        Mesh.Attributes = std::move(Quantized.Attributes);
+        Mesh.VertexStride = Quantized.VertexStride;
+        Mesh.Vertices = std::move(Vertices);
+    }
+
+    bool WriteMeshPackage(const std::string& Path, const std::vector<FCookedMesh>& Meshes, bool bCompress)
+    {
+        std::vector<FMeshEntry> Entries(Meshes.size());
+        uint64_t MeshTableOffset = AlignUp(sizeof(FMeshPackageHeader), MESH_SECTION_ALIGNMENT);
+        std::vector<uint8_t> Data(AlignUp(MeshTableOffset + Entries.size() * sizeof(FMeshEntry), MESH_SECTION_ALIGNMENT));
+        auto Append = [&Data](const void* Bytes, uint64_t Size)
+        {
+            FMeshSection Section = { Data.size(), Size };
+            auto Begin = static_cast<const uint8_t*>(Bytes);
+            Data.insert(Data.end(), Begin, Begin + Size);
+            Data.resize(AlignUp(Data.size(), MESH_SECTION_ALIGNMENT));
+            return Section;
+        };
+
+        for (size_t i = 0; i < Meshes.size(); ++i)
+        {
+            auto& Mesh = Meshes[i];
+            auto& Entry = Entries[i];
+            if (Mesh.Attributes.size() > MAX_MESH_ATTRIBUTE_COUNT)
+            {
+                return false;
+            }
+
+            Entry.NameHash = HashString(Mesh.Name);
+            Entry.Name = Append(Mesh.Name.data(), Mesh.Name.size());
+            Entry.Bounds = Mesh.Bounds;
+            std::copy(Mesh.PositionOffset, Mesh.PositionOffset + 3, Entry.PositionOffset);
+            std::copy(Mesh.PositionScale, Mesh.PositionScale + 3, Entry.PositionScale);
+            Entry.VertexNum = Mesh.VertexNum;
+            Entry.VertexStride = Mesh.VertexStride;
+            Entry.IndexNum = (uint32_t)Mesh.Indices.size();
+            Entry.AttributeNum = (uint32_t)Mesh.Attributes.size();
+            std::copy(Mesh.Attributes.begin(), Mesh.Attributes.end(), Entry.Attributes);
+            // 16-bit indices whenever they fit, halves index fetch for most meshes
+            Entry.IndexSize = Mesh.VertexNum <= UINT16_MAX ? sizeof(uint16_t) : sizeof(uint32_t);
+
+            // the vertex codec wants strides that are a multiple of 4, which every mesh attribute format keeps
+            if (bCompress && Mesh.VertexStride % 4 == 0 && Mesh.VertexStride <= 256 && Mesh.Indices.size() % 3 == 0)
+            {
+                Entry.Flags |= MESH_ENTRY_ENCODED;
+
+                std::vector<uint8_t> EncodedVertices(meshopt_encodeVertexBufferBound(Mesh.VertexNum, Mesh.VertexStride));
+                EncodedVertices.resize(meshopt_encodeVertexBuffer(EncodedVertices.data(), EncodedVertices.size(), Mesh.Vertices.data(), Mesh.VertexNum, Mesh.VertexStride));
+                Entry.Vertices = Append(EncodedVertices.data(), EncodedVertices.size());
+
+                // the levels are triangle lists back to back, so they encode as one list
+                std::vector<uint8_t> EncodedIndices(meshopt_encodeIndexBufferBound(Mesh.Indices.size(), Mesh.VertexNum));
+                EncodedIndices.resize(meshopt_encodeIndexBuffer(EncodedIndices.data(), EncodedIndices.size(), Mesh.Indices.data(), Mesh.Indices.size()));
+                Entry.Indices = Append(EncodedIndices.data(), EncodedIndices.size());
+            }
+            else
+            {
+                Entry.Vertices = Append(Mesh.Vertices.data(), Mesh.Vertices.size());
+                if (Entry.IndexSize == sizeof(uint16_t))
+                {
+                    std::vector<uint16_t> ShortIndices(Mesh.Indices.begin(), Mesh.Indices.end());
+                    Entry.Indices = Append(ShortIndices.data(), ShortIndices.size() * sizeof(uint16_t));
+                }
+                else
+                {
+                    Entry.Indices = Append(Mesh.Indices.data(), Mesh.Indices.size() * sizeof(uint32_t));
+                }
+            }
+            Entry.MeshletNum = (uint32_t)Mesh.Meshlets.size();
+            Entry.LodNum = (uint32_t)Mesh.Lods.size();
+            std::copy(Mesh.Lods.begin(), Mesh.Lods.end(), Entry.Lods);
+            Entry.Meshlets = Append(Mesh.Meshlets.data(), Mesh.Meshlets.size() * sizeof(FMeshlet));
+        }
+
+        FMeshPackageHeader Header = {};
+        Header.Magic = MESH_PACKAGE_MAGIC;
+        Header.Version = MESH_PACKAGE_VERSION;
+        Header.MeshNum = (uint32_t)Meshes.size();
+        Header.FileSize = Data.size();
+        Header.MeshTableOffset = MeshTableOffset;
+        std::memcpy(Data.data(), &Header, sizeof(Header));
+        std::memcpy(Data.data() + MeshTableOffset, Entries.data(), Entries.size() * sizeof(FMeshEntry));
+
+        std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+        File.write((const char*)Data.data(), Data.size());
+        return (bool)File;
+    }
+}
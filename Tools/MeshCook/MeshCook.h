@@ -0,0 +1,60 @@
+#pragma once
+#include "Mesh/MeshFormat.h"
+#include <string>
+#include <vector>
+namespace Neko::MeshCook
+{
+    struct FMeshCookOptions
+    {
+        bool bNormals = true;
+        bool bTangents = false;
+        bool bTexCoords = true;
+        bool bColors = false;
+        // how much vertex cache efficiency the overdraw pass may give up, 1.05 allows 5%
+        float OverdrawThreshold = 1.05f;
+        // levels of detail including the full mesh, every level targets LodReduction of the triangles of the previous one
+        uint32_t MaxLodNum = 4;
+        float LodReduction = 0.5f;
+        // relative to the mesh extent, the chain stops once a level can't get under it
+        float LodMaxError = 0.05f;
+        bool bMeshlets = true;
+        // 0 builds the tightest clusters, higher values trade cluster size for cone culling efficiency
+        float MeshletConeWeight = 0.25f;
+        // positions as 16-bit fractions of the bounds, half texcoords, octahedral normals, 8-bit tangents and colors
+        bool bQuantize = true;
+        // meshopt vertex and index codecs on disk, decoded when the mesh is loaded
+        bool bCompress = true;
+    };
+
+    // one mesh in its cooked form, vertices are interleaved and start with the position,
+    // a float3 until QuantizeMesh turns it into a unorm16x4
+    struct FCookedMesh
+    {
+        std::string Name;
+        Mesh::FMeshBounds Bounds = {};
+        // see FMeshEntry::PositionOffset
+        float PositionOffset[3] = { 0.0f, 0.0f, 0.0f };
+        float PositionScale[3] = { 1.0f, 1.0f, 1.0f };
+        std::vector<Mesh::FMeshAttributeDesc> Attributes;
+        uint32_t VertexStride = 0;
+        uint32_t VertexNum = 0;
+        std::vector<uint8_t> Vertices;
+        std::vector<uint32_t> Indices;
+        std::vector<Mesh::FMeshlet> Meshlets;
+        std::vector<Mesh::FMeshLod> Lods;
+    };
+
+    // imports every triangle mesh of a model with node transforms applied, vertices are deduplicated
+    bool ImportMeshes(const std::string& Path, const FMeshCookOptions& Options, std::vector<FCookedMesh>& Meshes, std::string& Error);
+
+    // reorders triangles for the vertex cache and overdraw, then vertices for fetch locality, and computes the bounds,
+    // then builds the lod chain, with meshlets enabled the triangles of every level are grouped into clusters and
+    // the indices rewritten in cluster order
+    void OptimizeMesh(FCookedMesh& Mesh, const FMeshCookOptions& Options);
+
+    // converts every attribute to its compact format, runs after OptimizeMesh which needs float positions
+    void QuantizeMesh(FCookedMesh& Mesh);
+
+    // with bCompress the vertex and index sections are meshopt encoded, see MESH_ENTRY_ENCODED
+    bool WriteMeshPackage(const std::string& Path, const std::vector<FCookedMesh>& Meshes, bool bCompress = true);
+}
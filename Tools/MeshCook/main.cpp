@@ -0,0 +1,64 @@
+#include "MeshCook.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+using namespace Neko;
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("usage : NekoMeshCook <model> <output> [--tangents] [--colors] [--no-normals] [--no-texcoords] [--no-meshlets] [--lods <num>] [--no-quantize] [--no-compress]\n");
+        return 1;
+    }
+
+    MeshCook::FMeshCookOptions Options;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string Option = argv[i];
+        if (Option == "--tangents") Options.bTangents = true;
+        else if (Option == "--colors") Options.bColors = true;
+        else if (Option == "--no-normals") Options.bNormals = false;
+        else if (Option == "--no-texcoords") Options.bTexCoords = false;
+        else if (Option == "--no-meshlets") Options.bMeshlets = false;
+        else if (Option == "--no-quantize") Options.bQuantize = false;
+        else if (Option == "--no-compress") Options.bCompress = false;
+        else if (Option == "--lods" && i + 1 < argc) Options.MaxLodNum = (uint32_t)std::max(1, atoi(argv[++i]));
+        else
+        {
+            printf("unknown option %s\n", Option.c_str());
+            return 1;
+        }
+    }
+
+    std::vector<MeshCook::FCookedMesh> Meshes;
+    std::string Error;
+    if (!MeshCook::ImportMeshes(argv[1], Options, Meshes, Error))
+    {
+        printf("failed to import %s : %s\n", argv[1], Error.c_str());
+        return 1;
+    }
+
+    for (auto& Mesh : Meshes)
+    {
+        MeshCook::OptimizeMesh(Mesh, Options);
+        if (Options.bQuantize)
+        {
+            MeshCook::QuantizeMesh(Mesh);
+        }
+        printf("%s : %u vertices of %u bytes, %u meshlets\n", Mesh.Name.c_str(), Mesh.VertexNum, Mesh.VertexStride, (uint32_t)Mesh.Meshlets.size());
+        for (size_t i = 0; i < Mesh.Lods.size(); ++i)
+        {
+            printf("    lod %zu : %u triangles, error %g\n", i, Mesh.Lods[i].IndexNum / 3, Mesh.Lods[i].Error);
+        }
+    }
+
+    if (!MeshCook::WriteMeshPackage(argv[2], Meshes, Options.bCompress))
+    {
+        printf("failed to write %s\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}
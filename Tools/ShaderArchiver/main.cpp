@@ -0,0 +1,120 @@
+#include "ShaderCompiler/ShaderArchive.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+using namespace Neko;
+
+// builds a shader archive from a manifest, one shader per line:
+//   <path relative to the manifest> <entry point> <vertex|pixel|compute|mesh|amplification|library>
+// permutations declared in the source with "//! permutation" are all compiled and archived,
+// a shader is found at runtime by GetShaderKey(path as written in the manifest, entry point, keywords)
+
+static bool ParseShaderType(const std::string& Name, EShaderType& Type)
+{
+    if (Name == "vertex") { Type = EShaderType::kVertex; return true; }
+    if (Name == "pixel") { Type = EShaderType::kPixel; return true; }
+    if (Name == "compute") { Type = EShaderType::kCompute; return true; }
+    if (Name == "mesh") { Type = EShaderType::kMesh; return true; }
+    if (Name == "amplification") { Type = EShaderType::kAmplification; return true; }
+    if (Name == "library") { Type = EShaderType::kLibrary; return true; }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printf("usage : NekoShaderArchiver <manifest> <output> [cache dir]\n");
+        return 1;
+    }
+
+    std::filesystem::path ManifestPath = argv[1];
+    std::string OutputPath = argv[2];
+    std::string CacheDir = argc > 3 ? argv[3] : (std::filesystem::path(OutputPath).parent_path() / "ShaderCache").string();
+
+    std::ifstream Manifest(ManifestPath);
+    if (!Manifest)
+    {
+        printf("failed to open manifest %s\n", ManifestPath.string().c_str());
+        return 1;
+    }
+
+    std::vector<std::string> Names;
+    std::vector<ShaderCompiler::FShaderPermutationDesc> Descs;
+    std::string Line;
+    for (uint32_t LineNumber = 1; std::getline(Manifest, Line); ++LineNumber)
+    {
+        std::istringstream Tokens(Line);
+        std::string Name, EntryPoint, TypeName;
+        if (!(Tokens >> Name) || Name[0] == '#')
+        {
+            continue;
+        }
+
+        EShaderType Type;
+        if (!(Tokens >> EntryPoint >> TypeName) || !ParseShaderType(TypeName, Type))
+        {
+            printf("%s(%u) : expected <path> <entry point> <stage>\n", ManifestPath.string().c_str(), LineNumber);
+            return 1;
+        }
+
+        ShaderCompiler::FShaderPermutationDesc Desc;
+        Desc.Base.Path = (ManifestPath.parent_path() / Name).string();
+        Desc.Base.EntryPoint = EntryPoint;
+        Desc.Base.Type = Type;
+        if (!Desc.LoadDeclarations())
+        {
+            printf("failed to open shader %s\n", Desc.Base.Path.c_str());
+            return 1;
+        }
+        if (Desc.GetPermutationCount() == 0)
+        {
+            printf("%s(%u) : %s has no permutations or too many\n", ManifestPath.string().c_str(), LineNumber, Name.c_str());
+            return 1;
+        }
+        Names.push_back(Name);
+        Descs.push_back(Desc);
+    }
+
+    ShaderCompiler::FShaderCompiler Compiler(CacheDir);
+    auto Permutations = ShaderCompiler::CompilePermutations(Compiler, Descs);
+
+    ShaderCompiler::FShaderArchiveWriter Writer;
+    uint32_t ShaderNum = 0;
+    for (size_t i = 0; i < Descs.size(); ++i)
+    {
+        auto& Desc = Descs[i];
+        for (uint32_t Permutation = 0; Permutation < Desc.GetPermutationCount(); ++Permutation)
+        {
+            if (!Desc.IsValid(Permutation))
+            {
+                continue;
+            }
+            auto Shader = Permutations[i].Find(Permutation);
+            if (!Shader)
+            {
+                printf("failed to compile %s %s\n", Names[i].c_str(), Desc.Base.EntryPoint.c_str());
+                return 1;
+            }
+            auto Key = ShaderCompiler::GetShaderKey(Names[i], Desc.Base.EntryPoint, Desc.GetKeywords(Permutation));
+            if (!Writer.Add(Key, *Shader))
+            {
+                printf("key collision on %s %s\n", Names[i].c_str(), Desc.Base.EntryPoint.c_str());
+                return 1;
+            }
+            ShaderNum++;
+        }
+    }
+
+    if (!Writer.Write(OutputPath))
+    {
+        printf("failed to write %s\n", OutputPath.c_str());
+        return 1;
+    }
+
+    auto Stats = Compiler.GetStats();
+    printf("%u shaders archived to %s (%u compiled, %u cached)\n", ShaderNum, OutputPath.c_str(), Stats.Misses, Stats.Hits);
+    return 0;
+}